@@ -0,0 +1,194 @@
+/**
+ * @file    cdcBenchmark.cpp
+ * @brief   Measures USB CDC throughput of bulk downloads from the oven
+ *
+ *  Usage: cdcBenchmark [-d device] [-n iterations] [-s size] [-p]
+ *    -d device      Serial device (default /dev/ttyACM0)
+ *    -n iterations  Number of transfers (default 10)
+ *    -s size        Size of synthetic transfer requested with "BENCH? size" (default 100000)
+ *    -p             Download the plot log ("PLOT?") instead of synthetic data
+ *
+ *  Each synthetic record starts with its byte offset so lost or repeated data is detected.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <termios.h>
+#include <poll.h>
+#include <time.h>
+#include <string>
+
+/** Size of records in BENCH? response */
+static constexpr unsigned long RECORD_SIZE = 64;
+
+/** Time to wait for data before failing (ms) */
+static constexpr int TIMEOUT_MS = 5000;
+
+/**
+ * Get time in seconds from arbitrary base
+ *
+ * @return Time in seconds
+ */
+static double now() {
+   timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec/1e9;
+}
+
+/**
+ * Open serial device in raw mode
+ *
+ * @param[in] device Device path
+ *
+ * @return File descriptor or -1 on error
+ */
+static int openDevice(const char *device) {
+   int fd = open(device, O_RDWR|O_NOCTTY);
+   if (fd < 0) {
+      perror(device);
+      return -1;
+   }
+   termios tio;
+   if (tcgetattr(fd, &tio) == 0) {
+      cfmakeraw(&tio);
+      tio.c_cc[VMIN]  = 0;
+      tio.c_cc[VTIME] = 0;
+      tcsetattr(fd, TCSANOW, &tio);
+   }
+   tcflush(fd, TCIOFLUSH);
+   return fd;
+}
+
+/**
+ * Send command and collect response up to the "\n\r" terminator
+ *
+ * @param[in]  fd       Device
+ * @param[in]  command  Command to send (without line terminator)
+ * @param[out] response Response received (including terminator)
+ *
+ * @return true on success, false on error or timeout
+ */
+static bool transact(int fd, const std::string &command, std::string &response) {
+   std::string line = command + "\n";
+   if (write(fd, line.data(), line.size()) != (ssize_t)line.size()) {
+      perror("write");
+      return false;
+   }
+   response.clear();
+   char buff[4096];
+   for(;;) {
+      pollfd pfd = {fd, POLLIN, 0};
+      int rc = poll(&pfd, 1, TIMEOUT_MS);
+      if (rc == 0) {
+         fprintf(stderr, "Timeout after %lu bytes\n", (unsigned long)response.size());
+         return false;
+      }
+      if (rc < 0) {
+         perror("poll");
+         return false;
+      }
+      ssize_t size = read(fd, buff, sizeof(buff));
+      if (size < 0) {
+         if (errno == EINTR) {
+            continue;
+         }
+         perror("read");
+         return false;
+      }
+      response.append(buff, size);
+      if ((response.size() >= 2) && (response.compare(response.size()-2, 2, "\n\r") == 0)) {
+         return true;
+      }
+   }
+}
+
+/**
+ * Check synthetic data for lost or repeated records
+ *
+ * @param[in] response  Response to BENCH?
+ * @param[in] size      Size requested
+ *
+ * @return Number of bad records
+ */
+static unsigned long checkBenchData(const std::string &response, unsigned long size) {
+   unsigned long errors   = 0;
+   unsigned long expected = ((size+RECORD_SIZE-1)/RECORD_SIZE)*RECORD_SIZE;
+   if (response.size() != expected+2) {
+      errors++;
+   }
+   for (unsigned long offset=0; offset+RECORD_SIZE<=response.size(); offset+=RECORD_SIZE) {
+      if (strtoul(response.substr(offset, 7).c_str(), nullptr, 10) != offset) {
+         errors++;
+      }
+   }
+   return errors;
+}
+
+int main(int argc, char *argv[]) {
+   const char    *device     = "/dev/ttyACM0";
+   unsigned long  iterations = 10;
+   unsigned long  size       = 100000;
+   bool           usePlot    = false;
+
+   int opt;
+   while ((opt = getopt(argc, argv, "d:n:s:p")) != -1) {
+      switch(opt) {
+         case 'd': device     = optarg;                       break;
+         case 'n': iterations = strtoul(optarg, nullptr, 10); break;
+         case 's': size       = strtoul(optarg, nullptr, 10); break;
+         case 'p': usePlot    = true;                         break;
+         default:
+            fprintf(stderr, "Usage: %s [-d device] [-n iterations] [-s size] [-p]\n", argv[0]);
+            return EXIT_FAILURE;
+      }
+   }
+   int fd = openDevice(device);
+   if (fd < 0) {
+      return EXIT_FAILURE;
+   }
+   const std::string command = usePlot?std::string("PLOT?"):"BENCH? "+std::to_string(size);
+
+   double        minRate    = 0;
+   double        maxRate    = 0;
+   double        totalTime  = 0;
+   unsigned long totalBytes = 0;
+   unsigned long badRecords = 0;
+   std::string   response;
+
+   for (unsigned long iteration=0; iteration<iterations; iteration++) {
+      double start = now();
+      if (!transact(fd, command, response)) {
+         close(fd);
+         return EXIT_FAILURE;
+      }
+      double elapsed = now()-start;
+      double rate    = response.size()/elapsed;
+      if ((iteration == 0) || (rate < minRate)) {
+         minRate = rate;
+      }
+      if (rate > maxRate) {
+         maxRate = rate;
+      }
+      if (!usePlot) {
+         badRecords += checkBenchData(response, size);
+      }
+      totalTime  += elapsed;
+      totalBytes += response.size();
+      printf("%3lu: %8lu bytes in %7.3f s = %8.1f kB/s\n", iteration, (unsigned long)response.size(), elapsed, rate/1000);
+   }
+   close(fd);
+
+   printf("'%s' x %lu: %lu bytes, average %.1f kB/s (min %.1f, max %.1f)",
+         command.c_str(), iterations, totalBytes, (totalBytes/totalTime)/1000, minRate/1000, maxRate/1000);
+   if (!usePlot) {
+      printf(", %lu bad records", badRecords);
+   }
+   printf("\n");
+   return (badRecords == 0)?EXIT_SUCCESS:EXIT_FAILURE;
+}
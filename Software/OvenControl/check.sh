@@ -0,0 +1,113 @@
+#!/bin/sh
+#
+# Runs the host tools against simulated ovens (OvenFuzz ptyOven)
+#
+#  Usage: check.sh path/to/ptyOven
+#
+#  Used by 'make check'. Exits non-zero on the first failure.
+#
+PTYOVEN=${1:?Usage: check.sh path/to/ptyOven}
+TIMEOUT="timeout 30"
+
+DIR=$(mktemp -d)
+PIDS=""
+
+cleanup() {
+   [ -n "$PIDS" ] && kill $PIDS 2>/dev/null
+   wait
+   rm -rf "$DIR"
+}
+trap cleanup EXIT
+trap 'exit 1' INT TERM
+
+fail() {
+   echo "FAIL: $*" >&2
+   exit 1
+}
+
+# Start a simulated oven and wait until its pty link exists
+startOven() {
+   "$PTYOVEN" -l "$DIR/$1" >/dev/null &
+   PIDS="$PIDS $!"
+   for i in 1 2 3 4 5 6 7 8 9 10; do
+      [ -e "$DIR/$1" ] && return
+      sleep 0.2
+   done
+   fail "$1 did not start"
+}
+
+# Send a command to ovenFleetd and show the reply
+fleet() {
+   $TIMEOUT python3 - "$DIR/fleet.sock" "$1" <<'PY'
+import socket, sys
+s = socket.socket(socket.AF_UNIX)
+s.connect(sys.argv[1])
+s.sendall((sys.argv[2]+"\n").encode())
+reply = b""
+while not reply.endswith(b"\n\n"):
+   data = s.recv(4096)
+   if not data:
+      break
+   reply += data
+sys.stdout.write(reply.decode())
+PY
+}
+
+# ovenctl against oven0
+ovenctl() {
+   $TIMEOUT ./ovenctl -d "$DIR/oven0" "$@"
+}
+
+# Check output of ovenctl matches pattern
+expect() {
+   pattern=$1
+   shift
+   out=$(ovenctl "$@") || fail "ovenctl $*"
+   echo "$out" | grep -q -- "$pattern" || fail "ovenctl $*: expected '$pattern', got '$out'"
+}
+
+startOven oven0
+
+echo "ovenctl"
+expect '^SMT-Oven'                              idn
+[ "$(ovenctl profs | wc -l)" -eq 10 ]           || fail "ovenctl profs: expected 10 profiles"
+ovenctl profs "7,Check 7,3,183,90,140,183,90,1.4,210,15,-3.0" \
+              "8,Check 8,3,183,90,140,183,90,1.4,210,15,-3.0" || fail "ovenctl profs records"
+expect '^ 7 Check 7 '                           profs
+expect '^ 8 Check 8 '                           profs
+ovenctl profs "0,Locked,3,183,90,140,183,90,1.4,210,15,-3.0" 2>/dev/null \
+                                                && fail "ovenctl profs changed a locked profile"
+expect '^ 0 4300 63SN/37PB-a '                  profs
+ovenctl prof 7                                  || fail "ovenctl prof 7"
+expect '^ 7 Check 7 '                           prof
+ovenctl therm 1,0,1,1,0,0,1,-2                  || fail "ovenctl therm"
+expect '^T3 disabled offset=0'                  therm
+expect '^T4 enabled  offset=-2'                 therm
+ovenctl pid 1 0.5 2                             || fail "ovenctl pid"
+expect '^kp=1 ki=0.5 kd=2$'                     pid
+ovenctl run                                     || fail "ovenctl run"
+expect '^complete$'                             status
+ovenctl abort                                   || fail "ovenctl abort"
+expect '^state,time,target,average,heater,fan,T1,T2,T3,T4$' plot
+[ "$(ovenctl plot | wc -l)" -eq 6 ]             || fail "ovenctl plot: expected 5 points"
+expect '^THERM? -> 1,0,1,1,0,0,1,-2;$'          raw IDN? THERM?
+
+echo "ovenLoad"
+# Fails if any reply is dropped or unmatched
+out=$($TIMEOUT ./ovenLoad -d "$DIR/oven0" -n 300 -r 2000 -w 3) || fail "ovenLoad: $out"
+echo "$out" | grep -q '^total  *300  *300 '      || fail "ovenLoad: expected 300 replies, got '$out'"
+
+echo "ovenFleetd"
+startOven oven1
+./ovenFleetd -s "$DIR/fleet.sock" -i 100 "$DIR/oven0" "$DIR/oven1" 2>/dev/null &
+PIDS="$PIDS $!"
+for i in 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15; do
+   [ "$(fleet STATUS 2>/dev/null | grep -c ',online,SMT-Oven[^,]*,[0-9]*,5,')" -eq 2 ] && break
+   sleep 0.2
+done
+[ "$(fleet STATUS | grep -c ',online,SMT-Oven[^,]*,[0-9]*,5,')" -eq 2 ] \
+                                                || fail "ovenFleetd STATUS: $(fleet STATUS)"
+[ "$(fleet "PLOT $DIR/oven1" | grep -c '^preheat,')" -eq 5 ] \
+                                                || fail "ovenFleetd PLOT: $(fleet "PLOT $DIR/oven1")"
+
+echo "PASS"
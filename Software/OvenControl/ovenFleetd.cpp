@@ -0,0 +1,642 @@
+/**
+ * @file    ovenFleetd.cpp
+ * @brief   Daemon monitoring several ovens and serving their status over a Unix socket
+ *
+ *  Usage: ovenFleetd [-s socket] [-i interval_ms] [-t timeout_ms] device...
+ *    -s socket       Unix socket path (default /tmp/ovenFleet.sock)
+ *    -i interval_ms  Interval between PLOT? polls of each oven (default 2000)
+ *    -t timeout_ms   Time without data before an oven is considered off-line (default 2000)
+ *
+ *  A single thread multiplexes all oven ports and clients using epoll and non-blocking I/O
+ *  so a slow oven or client does not delay the others.\n
+ *  Each oven is identified with IDN? when connected and then polled with PLOT?.
+ *  The plot is parsed incrementally as it arrives and replaces the stored plot when complete.
+ *  Off-line ovens are re-opened every RECONNECT_INTERVAL_MS.
+ *
+ *  Client commands (one per line, each reply is terminated by an empty line):
+ *    STATUS       One line per oven:
+ *                 device,online|offline,idn,age_ms,points,state,time,target,average,heater,fan
+ *                 (age_ms is the time since the plot was last updated, -1 if never)
+ *    PLOT device  Stored plot of oven as CSV: state,time,target,average,heater,fan,T1,T2,T3,T4
+ *
+ *  e.g. socat - UNIX-CONNECT:/tmp/ovenFleet.sock
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <termios.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include "ovenctl.h"
+
+using namespace OvenCtl;
+
+/** Time between attempts to re-open an off-line oven (ms) */
+static constexpr uint64_t RECONNECT_INTERVAL_MS = 5000;
+
+/** Clients with more than this amount of unsent output are disconnected */
+static constexpr size_t MAX_CLIENT_OUTPUT = 4*1024*1024;
+
+/** Longest client command */
+static constexpr size_t MAX_CLIENT_COMMAND = 200;
+
+/** Maximum events handled per epoll_wait() */
+static constexpr int MAX_EVENTS = 64;
+
+/** Set by signal handler to stop daemon */
+static volatile sig_atomic_t stopRequested = 0;
+
+/**
+ * Get time in milliseconds from arbitrary base
+ *
+ * @return Time in ms
+ */
+static uint64_t now() {
+   timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec*1000ULL + ts.tv_nsec/1000000;
+}
+
+/**
+ * Source of epoll events
+ */
+class Handler {
+public:
+   virtual ~Handler() {}
+
+   /**
+    * Handle epoll event
+    *
+    * @param[in] events Events from epoll
+    */
+   virtual void handleEvent(uint32_t events) = 0;
+};
+
+/**
+ * Connection to one oven
+ */
+class OvenLink : public Handler {
+
+private:
+   /** Phase of communication */
+   enum Phase {
+      Offline,   // Device not open
+      Idle,      // Waiting for next poll
+      WaitIdn,   // Waiting for IDN? reply
+      WaitPlot,  // Receiving PLOT? reply
+   };
+
+   const int         epollFd;
+   const std::string device;
+   const uint64_t    pollInterval;
+   const uint64_t    timeout;
+
+   int         fd           = -1;
+   Phase       phase        = Offline;
+   uint64_t    nextAction   = 0;
+   uint64_t    lastUpdate   = 0;
+   bool        haveUpdate   = false;
+   std::string received;
+   std::string idn;
+
+   /** Last complete plot */
+   std::vector<DataPoint> points;
+
+   /** Plot being received */
+   std::vector<DataPoint> newPoints;
+   bool                   haveHeader = false;
+   unsigned long          expected   = 0;
+
+   /**
+    * Close device
+    *
+    * @param[in] reason Reason to report
+    */
+   void disconnect(const char *reason) {
+      if (fd >= 0) {
+         fprintf(stderr, "%s: off-line - %s\n", device.c_str(), reason);
+         epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+         close(fd);
+         fd = -1;
+      }
+      phase      = Offline;
+      nextAction = now()+RECONNECT_INTERVAL_MS;
+      received.clear();
+   }
+
+   /**
+    * Send command to oven
+    *
+    * @param[in] command  Command including line terminator
+    * @param[in] newPhase Phase while waiting for reply
+    */
+   void send(const char *command, Phase newPhase) {
+      size_t size = strlen(command);
+      if (write(fd, command, size) != (ssize_t)size) {
+         // Commands are short so this only fails if the device is broken
+         disconnect("write failed");
+         return;
+      }
+      phase      = newPhase;
+      nextAction = now()+timeout;
+   }
+
+   /**
+    * Open device and start identification
+    */
+   void connect() {
+      fd = open(device.c_str(), O_RDWR|O_NOCTTY|O_NONBLOCK);
+      if (fd < 0) {
+         nextAction = now()+RECONNECT_INTERVAL_MS;
+         return;
+      }
+      termios tio;
+      if (tcgetattr(fd, &tio) == 0) {
+         cfmakeraw(&tio);
+         tcsetattr(fd, TCSANOW, &tio);
+      }
+      tcflush(fd, TCIOFLUSH);
+      epoll_event event = {};
+      event.events   = EPOLLIN;
+      event.data.ptr = static_cast<Handler*>(this);
+      epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+      send("IDN?\n", WaitIdn);
+   }
+
+   /**
+    * Process received data
+    */
+   void process() {
+      if (phase == WaitIdn) {
+         std::string::size_type end = received.find("\n\r");
+         if (end != std::string::npos) {
+            idn = received.substr(0, end);
+            received.erase(0, end+2);
+            fprintf(stderr, "%s: on-line - %s\n", device.c_str(), idn.c_str());
+            phase      = Idle;
+            nextAction = now();
+         }
+      }
+      else if (phase == WaitPlot) {
+         try {
+            for(;;) {
+               std::string::size_type recordEnd = received.find(';');
+               std::string::size_type replyEnd  = received.find("\n\r");
+               if ((replyEnd != std::string::npos) && ((recordEnd == std::string::npos) || (replyEnd < recordEnd))) {
+                  // End of reply
+                  bool valid = (replyEnd == 0) && haveHeader && (newPoints.size() == expected);
+                  received.erase(0, replyEnd+2);
+                  if (valid) {
+                     points.swap(newPoints);
+                     lastUpdate = now();
+                     haveUpdate = true;
+                  }
+                  else {
+                     fprintf(stderr, "%s: invalid PLOT? reply\n", device.c_str());
+                  }
+                  phase      = Idle;
+                  nextAction = now()+pollInterval;
+                  break;
+               }
+               if (recordEnd == std::string::npos) {
+                  break;
+               }
+               std::string record = received.substr(0, recordEnd);
+               received.erase(0, recordEnd+1);
+               if (!haveHeader) {
+                  expected   = strtoul(record.c_str(), nullptr, 10);
+                  haveHeader = true;
+                  newPoints.reserve(expected);
+               }
+               else {
+                  newPoints.push_back(DataPoint::parse(record));
+               }
+            }
+         }
+         catch (Error &e) {
+            // Discard rest of reply
+            fprintf(stderr, "%s: %s\n", device.c_str(), e.what());
+            disconnect("protocol error");
+         }
+      }
+      else {
+         // Unexpected data
+         received.clear();
+      }
+   }
+
+public:
+   /**
+    * Create oven link
+    *
+    * @param[in] epollFd      epoll instance to register with
+    * @param[in] device       Serial device or pty
+    * @param[in] pollInterval Interval between PLOT? polls (ms)
+    * @param[in] timeout      Time without data before oven is considered off-line (ms)
+    */
+   OvenLink(int epollFd, const std::string &device, uint64_t pollInterval, uint64_t timeout) :
+      epollFd(epollFd), device(device), pollInterval(pollInterval), timeout(timeout) {
+   }
+
+   virtual ~OvenLink() {
+      if (fd >= 0) {
+         close(fd);
+      }
+   }
+
+   virtual void handleEvent(uint32_t events) override {
+      if (fd < 0) {
+         return;
+      }
+      char buff[4096];
+      for(;;) {
+         ssize_t size = read(fd, buff, sizeof(buff));
+         if (size > 0) {
+            received.append(buff, size);
+            continue;
+         }
+         if ((size < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+            break;
+         }
+         if ((size < 0) && (errno == EINTR)) {
+            continue;
+         }
+         disconnect((size == 0)?"closed":strerror(errno));
+         return;
+      }
+      if (phase != Idle) {
+         // Timeout is for inactivity so long transfers are not interrupted
+         nextAction = now()+timeout;
+      }
+      process();
+      if ((fd >= 0) && (events & (EPOLLERR|EPOLLHUP))) {
+         disconnect("hang-up");
+      }
+   }
+
+   /**
+    * Perform timed actions (poll, time-out, reconnect)
+    *
+    * @param[in] time Current time
+    */
+   void handleTimer(uint64_t time) {
+      if (time < nextAction) {
+         return;
+      }
+      switch(phase) {
+         case Offline:
+            connect();
+            break;
+         case Idle:
+            haveHeader = false;
+            newPoints.clear();
+            send("PLOT?\n", WaitPlot);
+            break;
+         case WaitIdn:
+         case WaitPlot:
+            disconnect("timeout");
+            break;
+      }
+   }
+
+   /**
+    * Get time of next timed action
+    */
+   uint64_t getNextAction() const {
+      return nextAction;
+   }
+
+   const std::string &getDevice() const {
+      return device;
+   }
+
+   /**
+    * Write status line e.g.\n
+    * /dev/ttyACM0,online,SMT-Oven 1.0.0.0,250,75,preheat,74,150.0,148.2,80,0
+    *
+    * @param[out] out Output to append to
+    */
+   void writeStatus(std::string &out) const {
+      char buff[200];
+      long age = haveUpdate?(long)(now()-lastUpdate):-1;
+      snprintf(buff, sizeof(buff), "%s,%s,%s,%ld,%lu,", device.c_str(),
+            (phase==Offline)?"offline":"online", idn.c_str(), age, (unsigned long)points.size());
+      out += buff;
+      if (points.empty()) {
+         out += ",,,,,\n";
+         return;
+      }
+      const DataPoint &point = points.back();
+      snprintf(buff, sizeof(buff), "%s,%d,%.1f,%.1f,%d,%d\n", point.state.c_str(), point.time,
+            point.targetTemperature, point.averageTemperature, point.heater, point.fan);
+      out += buff;
+   }
+
+   /**
+    * Write stored plot as CSV
+    *
+    * @param[out] out Output to append to
+    */
+   void writePlot(std::string &out) const {
+      char buff[200];
+      out += "state,time,target,average,heater,fan,T1,T2,T3,T4\n";
+      for (const DataPoint &point:points) {
+         snprintf(buff, sizeof(buff), "%s,%d,%.1f,%.1f,%d,%d,%.1f,%.1f,%.1f,%.1f\n",
+               point.state.c_str(), point.time, point.targetTemperature, point.averageTemperature,
+               point.heater, point.fan,
+               point.temperature[0], point.temperature[1], point.temperature[2], point.temperature[3]);
+         out += buff;
+      }
+   }
+};
+
+/** All ovens being monitored */
+static std::vector<std::unique_ptr<OvenLink>> ovens;
+
+/**
+ * Local client connected to Unix socket
+ */
+class Client : public Handler {
+
+private:
+   const int   epollFd;
+   const int   fd;
+   bool        closed        = false;
+   bool        waitingOutput = false;
+   std::string input;
+   std::string output;
+
+   /**
+    * Execute client command
+    *
+    * @param[in] line Command
+    */
+   void doCommand(const std::string &line) {
+      if (line == "STATUS") {
+         for (const std::unique_ptr<OvenLink> &oven:ovens) {
+            oven->writeStatus(output);
+         }
+      }
+      else if (line.compare(0, 5, "PLOT ") == 0) {
+         std::string device = line.substr(5);
+         for (const std::unique_ptr<OvenLink> &oven:ovens) {
+            if (oven->getDevice() == device) {
+               oven->writePlot(output);
+            }
+         }
+      }
+      else if (!line.empty()) {
+         output += "Failed - unrecognized command\n";
+      }
+      output += "\n";
+   }
+
+   /**
+    * Write as much output as possible and wait for space if needed
+    */
+   void flush() {
+      while (!output.empty()) {
+         ssize_t size = write(fd, output.data(), output.size());
+         if (size > 0) {
+            output.erase(0, size);
+            continue;
+         }
+         if ((size < 0) && (errno == EINTR)) {
+            continue;
+         }
+         if ((size < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+            break;
+         }
+         closed = true;
+         return;
+      }
+      if (output.size() > MAX_CLIENT_OUTPUT) {
+         // Client is not reading
+         closed = true;
+         return;
+      }
+      bool wantOutput = !output.empty();
+      if (wantOutput != waitingOutput) {
+         epoll_event event = {};
+         event.events   = wantOutput?(EPOLLIN|EPOLLOUT):EPOLLIN;
+         event.data.ptr = static_cast<Handler*>(this);
+         epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+         waitingOutput = wantOutput;
+      }
+   }
+
+public:
+   Client(int epollFd, int fd) : epollFd(epollFd), fd(fd) {
+      epoll_event event = {};
+      event.events   = EPOLLIN;
+      event.data.ptr = static_cast<Handler*>(this);
+      epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+   }
+
+   virtual ~Client() {
+      close(fd);
+   }
+
+   /**
+    * Indicates the client has disconnected and may be deleted
+    */
+   bool isClosed() const {
+      return closed;
+   }
+
+   virtual void handleEvent(uint32_t events) override {
+      if (closed) {
+         return;
+      }
+      if (events & EPOLLIN) {
+         char buff[1024];
+         for(;;) {
+            ssize_t size = read(fd, buff, sizeof(buff));
+            if (size > 0) {
+               input.append(buff, size);
+               continue;
+            }
+            if ((size < 0) && (errno == EINTR)) {
+               continue;
+            }
+            if ((size < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+               break;
+            }
+            closed = true;
+            return;
+         }
+         std::string::size_type end;
+         while ((end = input.find('\n')) != std::string::npos) {
+            std::string line = input.substr(0, end);
+            input.erase(0, end+1);
+            if (!line.empty() && (line.back() == '\r')) {
+               line.pop_back();
+            }
+            doCommand(line);
+         }
+         if (input.size() > MAX_CLIENT_COMMAND) {
+            closed = true;
+            return;
+         }
+      }
+      else if (events & (EPOLLERR|EPOLLHUP)) {
+         closed = true;
+         return;
+      }
+      flush();
+   }
+};
+
+/** Connected clients */
+static std::list<std::unique_ptr<Client>> clients;
+
+/**
+ * Unix socket accepting clients
+ */
+class Listener : public Handler {
+
+private:
+   const int   epollFd;
+   const std::string path;
+   int         fd;
+
+public:
+   /**
+    * Create listening socket
+    *
+    * @param[in] epollFd  epoll instance to register with
+    * @param[in] path     Socket path
+    *
+    * @throw Error on failure
+    */
+   Listener(int epollFd, const std::string &path) : epollFd(epollFd), path(path) {
+      sockaddr_un address = {};
+      address.sun_family = AF_UNIX;
+      if (path.size() >= sizeof(address.sun_path)) {
+         throw Error("Socket path too long");
+      }
+      strcpy(address.sun_path, path.c_str());
+      fd = socket(AF_UNIX, SOCK_STREAM|SOCK_NONBLOCK|SOCK_CLOEXEC, 0);
+      if (fd < 0) {
+         throw Error(std::string("socket: ") + strerror(errno));
+      }
+      unlink(path.c_str());
+      if ((bind(fd, (sockaddr *)&address, sizeof(address)) < 0) || (listen(fd, 16) < 0)) {
+         close(fd);
+         throw Error(path + ": " + strerror(errno));
+      }
+      epoll_event event = {};
+      event.events   = EPOLLIN;
+      event.data.ptr = static_cast<Handler*>(this);
+      epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+   }
+
+   virtual ~Listener() {
+      close(fd);
+      unlink(path.c_str());
+   }
+
+   virtual void handleEvent(uint32_t) override {
+      for(;;) {
+         int clientFd = accept4(fd, nullptr, nullptr, SOCK_NONBLOCK|SOCK_CLOEXEC);
+         if (clientFd < 0) {
+            return;
+         }
+         clients.emplace_back(new Client(epollFd, clientFd));
+      }
+   }
+};
+
+/**
+ * Signal handler requesting exit
+ */
+static void stopHandler(int) {
+   stopRequested = 1;
+}
+
+int main(int argc, char *argv[]) {
+   const char *socketPath   = "/tmp/ovenFleet.sock";
+   uint64_t    pollInterval = 2000;
+   uint64_t    timeout      = 2000;
+
+   int opt;
+   while ((opt = getopt(argc, argv, "s:i:t:")) != -1) {
+      switch(opt) {
+         case 's': socketPath   = optarg;                        break;
+         case 'i': pollInterval = strtoul(optarg, nullptr, 10);  break;
+         case 't': timeout      = strtoul(optarg, nullptr, 10);  break;
+         default:
+            optind = argc;
+            break;
+      }
+   }
+   if (optind >= argc) {
+      fprintf(stderr, "Usage: %s [-s socket] [-i interval_ms] [-t timeout_ms] device...\n", argv[0]);
+      return EXIT_FAILURE;
+   }
+   struct sigaction action = {};
+   action.sa_handler = stopHandler;
+   sigaction(SIGINT,  &action, nullptr);
+   sigaction(SIGTERM, &action, nullptr);
+   signal(SIGPIPE, SIG_IGN);
+
+   int epollFd = epoll_create1(EPOLL_CLOEXEC);
+   if (epollFd < 0) {
+      perror("epoll_create1");
+      return EXIT_FAILURE;
+   }
+   std::unique_ptr<Listener> listener;
+   try {
+      listener.reset(new Listener(epollFd, socketPath));
+   }
+   catch (Error &e) {
+      fprintf(stderr, "%s\n", e.what());
+      return EXIT_FAILURE;
+   }
+   for (int index=optind; index<argc; index++) {
+      ovens.emplace_back(new OvenLink(epollFd, argv[index], pollInterval, timeout));
+   }
+
+   while (!stopRequested) {
+      // Timed actions
+      uint64_t time = now();
+      uint64_t next = time+1000;
+      for (std::unique_ptr<OvenLink> &oven:ovens) {
+         oven->handleTimer(time);
+         if (oven->getNextAction() < next) {
+            next = oven->getNextAction();
+         }
+      }
+      int waitMs = (next > time)?(int)(next-time):0;
+
+      epoll_event events[MAX_EVENTS];
+      int count = epoll_wait(epollFd, events, MAX_EVENTS, waitMs);
+      if ((count < 0) && (errno != EINTR)) {
+         perror("epoll_wait");
+         break;
+      }
+      for (int index=0; index<count; index++) {
+         static_cast<Handler*>(events[index].data.ptr)->handleEvent(events[index].events);
+      }
+      // Clients are deleted after all events are handled as later events may refer to them
+      clients.remove_if([](const std::unique_ptr<Client> &client) { return client->isClosed(); });
+   }
+   clients.clear();
+   ovens.clear();
+   listener.reset();
+   close(epollFd);
+   return EXIT_SUCCESS;
+}
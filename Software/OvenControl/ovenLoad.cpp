@@ -0,0 +1,308 @@
+/**
+ * @file    ovenLoad.cpp
+ * @brief   Load generator and latency benchmark for the oven remote protocol
+ *
+ *  Usage: ovenLoad [-d device] [-r rate] [-w window] [-n count] [-t timeout_ms] [-s seed] [-m command:weight]...
+ *    -d device          Serial device or pty (default /dev/ttyACM0)
+ *    -r rate            Commands per second (default 0 = as fast as the window allows)
+ *    -w window          Maximum commands outstanding (default 1)
+ *    -n count           Number of commands to send (default 1000)
+ *    -t timeout_ms      Time after which a missing reply is counted as dropped (default 2000)
+ *    -s seed            Random seed for the command mix (default 1)
+ *    -m command:weight  Add command to mix with relative weight e.g. -m "PROF 3:1" (may be repeated)
+ *                       Default mix is IDN?:4 THERM?:2 PLOT?:1 PROF?:2 RUN?:1
+ *
+ *  Commands are sent open-loop at the given rate so queueing in the oven shows up as latency.
+ *  A window greater than 3 may overrun the oven's 4-entry command queue and cause dropped commands.
+ *
+ *  The oven does not tag replies so each reply is matched to the oldest outstanding command
+ *  it could belong to (by reply format). Older commands skipped this way are counted as dropped.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <time.h>
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+#include "ovenctl.h"
+
+using namespace OvenCtl;
+
+/**
+ * Get time in seconds from arbitrary base
+ *
+ * @return Time in seconds
+ */
+static double now() {
+   timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec/1e9;
+}
+
+/**
+ * Command in mix and its results
+ */
+struct MixEntry {
+   std::string         command;
+   unsigned            weight;
+   unsigned long       sent     = 0;
+   unsigned long       replies  = 0;
+   unsigned long       busy     = 0;
+   unsigned long       failed   = 0;
+   unsigned long       dropped  = 0;
+   std::vector<double> latencies;
+
+   MixEntry(const std::string &command, unsigned weight) : command(command), weight(weight) {}
+};
+
+/**
+ * Command waiting for reply
+ */
+struct Outstanding {
+   MixEntry *entry;
+   double    sendTime;
+};
+
+/**
+ * Count occurrences of character in string
+ *
+ * @param[in] text Text to search
+ * @param[in] ch   Character to count
+ *
+ * @return Count
+ */
+static unsigned countOf(const std::string &text, char ch) {
+   return (unsigned)std::count(text.begin(), text.end(), ch);
+}
+
+/**
+ * Check if a reply has a format that could be the reply to a command
+ *
+ * @param[in] command Command sent
+ * @param[in] reply   Reply received (without "\n\r")
+ *
+ * @return true if reply could belong to command
+ */
+static bool isPossibleReply(const std::string &command, const std::string &reply) {
+   if (reply.compare(0, 6, "Failed") == 0) {
+      return true;
+   }
+   std::string cmd = command;
+   for (char &ch:cmd) {
+      ch = toupper(ch);
+   }
+   if (cmd == "IDN?") {
+      return reply.compare(0, 3, "SMT") == 0;
+   }
+   if (cmd == "RUN?") {
+      return (reply == "OK") || (reply == "Running");
+   }
+   if ((cmd == "PLOT?") || (cmd == "PROFS?")) {
+      size_t digits = reply.find_first_not_of("0123456789");
+      return (digits != 0) && (digits != std::string::npos) && (reply[digits] == ';');
+   }
+   if (cmd == "THERM?") {
+      return countOf(reply, ',') == 7;
+   }
+   if (cmd == "PID?") {
+      return countOf(reply, ',') == 2;
+   }
+   if (cmd == "PROF?") {
+      return countOf(reply, ',') == 11;
+   }
+   if ((cmd.find(' ') != std::string::npos) || (cmd == "RUN") || (cmd == "ABORT")) {
+      return reply == "OK";
+   }
+   // Unknown command - accept anything
+   return true;
+}
+
+/**
+ * Get percentile of sorted values
+ *
+ * @param[in] values     Sorted values
+ * @param[in] percentile Percentile required (0-100)
+ *
+ * @return Value
+ */
+static double percentile(const std::vector<double> &values, double percentile) {
+   if (values.empty()) {
+      return 0;
+   }
+   size_t index = (size_t)((percentile/100)*(values.size()-1)+0.5);
+   return values[index];
+}
+
+/**
+ * Print results line
+ *
+ * @param[in] name      Name for line
+ * @param[in] entry     Results
+ */
+static void report(const char *name, MixEntry &entry) {
+   std::sort(entry.latencies.begin(), entry.latencies.end());
+   printf("%-16s %7lu %7lu %6lu %6lu %7lu %9.2f %9.2f %9.2f\n",
+         name, entry.sent, entry.replies, entry.busy, entry.failed, entry.dropped,
+         percentile(entry.latencies, 50)*1000,
+         percentile(entry.latencies, 99)*1000,
+         entry.latencies.empty()?0.0:entry.latencies.back()*1000);
+}
+
+int main(int argc, char *argv[]) {
+   const char     *device    = "/dev/ttyACM0";
+   double          rate      = 0;
+   unsigned        window    = 1;
+   unsigned long   count     = 1000;
+   double          timeout   = 2.0;
+   unsigned        seed      = 1;
+   std::vector<MixEntry> mix;
+
+   int opt;
+   while ((opt = getopt(argc, argv, "d:r:w:n:t:s:m:")) != -1) {
+      switch(opt) {
+         case 'd': device  = optarg;                              break;
+         case 'r': rate    = strtod(optarg, nullptr);             break;
+         case 'w': window  = strtoul(optarg, nullptr, 10);        break;
+         case 'n': count   = strtoul(optarg, nullptr, 10);        break;
+         case 't': timeout = strtoul(optarg, nullptr, 10)/1000.0; break;
+         case 's': seed    = strtoul(optarg, nullptr, 10);        break;
+         case 'm': {
+            std::string arg = optarg;
+            std::string::size_type colon = arg.rfind(':');
+            unsigned weight = (colon == std::string::npos)?1:strtoul(arg.substr(colon+1).c_str(), nullptr, 10);
+            mix.emplace_back(arg.substr(0, colon), weight);
+            break;
+         }
+         default:
+            fprintf(stderr, "Usage: %s [-d device] [-r rate] [-w window] [-n count] [-t timeout_ms] [-s seed] [-m command:weight]...\n", argv[0]);
+            return EXIT_FAILURE;
+      }
+   }
+   if (window < 1) {
+      window = 1;
+   }
+   if (mix.empty()) {
+      mix.emplace_back("IDN?",   4);
+      mix.emplace_back("THERM?", 2);
+      mix.emplace_back("PLOT?",  1);
+      mix.emplace_back("PROF?",  2);
+      mix.emplace_back("RUN?",   1);
+   }
+   std::vector<unsigned> weights;
+   for (const MixEntry &entry:mix) {
+      weights.push_back(entry.weight);
+   }
+   std::mt19937 generator(seed);
+   std::discrete_distribution<unsigned> chooser(weights.begin(), weights.end());
+
+   try {
+      SerialPort port(device);
+
+      std::deque<Outstanding> outstanding;
+      std::string   received;
+      unsigned long sent          = 0;
+      unsigned long bytes         = 0;
+      unsigned long unmatched     = 0;
+      double        start         = now();
+      double        nextSend      = start;
+
+      while ((sent < count) || !outstanding.empty()) {
+         double time = now();
+
+         // Send commands that are due
+         while ((sent < count) && (outstanding.size() < window) && (time >= nextSend)) {
+            MixEntry &entry = mix[chooser(generator)];
+            port.write(entry.command + "\n");
+            outstanding.push_back(Outstanding{&entry, now()});
+            entry.sent++;
+            sent++;
+            if (rate > 0) {
+               nextSend = start + sent/rate;
+            }
+         }
+
+         // Expire commands that have had no reply
+         while (!outstanding.empty() && ((time - outstanding.front().sendTime) > timeout)) {
+            outstanding.front().entry->dropped++;
+            outstanding.pop_front();
+         }
+
+         // Wait for reply or next send time
+         double waitUntil = outstanding.empty()?nextSend:outstanding.front().sendTime+timeout;
+         if ((sent < count) && (outstanding.size() < window) && (nextSend < waitUntil)) {
+            waitUntil = nextSend;
+         }
+         int waitMs = (int)((waitUntil-now())*1000)+1;
+         if (waitMs < 0) {
+            waitMs = 0;
+         }
+         bytes += port.read(received, waitMs);
+         double replyTime = now();
+
+         // Match replies with outstanding commands
+         std::string::size_type end;
+         while ((end = received.find("\n\r")) != std::string::npos) {
+            std::string reply = received.substr(0, end);
+            received.erase(0, end+2);
+
+            std::deque<Outstanding>::iterator it = outstanding.begin();
+            while ((it != outstanding.end()) && !isPossibleReply(it->entry->command, reply)) {
+               ++it;
+            }
+            if (it == outstanding.end()) {
+               unmatched++;
+               continue;
+            }
+            // Older commands without a reply were dropped
+            for (std::deque<Outstanding>::iterator skipped = outstanding.begin(); skipped != it; ++skipped) {
+               skipped->entry->dropped++;
+            }
+            MixEntry *entry = it->entry;
+            entry->replies++;
+            entry->latencies.push_back(replyTime - it->sendTime);
+            if (reply == "Failed - Busy") {
+               entry->busy++;
+            }
+            else if (reply.compare(0, 6, "Failed") == 0) {
+               entry->failed++;
+            }
+            outstanding.erase(outstanding.begin(), it+1);
+         }
+      }
+      double elapsed = now() - start;
+
+      MixEntry total("total", 0);
+      for (MixEntry &entry:mix) {
+         total.sent    += entry.sent;
+         total.replies += entry.replies;
+         total.busy    += entry.busy;
+         total.failed  += entry.failed;
+         total.dropped += entry.dropped;
+         total.latencies.insert(total.latencies.end(), entry.latencies.begin(), entry.latencies.end());
+      }
+      printf("%-16s %7s %7s %6s %6s %7s %9s %9s %9s\n",
+            "command", "sent", "replies", "busy", "failed", "dropped", "p50_ms", "p99_ms", "max_ms");
+      for (MixEntry &entry:mix) {
+         report(entry.command.c_str(), entry);
+      }
+      report("total", total);
+      printf("\n%lu commands in %.3f s = %.1f commands/s, %.1f kB/s received, %lu unmatched replies\n",
+            total.replies, elapsed, total.replies/elapsed, bytes/elapsed/1000, unmatched);
+      printf("Busy rate %.2f%%, drop rate %.2f%%\n",
+            total.sent?(100.0*total.busy)/total.sent:0.0, total.sent?(100.0*total.dropped)/total.sent:0.0);
+
+      return ((total.dropped == 0) && (unmatched == 0))?EXIT_SUCCESS:EXIT_FAILURE;
+   }
+   catch (Error &e) {
+      fprintf(stderr, "%s\n", e.what());
+      return EXIT_FAILURE;
+   }
+}
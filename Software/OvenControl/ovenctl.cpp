@@ -0,0 +1,472 @@
+/**
+ * @file    ovenctl.cpp
+ * @brief   Host client library for the oven remote protocol (libovenctl)
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <termios.h>
+#include <poll.h>
+#include "crc32.h"
+#include "ovenctl.h"
+
+namespace OvenCtl {
+
+/** Longest command accepted by oven (excluding line terminator) */
+static constexpr size_t MAX_COMMAND_LENGTH = 97;
+
+/** Longest profile description accepted by oven */
+static constexpr size_t MAX_DESCRIPTION_LENGTH = 38;
+
+/** Reply terminator */
+static const char TERMINATOR[] = "\n\r";
+
+/**
+ * Create error message including system error description
+ *
+ * @param[in] message Message prefix
+ *
+ * @return Error
+ */
+static Error systemError(const std::string &message) {
+   return Error(message + ": " + strerror(errno));
+}
+
+/**
+ * Convert field to integer
+ *
+ * @param[in] field  Field to convert
+ * @param[in] radix  Radix of number
+ *
+ * @return Value
+ *
+ * @throw Error if not a valid number
+ */
+static long toInteger(const std::string &field, int radix=10) {
+   char *end;
+   long value = strtol(field.c_str(), &end, radix);
+   if (field.empty() || (*end != '\0')) {
+      throw Error("Invalid number '" + field + "'");
+   }
+   return value;
+}
+
+/**
+ * Convert field to float
+ *
+ * @param[in] field  Field to convert
+ *
+ * @return Value
+ *
+ * @throw Error if not a valid number
+ */
+static float toFloat(const std::string &field) {
+   char *end;
+   float value = strtof(field.c_str(), &end);
+   if (field.empty() || (*end != '\0')) {
+      throw Error("Invalid number '" + field + "'");
+   }
+   return value;
+}
+
+/**
+ * Remove trailing terminator characters
+ *
+ * @param[in] text Text to trim
+ *
+ * @return Trimmed text
+ */
+static std::string trimRecord(const std::string &text) {
+   std::string::size_type last = text.find_last_not_of(";, \n\r");
+   return (last == std::string::npos)?"":text.substr(0, last+1);
+}
+
+/**
+ * Accumulate a CRC-32 over characters (matches firmware)
+ *
+ * @param[in] crc   CRC of preceding characters
+ * @param[in] text  Characters to add
+ *
+ * @return Updated CRC
+ */
+static uint32_t addToChecksum(uint32_t crc, const std::string &text) {
+   return crc32(text.data(), text.size(), crc);
+}
+
+std::vector<std::string> split(const std::string &text, char separator) {
+   std::vector<std::string> fields;
+   std::string::size_type start = 0;
+   for(;;) {
+      std::string::size_type end = text.find(separator, start);
+      fields.push_back(text.substr(start, (end==std::string::npos)?std::string::npos:end-start));
+      if (end == std::string::npos) {
+         break;
+      }
+      start = end+1;
+   }
+   return fields;
+}
+
+SolderProfile SolderProfile::parse(const std::string &record) {
+   std::vector<std::string> fields = split(trimRecord(record), ',');
+   if (fields.size() != 12) {
+      throw Error("Invalid profile record '" + record + "'");
+   }
+   SolderProfile profile;
+   profile.index         = toInteger(fields[0]);
+   profile.description   = fields[1];
+   profile.flags         = toInteger(fields[2], 16);
+   profile.liquidus      = toInteger(fields[3]);
+   profile.preheatTime   = toInteger(fields[4]);
+   profile.soakTemp1     = toInteger(fields[5]);
+   profile.soakTemp2     = toInteger(fields[6]);
+   profile.soakTime      = toInteger(fields[7]);
+   profile.rampUpSlope   = toFloat(fields[8]);
+   profile.peakTemp      = toInteger(fields[9]);
+   profile.peakDwell     = toInteger(fields[10]);
+   profile.rampDownSlope = toFloat(fields[11]);
+   return profile;
+}
+
+std::string SolderProfile::format() const {
+   if ((description.size() > MAX_DESCRIPTION_LENGTH) || (description.find_first_of(",;\n\r") != std::string::npos)) {
+      throw Error("Invalid profile description '" + description + "'");
+   }
+   char buff[100];
+   snprintf(buff, sizeof(buff), "%u,%s,%X,%d,%d,%d,%d,%d,%g,%d,%d,%g",
+         index, description.c_str(), flags, liquidus, preheatTime, soakTemp1, soakTemp2, soakTime,
+         rampUpSlope, peakTemp, peakDwell, rampDownSlope);
+   return buff;
+}
+
+DataPoint DataPoint::parse(const std::string &record) {
+   std::vector<std::string> fields = split(trimRecord(record), ',');
+   if (fields.size() != (6+NUM_THERMOCOUPLES)) {
+      throw Error("Invalid plot record '" + record + "'");
+   }
+   DataPoint point;
+   point.state              = fields[0];
+   point.time               = toInteger(fields[1]);
+   point.targetTemperature  = toFloat(fields[2]);
+   point.averageTemperature = toFloat(fields[3]);
+   point.heater             = toInteger(fields[4]);
+   point.fan                = toInteger(fields[5]);
+   for (unsigned t=0; t<NUM_THERMOCOUPLES; t++) {
+      point.temperature[t] = toFloat(fields[6+t]);
+   }
+   return point;
+}
+
+SerialPort::SerialPort(const std::string &device) {
+   fd = open(device.c_str(), O_RDWR|O_NOCTTY);
+   if (fd < 0) {
+      throw systemError(device);
+   }
+   termios tio;
+   if (tcgetattr(fd, &tio) == 0) {
+      cfmakeraw(&tio);
+      tio.c_cc[VMIN]  = 0;
+      tio.c_cc[VTIME] = 0;
+      tcsetattr(fd, TCSANOW, &tio);
+   }
+   flush();
+}
+
+SerialPort::~SerialPort() {
+   close(fd);
+}
+
+void SerialPort::write(const std::string &data) {
+   size_t offset = 0;
+   while (offset < data.size()) {
+      ssize_t size = ::write(fd, data.data()+offset, data.size()-offset);
+      if (size < 0) {
+         if (errno == EINTR) {
+            continue;
+         }
+         throw systemError("write");
+      }
+      offset += size;
+   }
+}
+
+size_t SerialPort::read(std::string &data, int timeoutMs) {
+   for(;;) {
+      pollfd pfd = {fd, POLLIN, 0};
+      int rc = poll(&pfd, 1, timeoutMs);
+      if (rc == 0) {
+         return 0;
+      }
+      if (rc < 0) {
+         if (errno == EINTR) {
+            continue;
+         }
+         throw systemError("poll");
+      }
+      char buff[4096];
+      ssize_t size = ::read(fd, buff, sizeof(buff));
+      if (size < 0) {
+         if (errno == EINTR) {
+            continue;
+         }
+         throw systemError("read");
+      }
+      if (size == 0) {
+         throw Error("Device closed");
+      }
+      data.append(buff, size);
+      return size;
+   }
+}
+
+void SerialPort::flush() {
+   tcflush(fd, TCIOFLUSH);
+}
+
+Oven::Oven(const std::string &device, int timeoutMs) : port(device), timeoutMs(timeoutMs) {
+}
+
+Oven::~Oven() {
+   try {
+      flush();
+   }
+   catch (Error &) {
+      // Ignore - nothing useful can be done
+   }
+}
+
+void Oven::receiveReply() {
+   std::string::size_type end;
+   while ((end = received.find(TERMINATOR)) == std::string::npos) {
+      if (port.read(received, timeoutMs) == 0) {
+         std::string command = pending.front().command;
+         pending.clear();
+         received.clear();
+         port.flush();
+         throw Error("Timeout waiting for reply to '" + command + "'");
+      }
+   }
+   std::string reply = received.substr(0, end);
+   received.erase(0, end+sizeof(TERMINATOR)-1);
+
+   Pending entry = pending.front();
+   pending.pop_front();
+   if (entry.handler) {
+      entry.handler(reply);
+   }
+}
+
+void Oven::submit(const std::string &command, ReplyHandler handler) {
+   if (command.size() > MAX_COMMAND_LENGTH) {
+      throw Error("Command too long '" + command + "'");
+   }
+   while (pending.size() >= MAX_PIPELINE_DEPTH) {
+      receiveReply();
+   }
+   port.write(command + "\n");
+   pending.push_back(Pending{command, handler});
+}
+
+void Oven::flush() {
+   while (!pending.empty()) {
+      receiveReply();
+   }
+}
+
+std::string Oven::transact(const std::string &command) {
+   std::string reply;
+   submit(command, [&reply](const std::string &r){ reply = r; });
+   flush();
+   if (reply.compare(0, 6, "Failed") == 0) {
+      throw FailedError(command + ": " + reply);
+   }
+   return reply;
+}
+
+void Oven::command(const std::string &command) {
+   std::string reply = transact(command);
+   if (reply != "OK") {
+      throw FailedError(command + ": " + reply);
+   }
+}
+
+std::string Oven::identify() {
+   return transact("IDN?");
+}
+
+SolderProfile Oven::getProfile() {
+   return SolderProfile::parse(transact("PROF?"));
+}
+
+void Oven::selectProfile(unsigned index) {
+   command("PROF " + std::to_string(index));
+}
+
+void Oven::setProfile(const SolderProfile &profile) {
+   command("PROF " + profile.format() + ";");
+}
+
+std::vector<SolderProfile> Oven::getProfiles() {
+   std::vector<std::string> records = split(transact("PROFS?"), ';');
+   unsigned long count = toInteger(records[0]);
+   if (records.size() != count+2) {
+      throw Error("Invalid PROFS? reply - " + std::to_string(records.size()-2) + " records, expected " + std::to_string(count));
+   }
+   std::vector<SolderProfile> profiles;
+   uint32_t checksum = 0;
+   for (unsigned long index=1; index<=count; index++) {
+      checksum = addToChecksum(checksum, records[index]+";");
+      profiles.push_back(SolderProfile::parse(records[index]));
+   }
+   if (toInteger(records[count+1], 16) != checksum) {
+      throw Error("PROFS? checksum error");
+   }
+   return profiles;
+}
+
+void Oven::setProfiles(const std::vector<SolderProfile> &profiles) {
+   command("PROFS " + std::to_string(profiles.size()));
+   uint32_t    checksum = 0;
+   std::string failure;
+   for (const SolderProfile &profile:profiles) {
+      std::string record = profile.format() + ";";
+      checksum = addToChecksum(checksum, record);
+      // Each record is acknowledged - the pipeline depth limits the records queued in the oven
+      submit(record, [&failure, record](const std::string &reply) {
+         if ((reply != "OK") && failure.empty()) {
+            failure = record + ": " + reply;
+         }
+      });
+   }
+   flush();
+   if (!failure.empty()) {
+      // Abandon the transaction
+      submit("PROFS END,0", ReplyHandler());
+      flush();
+      throw FailedError(failure);
+   }
+   char buff[20];
+   snprintf(buff, sizeof(buff), "PROFS END,%X", checksum);
+   command(buff);
+}
+
+std::vector<Thermocouple> Oven::getThermocouples() {
+   std::string reply = transact("THERM?");
+   std::vector<std::string> fields = split(trimRecord(reply), ',');
+   if (fields.size() != 2*NUM_THERMOCOUPLES) {
+      throw Error("Invalid THERM? reply '" + reply + "'");
+   }
+   std::vector<Thermocouple> thermocouples;
+   for (unsigned t=0; t<NUM_THERMOCOUPLES; t++) {
+      thermocouples.push_back(Thermocouple{toInteger(fields[2*t]) != 0, (int)toInteger(fields[2*t+1])});
+   }
+   return thermocouples;
+}
+
+void Oven::setThermocouples(const std::vector<Thermocouple> &thermocouples) {
+   if (thermocouples.size() != NUM_THERMOCOUPLES) {
+      throw Error("Wrong number of thermocouples");
+   }
+   std::string cmd = "THERM ";
+   for (unsigned t=0; t<NUM_THERMOCOUPLES; t++) {
+      cmd += std::to_string(thermocouples[t].enabled?1:0) + "," + std::to_string(thermocouples[t].offset);
+      cmd += (t != (NUM_THERMOCOUPLES-1))?",":";";
+   }
+   command(cmd);
+}
+
+PidParameters Oven::getPid() {
+   std::string reply = transact("PID?");
+   std::vector<std::string> fields = split(trimRecord(reply), ',');
+   if (fields.size() != 3) {
+      throw Error("Invalid PID? reply '" + reply + "'");
+   }
+   return PidParameters{toFloat(fields[0]), toFloat(fields[1]), toFloat(fields[2])};
+}
+
+void Oven::setPid(const PidParameters &pid) {
+   char buff[100];
+   snprintf(buff, sizeof(buff), "PID %g,%g,%g;", pid.kp, pid.ki, pid.kd);
+   command(buff);
+}
+
+void Oven::run() {
+   command("RUN");
+}
+
+void Oven::abort() {
+   command("ABORT");
+}
+
+RunState Oven::getRunState() {
+   std::string reply = transact("RUN?");
+   if (reply == "OK") {
+      return Run_Complete;
+   }
+   if (reply == "Running") {
+      return Run_Running;
+   }
+   return Run_Failed;
+}
+
+unsigned Oven::getPlot(PointHandler handler) {
+   flush();
+   submit("PLOT?", ReplyHandler());
+
+   bool     haveHeader = false;
+   unsigned expected   = 0;
+   unsigned count      = 0;
+   try {
+      for(;;) {
+         // Process complete records
+         for(;;) {
+            std::string::size_type recordEnd = received.find(';');
+            std::string::size_type replyEnd  = received.find(TERMINATOR);
+            if ((replyEnd != std::string::npos) && ((recordEnd == std::string::npos) || (replyEnd < recordEnd))) {
+               // End of reply
+               std::string rest = received.substr(0, replyEnd);
+               received.erase(0, replyEnd+sizeof(TERMINATOR)-1);
+               pending.pop_front();
+               if (!rest.empty() || !haveHeader) {
+                  throw FailedError("PLOT?: " + rest);
+               }
+               if (count != expected) {
+                  throw Error("PLOT? returned " + std::to_string(count) + " points, expected " + std::to_string(expected));
+               }
+               return count;
+            }
+            if (recordEnd == std::string::npos) {
+               break;
+            }
+            std::string record = received.substr(0, recordEnd);
+            received.erase(0, recordEnd+1);
+            if (!haveHeader) {
+               expected   = toInteger(record);
+               haveHeader = true;
+            }
+            else {
+               handler(DataPoint::parse(record));
+               count++;
+            }
+         }
+         if (port.read(received, timeoutMs) == 0) {
+            throw Error("Timeout during PLOT? after " + std::to_string(count) + " points");
+         }
+      }
+   }
+   catch (Error &) {
+      // Discard rest of reply
+      pending.clear();
+      received.clear();
+      port.flush();
+      throw;
+   }
+}
+
+}; // namespace OvenCtl
@@ -0,0 +1,394 @@
+/**
+ * @file    ovenctl.h
+ * @brief   Host client library for the oven remote protocol (libovenctl)
+ *
+ *  Speaks the protocol implemented by RemoteInterface.cpp over a serial device or pty.\n
+ *  All replies from the oven are terminated by "\n\r" and are returned in command order
+ *  so several commands may be outstanding at once (pipelining).
+ *
+ *  Errors are reported by throwing OvenCtl::Error.
+ *
+ *  Example:
+ *  @code
+ *     OvenCtl::Oven oven("/dev/ttyACM0");
+ *     OvenCtl::SolderProfile profile = oven.getProfile();
+ *     oven.getPlot([](const OvenCtl::DataPoint &point) {
+ *        printf("%d %.1f\n", point.time, point.averageTemperature);
+ *     });
+ *  @endcode
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#ifndef OVENCTL_H_
+#define OVENCTL_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <stdexcept>
+
+namespace OvenCtl {
+
+/** Number of thermocouples on oven */
+constexpr unsigned NUM_THERMOCOUPLES = 4;
+
+/** Number of profiles held by oven */
+constexpr unsigned MAX_PROFILES = 10;
+
+/**
+ * Maximum number of commands outstanding at once.\n
+ * The oven holds 4 commands including the one being executed and
+ * discards commands that do not fit so one entry is left spare.
+ */
+constexpr unsigned MAX_PIPELINE_DEPTH = 3;
+
+/** Default time to wait for a reply (ms) */
+constexpr int DEFAULT_TIMEOUT_MS = 2000;
+
+/**
+ * Error in communication with oven or unexpected reply
+ */
+class Error : public std::runtime_error {
+public:
+   Error(const std::string &message) : std::runtime_error(message) {}
+};
+
+/**
+ * Error reply from oven e.g. "Failed - Busy"
+ */
+class FailedError : public Error {
+public:
+   FailedError(const std::string &message) : Error(message) {}
+};
+
+/** Profile flags (see SolderProfile.h in firmware) */
+enum ProfileFlags {
+   P_UNLOCKED = (1<<0),
+   P_LEADFREE = (1<<1),
+};
+
+/**
+ * Solder profile as held by oven
+ */
+struct SolderProfile {
+   unsigned    index;            // Profile number in oven
+   std::string description;      // Description of the profile
+   unsigned    flags;            // Properties of the profile
+   int         liquidus;         // Liquidus temperature
+   int         preheatTime;      // Time to reach soakTemp1
+   int         soakTemp1;        // Temperature for start of soak
+   int         soakTemp2;        // Temperature for end of soak
+   int         soakTime;         // Length of soak
+   float       rampUpSlope;      // Slope up to peakTemp
+   int         peakTemp;         // Peak reflow temperature
+   int         peakDwell;        // How long to remain at peakTemp
+   float       rampDownSlope;    // Slope down after peakTemp
+
+   /**
+    * Parse profile record e.g.\n
+    * "4,My Profile,FF,183,140,183,90,1.4,210,15,-3.0;"
+    *
+    * @param[in] record Record to parse
+    *
+    * @return Profile
+    *
+    * @throw Error if record is invalid
+    */
+   static SolderProfile parse(const std::string &record);
+
+   /**
+    * Format as profile record (without terminator) e.g.\n
+    * "4,My Profile,FF,183,140,183,90,1.4,210,15,-3.0"
+    *
+    * @return Record
+    */
+   std::string format() const;
+};
+
+/**
+ * Point from oven plot log
+ */
+struct DataPoint {
+   std::string state;                           // State name e.g. "preheat"
+   int         time;                            // Time of point (s)
+   float       targetTemperature;               // Profile set-point
+   float       averageTemperature;              // Average of enabled thermocouples
+   int         heater;                          // Heater percentage
+   int         fan;                             // Fan percentage
+   float       temperature[NUM_THERMOCOUPLES];  // Individual thermocouples
+
+   /**
+    * Parse plot record e.g.\n
+    * "preheat,0,27.8,27.5,0,100,0.0,0.0,27.5,0.0"
+    *
+    * @param[in] record Record to parse
+    *
+    * @return Data point
+    *
+    * @throw Error if record is invalid
+    */
+   static DataPoint parse(const std::string &record);
+};
+
+/**
+ * Thermocouple settings
+ */
+struct Thermocouple {
+   bool enabled;  // Thermocouple is used for control
+   int  offset;   // Offset added to reading (-10..10)
+};
+
+/**
+ * PID controller parameters
+ */
+struct PidParameters {
+   float kp;   // Proportional gain
+   float ki;   // Integral gain
+   float kd;   // Differential gain
+};
+
+/**
+ * State of profile being run remotely
+ */
+enum RunState {
+   Run_Complete,  // Profile completed ("OK")
+   Run_Failed,    // Profile aborted or failed
+   Run_Running,   // Profile running
+};
+
+/**
+ * Split text into fields
+ *
+ * @param[in] text      Text to split
+ * @param[in] separator Separator character
+ *
+ * @return Fields
+ */
+std::vector<std::string> split(const std::string &text, char separator);
+
+/**
+ * Serial device in raw mode
+ */
+class SerialPort {
+
+private:
+   int fd;
+
+   SerialPort(const SerialPort &) = delete;
+   SerialPort &operator=(const SerialPort &) = delete;
+
+public:
+   /**
+    * Open serial device or pty
+    *
+    * @param[in] device Device path e.g. "/dev/ttyACM0"
+    *
+    * @throw Error on failure
+    */
+   SerialPort(const std::string &device);
+
+   ~SerialPort();
+
+   /**
+    * Write all data
+    *
+    * @param[in] data Data to write
+    *
+    * @throw Error on failure
+    */
+   void write(const std::string &data);
+
+   /**
+    * Read available data waiting up to timeout for the first byte
+    *
+    * @param[out] data       Data is appended to this string
+    * @param[in]  timeoutMs  Time to wait (ms)
+    *
+    * @return Number of bytes read (0 on timeout)
+    *
+    * @throw Error on failure
+    */
+   size_t read(std::string &data, int timeoutMs);
+
+   /**
+    * Discard any data waiting in either direction
+    */
+   void flush();
+};
+
+/**
+ * Connection to an oven
+ */
+class Oven {
+
+public:
+   /** Handler for a reply (without the "\n\r" terminator) */
+   using ReplyHandler = std::function<void(const std::string &reply)>;
+
+   /** Handler for each plot point as it arrives */
+   using PointHandler = std::function<void(const DataPoint &point)>;
+
+private:
+   /** Command waiting for its reply */
+   struct Pending {
+      std::string  command;
+      ReplyHandler handler;
+   };
+
+   SerialPort          port;
+   std::deque<Pending> pending;
+   std::string         received;
+   int                 timeoutMs;
+
+   /**
+    * Receive next reply and pass it to the handler of the oldest pending command
+    */
+   void receiveReply();
+
+   /**
+    * Send command and wait for the reply
+    *
+    * @param[in] command Command to send
+    *
+    * @return Reply
+    */
+   std::string transact(const std::string &command);
+
+   /**
+    * Send command and check for "OK" reply
+    *
+    * @param[in] command Command to send
+    *
+    * @throw FailedError if the oven did not reply "OK"
+    */
+   void command(const std::string &command);
+
+public:
+   /**
+    * Connect to oven
+    *
+    * @param[in] device     Serial device or pty
+    * @param[in] timeoutMs  Time to wait for replies (ms)
+    */
+   Oven(const std::string &device, int timeoutMs=DEFAULT_TIMEOUT_MS);
+
+   ~Oven();
+
+   /**
+    * Send command without waiting for the reply.\n
+    * Earlier replies are collected first if MAX_PIPELINE_DEPTH commands are already outstanding.
+    *
+    * @param[in] command  Command (without line terminator)
+    * @param[in] handler  Called with the reply when it arrives (may be empty to ignore reply)
+    */
+   void submit(const std::string &command, ReplyHandler handler);
+
+   /**
+    * Wait for replies to all outstanding commands
+    */
+   void flush();
+
+   /**
+    * Get number of commands waiting for a reply
+    *
+    * @return Number of commands outstanding
+    */
+   size_t getPendingCount() const {
+      return pending.size();
+   }
+
+   /**
+    * Identify oven
+    *
+    * @return Identification string e.g. "SMT-Oven 1.0.0.0"
+    */
+   std::string identify();
+
+   /**
+    * Get currently selected profile
+    */
+   SolderProfile getProfile();
+
+   /**
+    * Select profile without changing it
+    *
+    * @param[in] index Profile number
+    */
+   void selectProfile(unsigned index);
+
+   /**
+    * Change and select profile (profile.index selects the profile changed)
+    *
+    * @param[in] profile Profile to write
+    */
+   void setProfile(const SolderProfile &profile);
+
+   /**
+    * Get all profiles (checksum verified)
+    */
+   std::vector<SolderProfile> getProfiles();
+
+   /**
+    * Write several profiles in a single transaction.\n
+    * The oven only changes profiles if all are valid and none is locked.
+    *
+    * @param[in] profiles Profiles to write
+    */
+   void setProfiles(const std::vector<SolderProfile> &profiles);
+
+   /**
+    * Get thermocouple settings
+    */
+   std::vector<Thermocouple> getThermocouples();
+
+   /**
+    * Set thermocouple settings
+    *
+    * @param[in] thermocouples Settings for each thermocouple
+    */
+   void setThermocouples(const std::vector<Thermocouple> &thermocouples);
+
+   /**
+    * Get PID parameters
+    */
+   PidParameters getPid();
+
+   /**
+    * Set PID parameters
+    *
+    * @param[in] pid Parameters to set
+    */
+   void setPid(const PidParameters &pid);
+
+   /**
+    * Start running current profile
+    */
+   void run();
+
+   /**
+    * Abort running profile
+    */
+   void abort();
+
+   /**
+    * Get state of profile being run
+    */
+   RunState getRunState();
+
+   /**
+    * Get plot log.\n
+    * Points are parsed and passed to the handler as they arrive.
+    *
+    * @param[in] handler Called for each point
+    *
+    * @return Number of points
+    */
+   unsigned getPlot(PointHandler handler);
+};
+
+}; // namespace OvenCtl
+
+#endif /* OVENCTL_H_ */
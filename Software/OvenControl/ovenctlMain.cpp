@@ -0,0 +1,185 @@
+/**
+ * @file    ovenctlMain.cpp
+ * @brief   Command-line interface to the oven using libovenctl
+ *
+ *  Usage: ovenctl [-d device] [-t timeout_ms] command [arguments]
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ovenctl.h"
+
+using namespace OvenCtl;
+
+/**
+ * Print usage message
+ *
+ * @param[in] name Program name
+ */
+static void usage(const char *name) {
+   fprintf(stderr,
+         "Usage: %s [-d device] [-t timeout_ms] command [arguments]\n"
+         "  idn                         Identify oven\n"
+         "  prof                        Show current profile\n"
+         "  prof n                      Select profile n\n"
+         "  prof record                 Change and select profile e.g. \"5,My Profile,1,183,...,-3.0\"\n"
+         "  profs                       Show all profiles\n"
+         "  profs record...             Change several profiles in one transaction\n"
+         "  therm                       Show thermocouple settings\n"
+         "  therm e,o,e,o,e,o,e,o       Change thermocouple enables and offsets\n"
+         "  pid                         Show PID parameters\n"
+         "  pid kp ki kd                Change PID parameters\n"
+         "  run                         Start running current profile\n"
+         "  abort                       Abort running profile\n"
+         "  status                      Show state of running profile\n"
+         "  plot                        Write plot log as CSV as it arrives\n"
+         "  raw command...              Send raw commands (pipelined) and show replies\n",
+         name);
+}
+
+/**
+ * Print profile
+ *
+ * @param[in] profile Profile to print
+ */
+static void printProfile(const SolderProfile &profile) {
+   printf("%2u %-38s %s%s liquidus=%d preheat=%ds soak=%d-%d/%ds rampUp=%.1f peak=%d/%ds rampDown=%.1f\n",
+         profile.index, profile.description.c_str(),
+         (profile.flags&P_UNLOCKED)?"U":"-", (profile.flags&P_LEADFREE)?"F":"-",
+         profile.liquidus, profile.preheatTime, profile.soakTemp1, profile.soakTemp2, profile.soakTime,
+         profile.rampUpSlope, profile.peakTemp, profile.peakDwell, profile.rampDownSlope);
+}
+
+/**
+ * Execute command
+ *
+ * @param[in] oven  Oven to use
+ * @param[in] argc  Number of arguments (including command)
+ * @param[in] argv  Arguments
+ *
+ * @return Exit code
+ */
+static int doCommand(Oven &oven, int argc, char *argv[]) {
+   const char *command = argv[0];
+
+   if (strcmp(command, "idn") == 0) {
+      printf("%s\n", oven.identify().c_str());
+   }
+   else if ((strcmp(command, "prof") == 0) && (argc == 1)) {
+      printProfile(oven.getProfile());
+   }
+   else if ((strcmp(command, "prof") == 0) && (argc == 2)) {
+      if (strchr(argv[1], ',') == nullptr) {
+         oven.selectProfile(strtoul(argv[1], nullptr, 10));
+      }
+      else {
+         oven.setProfile(SolderProfile::parse(argv[1]));
+      }
+   }
+   else if ((strcmp(command, "profs") == 0) && (argc > 1)) {
+      std::vector<SolderProfile> profiles;
+      for (int index=1; index<argc; index++) {
+         profiles.push_back(SolderProfile::parse(argv[index]));
+      }
+      oven.setProfiles(profiles);
+   }
+   else if (strcmp(command, "profs") == 0) {
+      for (const SolderProfile &profile:oven.getProfiles()) {
+         printProfile(profile);
+      }
+   }
+   else if ((strcmp(command, "therm") == 0) && (argc == 1)) {
+      std::vector<Thermocouple> thermocouples = oven.getThermocouples();
+      for (unsigned t=0; t<thermocouples.size(); t++) {
+         printf("T%u %s offset=%d\n", t+1, thermocouples[t].enabled?"enabled ":"disabled", thermocouples[t].offset);
+      }
+   }
+   else if ((strcmp(command, "therm") == 0) && (argc == 2)) {
+      std::vector<std::string> fields = split(argv[1], ',');
+      if (fields.size() != 2*NUM_THERMOCOUPLES) {
+         throw Error("Expected 8 values");
+      }
+      std::vector<Thermocouple> thermocouples;
+      for (unsigned t=0; t<NUM_THERMOCOUPLES; t++) {
+         thermocouples.push_back(Thermocouple{atoi(fields[2*t].c_str()) != 0, atoi(fields[2*t+1].c_str())});
+      }
+      oven.setThermocouples(thermocouples);
+   }
+   else if ((strcmp(command, "pid") == 0) && (argc == 1)) {
+      PidParameters pid = oven.getPid();
+      printf("kp=%g ki=%g kd=%g\n", pid.kp, pid.ki, pid.kd);
+   }
+   else if ((strcmp(command, "pid") == 0) && (argc == 4)) {
+      oven.setPid(PidParameters{strtof(argv[1], nullptr), strtof(argv[2], nullptr), strtof(argv[3], nullptr)});
+   }
+   else if (strcmp(command, "run") == 0) {
+      oven.run();
+   }
+   else if (strcmp(command, "abort") == 0) {
+      oven.abort();
+   }
+   else if (strcmp(command, "status") == 0) {
+      static const char *const names[] = {"complete", "failed", "running"};
+      printf("%s\n", names[oven.getRunState()]);
+   }
+   else if (strcmp(command, "plot") == 0) {
+      printf("state,time,target,average,heater,fan,T1,T2,T3,T4\n");
+      oven.getPlot([](const DataPoint &point) {
+         printf("%s,%d,%.1f,%.1f,%d,%d,%.1f,%.1f,%.1f,%.1f\n",
+               point.state.c_str(), point.time, point.targetTemperature, point.averageTemperature,
+               point.heater, point.fan,
+               point.temperature[0], point.temperature[1], point.temperature[2], point.temperature[3]);
+         fflush(stdout);
+      });
+   }
+   else if ((strcmp(command, "raw") == 0) && (argc > 1)) {
+      for (int index=1; index<argc; index++) {
+         std::string cmd = argv[index];
+         oven.submit(cmd, [cmd](const std::string &reply) {
+            printf("%s -> %s\n", cmd.c_str(), reply.c_str());
+         });
+      }
+      oven.flush();
+   }
+   else {
+      return -1;
+   }
+   return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[]) {
+   const char *device    = "/dev/ttyACM0";
+   int         timeoutMs = DEFAULT_TIMEOUT_MS;
+
+   int opt;
+   while ((opt = getopt(argc, argv, "+d:t:")) != -1) {
+      switch(opt) {
+         case 'd': device    = optarg;       break;
+         case 't': timeoutMs = atoi(optarg); break;
+         default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+      }
+   }
+   if (optind >= argc) {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+   }
+   try {
+      Oven oven(device, timeoutMs);
+      int rc = doCommand(oven, argc-optind, argv+optind);
+      if (rc < 0) {
+         usage(argv[0]);
+         return EXIT_FAILURE;
+      }
+      return rc;
+   }
+   catch (Error &e) {
+      fprintf(stderr, "%s\n", e.what());
+      return EXIT_FAILURE;
+   }
+}
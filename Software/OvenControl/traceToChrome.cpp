@@ -0,0 +1,198 @@
+/**
+ * @file    traceToChrome.cpp
+ * @brief   Converts an oven event trace (TRACE? response) to Chrome trace JSON
+ *
+ *  Usage: traceToChrome [trace.txt [trace.json]]\n
+ *  Reads from stdin and writes to stdout if files are not given.\n
+ *  The result may be loaded into chrome://tracing or https://ui.perfetto.dev
+ *
+ *  Input format (see RemoteInterface.cpp):
+ *    frequency,number_of_threads,number_of_events;[context,name;]*[timestamp,phase,context,name;]*
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+
+/** Contexts less than this are exception numbers rather than thread IDs */
+static constexpr unsigned long MAX_EXCEPTION_NUMBER = 256;
+
+/**
+ * Split text into fields
+ *
+ * @param[in] text      Text to split
+ * @param[in] separator Separator character
+ *
+ * @return Fields (leading/trailing white-space removed)
+ */
+static std::vector<std::string> split(const std::string &text, char separator) {
+   std::vector<std::string> fields;
+   std::string::size_type start = 0;
+   for(;;) {
+      std::string::size_type end = text.find(separator, start);
+      std::string field = text.substr(start, (end==std::string::npos)?std::string::npos:end-start);
+      std::string::size_type first = field.find_first_not_of(" \t\r\n");
+      std::string::size_type last  = field.find_last_not_of(" \t\r\n");
+      fields.push_back((first==std::string::npos)?"":field.substr(first, last-first+1));
+      if (end == std::string::npos) {
+         break;
+      }
+      start = end+1;
+   }
+   return fields;
+}
+
+/**
+ * Write string as JSON string literal
+ *
+ * @param[in] fp    File to write to
+ * @param[in] text  Text to write
+ */
+static void writeJsonString(FILE *fp, const std::string &text) {
+   fputc('"', fp);
+   for (char ch:text) {
+      if ((ch == '"') || (ch == '\\')) {
+         fputc('\\', fp);
+         fputc(ch, fp);
+      }
+      else if ((unsigned char)ch < ' ') {
+         fprintf(fp, "\\u%04x", ch);
+      }
+      else {
+         fputc(ch, fp);
+      }
+   }
+   fputc('"', fp);
+}
+
+/**
+ * Write thread name meta-data record
+ *
+ * @param[in] fp      File to write to
+ * @param[in] context Thread context
+ * @param[in] name    Thread name
+ */
+static void writeThreadName(FILE *fp, unsigned long context, const std::string &name) {
+   fprintf(fp, "  {\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":", context);
+   writeJsonString(fp, name);
+   fprintf(fp, "}},\n");
+}
+
+int main(int argc, char *argv[]) {
+   FILE *in  = stdin;
+   FILE *out = stdout;
+   if (argc > 3) {
+      fprintf(stderr, "Usage: %s [trace.txt [trace.json]]\n", argv[0]);
+      return EXIT_FAILURE;
+   }
+   if ((argc > 1) && ((in = fopen(argv[1], "r")) == nullptr)) {
+      perror(argv[1]);
+      return EXIT_FAILURE;
+   }
+   if ((argc > 2) && ((out = fopen(argv[2], "w")) == nullptr)) {
+      perror(argv[2]);
+      return EXIT_FAILURE;
+   }
+   std::string text;
+   int ch;
+   while ((ch = fgetc(in)) != EOF) {
+      text += (char)ch;
+   }
+   std::vector<std::string> records = split(text, ';');
+
+   std::vector<std::string> header = split(records[0], ',');
+   if (header.size() != 3) {
+      fprintf(stderr, "Invalid trace header '%s'\n", records[0].c_str());
+      return EXIT_FAILURE;
+   }
+   double        frequency  = strtod(header[0].c_str(), nullptr);
+   unsigned long numThreads = strtoul(header[1].c_str(), nullptr, 10);
+   unsigned long numEvents  = strtoul(header[2].c_str(), nullptr, 10);
+   if ((frequency <= 0) || (records.size() < (1+numThreads+numEvents))) {
+      fprintf(stderr, "Truncated or invalid trace (%lu records expected, %lu found)\n",
+            (unsigned long)(1+numThreads+numEvents), (unsigned long)records.size());
+      return EXIT_FAILURE;
+   }
+
+   fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+   // Named threads
+   std::map<unsigned long, std::string> threadNames;
+   for (unsigned long index=0; index<numThreads; index++) {
+      std::vector<std::string> fields = split(records[1+index], ',');
+      if (fields.size() != 2) {
+         fprintf(stderr, "Invalid thread record '%s'\n", records[1+index].c_str());
+         return EXIT_FAILURE;
+      }
+      threadNames[strtoul(fields[0].c_str(), nullptr, 16)] = fields[1];
+   }
+
+   // Events - the 32-bit time-stamps are unwrapped assuming events are in time order
+   std::set<unsigned long> contexts;
+   uint64_t base          = 0;
+   uint32_t lastTimestamp = 0;
+   uint64_t firstTime     = 0;
+   for (unsigned long index=0; index<numEvents; index++) {
+      const std::string &record = records[1+numThreads+index];
+      std::vector<std::string> fields = split(record, ',');
+      if ((fields.size() != 4) || (fields[1].size() != 1)) {
+         fprintf(stderr, "Invalid event record '%s'\n", record.c_str());
+         return EXIT_FAILURE;
+      }
+      uint32_t      timestamp = (uint32_t)strtoul(fields[0].c_str(), nullptr, 16);
+      char          phase     = fields[1][0];
+      unsigned long context   = strtoul(fields[2].c_str(), nullptr, 16);
+
+      if ((index != 0) && (timestamp < lastTimestamp)) {
+         base += (1ULL<<32);
+      }
+      lastTimestamp = timestamp;
+      uint64_t time = base + timestamp;
+      if (index == 0) {
+         firstTime = time;
+      }
+      contexts.insert(context);
+
+      fprintf(out, "  {\"name\":");
+      writeJsonString(out, fields[3]);
+      fprintf(out, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%lu%s},\n",
+            phase, ((time-firstTime)*1000000.0)/frequency, context, (phase=='i')?",\"s\":\"t\"":"");
+   }
+
+   // Thread names - exceptions are named by IRQ number
+   for (unsigned long context:contexts) {
+      std::map<unsigned long, std::string>::iterator it = threadNames.find(context);
+      if (it != threadNames.end()) {
+         continue;
+      }
+      char buff[40];
+      if (context < 16) {
+         snprintf(buff, sizeof(buff), "Exception %lu", context);
+      }
+      else if (context < MAX_EXCEPTION_NUMBER) {
+         snprintf(buff, sizeof(buff), "IRQ %lu", context-16);
+      }
+      else {
+         snprintf(buff, sizeof(buff), "Thread %lX", context);
+      }
+      threadNames[context] = buff;
+   }
+   for (const std::pair<const unsigned long, std::string> &entry:threadNames) {
+      writeThreadName(out, entry.first, entry.second);
+   }
+   fprintf(out, "  {\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"SMT-Oven\"}}\n]}\n");
+
+   if (out != stdout) {
+      fclose(out);
+   }
+   if (in != stdin) {
+      fclose(in);
+   }
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file    fuzzDoCommand.cpp
+ * @brief   Fuzz target for the complete remote command path
+ *
+ *  Each line of the input is delivered through putData() and the queued commands are
+ *  executed as the remote thread does. Every reply must be terminated by "\n\r" and
+ *  the oven state invariants must hold at the end of the input.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include "fuzzHarness.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+   Fuzz::reset();
+
+   Fuzz::Snapshot before;
+   before.take();
+
+   while (size > 0) {
+      // Deliver one line at a time so the 4-entry command queue does not overflow
+      const uint8_t *end = (const uint8_t *)memchr(data, '\n', size);
+      size_t length = (end == nullptr)?size:(end-data+1);
+      RemoteInterface::putData((int)length, data);
+      data += length;
+      size -= length;
+
+      Fuzz::processCommands();
+      if (!Fuzz::isTxTerminated()) {
+         Fuzz::fail("Reply not terminated");
+      }
+   }
+   Fuzz::checkInvariants(before);
+   return 0;
+}
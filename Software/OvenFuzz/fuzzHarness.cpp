@@ -0,0 +1,200 @@
+/**
+ * @file    fuzzHarness.cpp
+ * @brief   Host harness for fuzzing the oven remote command interface
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "fuzzHarness.h"
+#include "profileLibrary.h"
+
+/** Simulated profile library flash (see hostStubs.cpp) */
+extern uint8_t __profileLibrary_start__[];
+
+namespace Fuzz {
+
+/** Reply bytes sent since reset() */
+static unsigned long txCount;
+
+/** Last two bytes sent */
+static uint8_t txLast[2];
+
+void Snapshot::take() {
+   // Clear padding so snapshots can be compared with memcmp()
+   memset(static_cast<void*>(this), 0, sizeof(*this));
+   for (unsigned index=0; index<MAX_PROFILES; index++) {
+      profiles[index] = ::profiles[index];
+   }
+   for (int t=0; t<4; t++) {
+      enabled[t] = temperatureSensors.getThermocouple(t).isEnabled();
+      offsets[t] = temperatureSensors.getThermocouple(t).getOffset();
+   }
+   pid[0] = pidKp;
+   pid[1] = pidKi;
+   pid[2] = pidKd;
+   currentProfileIndex = ::currentProfileIndex;
+}
+
+bool Snapshot::isSame(const Snapshot &other) const {
+   return memcmp(this, &other, sizeof(*this)) == 0;
+}
+
+void fail(const char *message) {
+   fprintf(stderr, "Invariant failed: %s\n", message);
+   abort();
+}
+
+void drainTx() {
+   volatile const uint8_t *data;
+   bool isLast;
+   unsigned size;
+   while ((size = RemoteInterface::getTxData(data, RemoteInterface::TX_BUFFER_SIZE, isLast)) > 0) {
+      for (unsigned index=0; index<size; index++) {
+         txLast[0] = txLast[1];
+         txLast[1] = data[index];
+      }
+      txCount += size;
+      RemoteInterface::txDataSent(size);
+   }
+}
+
+unsigned long getTxCount() {
+   return txCount;
+}
+
+bool isTxTerminated() {
+   return (txCount == 0) || ((txLast[0] == '\n') && (txLast[1] == '\r'));
+}
+
+unsigned processCommands() {
+   unsigned count = 0;
+   for(;;) {
+      osEvent event = FuzzInterface::commandQueue.get(0);
+      if (event.status != osEventMail) {
+         return count;
+      }
+      FuzzInterface::Command *cmd = (FuzzInterface::Command *)event.value.p;
+      if (memchr(cmd->data, '\0', sizeof(cmd->data)) == nullptr) {
+         fail("Queued command is not terminated");
+      }
+      FuzzInterface::doCommand(cmd);
+      FuzzInterface::commandQueue.free(cmd);
+      Statistics::commandQueueUsed.add(-1);
+      drainTx();
+      count++;
+   }
+}
+
+void reset() {
+   static const SolderProfile *const predefined[] = {
+         &am4300profileA, &am4300profileB, &nc31profile, &syntechlfprofile, &defaultProfile,
+   };
+   constexpr unsigned NUM_PREDEFINED = sizeof(predefined)/sizeof(predefined[0]);
+
+   hostDelayHook = drainTx;
+
+   // Abandon any bulk profile transaction left by the previous input
+   FuzzInterface::Command idn;
+   strcpy(reinterpret_cast<char*>(idn.data), "IDN?\n");
+   idn.size = 5;
+   FuzzInterface::doCommand(&idn);
+
+   RemoteInterface::initialise();
+
+   // End any over-long command being discarded by putData()
+   static const uint8_t newLine[] = "\n";
+   RemoteInterface::putData(1, newLine);
+
+   RemoteInterface::txDataClear();
+   interactiveMutex.reset();
+   txCount   = 0;
+   txLast[0] = 0;
+   txLast[1] = 0;
+
+   for (unsigned index=0; index<MAX_PROFILES; index++) {
+      SolderProfile profile;
+      profile = *predefined[index%NUM_PREDEFINED];
+      if (index < LOCKED_PROFILES) {
+         profile.flags &= ~P_UNLOCKED;
+      }
+      else {
+         profile.flags |= P_UNLOCKED;
+      }
+      profiles[index] = profile;
+   }
+   for (int t=0; t<4; t++) {
+      temperatureSensors.getThermocouple(t).enable(true);
+      temperatureSensors.getThermocouple(t).setOffset(0);
+   }
+   pidKp = 0.1f;
+   pidKi = 0.024f;
+   pidKd = 23.4f;
+   currentProfileIndex = 0;
+
+   // Empty library
+   USBDM::Flash::eraseRange(__profileLibrary_start__, ProfileLibrary::LIBRARY_SIZE);
+   ProfileLibrary::initialise();
+}
+
+void checkInvariants(const Snapshot &before) {
+   Snapshot after;
+   after.take();
+
+   for (unsigned index=0; index<MAX_PROFILES; index++) {
+      SolderProfile &profile = after.profiles[index];
+      if (memchr(profile.description, '\0', sizeof(profile.description)) == nullptr) {
+         fail("Profile description not terminated");
+      }
+      if (((before.profiles[index].flags & P_UNLOCKED) == 0) &&
+          (memcmp(&before.profiles[index], &profile, sizeof(profile)) != 0)) {
+         fail("Locked profile changed");
+      }
+      if (!profile.isValid()) {
+         fail("Profile is invalid");
+      }
+      if (!isfinite(profile.rampUpSlope) || !isfinite(profile.rampDownSlope)) {
+         fail("Profile slope is not finite");
+      }
+   }
+   for (int t=0; t<4; t++) {
+      if ((after.offsets[t]<-10) || (after.offsets[t]>10)) {
+         fail("Thermocouple offset out of range");
+      }
+   }
+   for (int index=0; index<3; index++) {
+      if (!isfinite(after.pid[index])) {
+         fail("PID parameter is not finite");
+      }
+   }
+   if ((after.currentProfileIndex<0) || (after.currentProfileIndex>=(int)MAX_PROFILES)) {
+      fail("Current profile out of range");
+   }
+   // Every library profile can be loaded and the index agrees with flash
+   unsigned libraryCount = 0;
+   for (unsigned id=1; id<=ProfileLibrary::MAX_ID; id++) {
+      SolderProfile profile;
+      if (ProfileLibrary::find(id) == nullptr) {
+         continue;
+      }
+      libraryCount++;
+      if (!ProfileLibrary::load(id, profile) || !profile.isValid()) {
+         fail("Library profile is corrupt or invalid");
+      }
+   }
+   if (libraryCount != ProfileLibrary::getCount()) {
+      fail("Library count is wrong");
+   }
+   ProfileLibrary::initialise();
+   if (ProfileLibrary::getCount() != libraryCount) {
+      fail("Library index differs from flash");
+   }
+   // The remote thread holds interactiveMutex exactly once while it has the session lease
+   if (interactiveMutex.getCount() != (FuzzInterface::sessionLeaseHeld?1U:0U)) {
+      fail("Session lease and interactiveMutex disagree");
+   }
+}
+
+}; // namespace Fuzz
@@ -0,0 +1,111 @@
+/**
+ * @file    fuzzHarness.h
+ * @brief   Host harness for fuzzing the oven remote command interface
+ *
+ *  The firmware sources are compiled for the host with the stubs in stubs/ so the
+ *  command parsers run unchanged. Each fuzz target resets the interface with
+ *  Fuzz::reset() before each input and checks the invariants afterwards.
+ *  A broken invariant calls abort() so the fuzzer records the input as a crash.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#ifndef FUZZHARNESS_H_
+#define FUZZHARNESS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "RemoteInterface.h"
+
+/** Parsers from RemoteInterface.cpp (not declared in any header) */
+bool parseProfile(char *cmd);
+bool parseThermocouples(char *cmd);
+bool parsePidParameters(char *cmd);
+
+/**
+ * Gives the harness access to the protected parts of the remote interface
+ */
+class FuzzInterface : public RemoteInterface {
+public:
+   using RemoteInterface::Command;
+   using RemoteInterface::commandQueue;
+   using RemoteInterface::doCommand;
+   using RemoteInterface::sessionLeaseHeld;
+};
+
+namespace Fuzz {
+
+/** Number of leading profiles that are locked after reset() */
+constexpr unsigned LOCKED_PROFILES = 5;
+
+/**
+ * Copy of all the state that the remote commands may change
+ */
+struct Snapshot {
+   SolderProfile profiles[MAX_PROFILES];
+   bool          enabled[4];
+   int           offsets[4];
+   float         pid[3];
+   int           currentProfileIndex;
+
+   /**
+    * Record current state
+    */
+   void take();
+
+   /**
+    * Compare with another snapshot
+    *
+    * @param[in] other Snapshot to compare with
+    *
+    * @return true if identical
+    */
+   bool isSame(const Snapshot &other) const;
+};
+
+/**
+ * Return interface and oven state to the known starting point\n
+ * Profiles 0..LOCKED_PROFILES-1 are locked, the remainder are unlocked copies of the predefined profiles.
+ */
+void reset();
+
+/**
+ * Discard any data in the transmit ring (also called when a reply waits for space)
+ */
+void drainTx();
+
+/**
+ * Number of reply bytes sent since last reset()
+ */
+unsigned long getTxCount();
+
+/**
+ * Indicates if the data sent so far ends with the "\n\r" reply terminator (or nothing has been sent)
+ */
+bool isTxTerminated();
+
+/**
+ * Execute all commands waiting in the command queue as the remote thread does
+ *
+ * @return Number of commands executed
+ */
+unsigned processCommands();
+
+/**
+ * Check the invariants that must hold after any sequence of commands.\n
+ * Calls abort() if one fails.
+ *
+ * @param[in] before State at start of input (used to check locked profiles are unchanged)
+ */
+void checkInvariants(const Snapshot &before);
+
+/**
+ * Report a broken invariant and abort
+ *
+ * @param[in] message Description of invariant
+ */
+[[noreturn]] void fail(const char *message);
+
+}; // namespace Fuzz
+
+#endif /* FUZZHARNESS_H_ */
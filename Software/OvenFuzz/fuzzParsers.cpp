@@ -0,0 +1,50 @@
+/**
+ * @file    fuzzParsers.cpp
+ * @brief   Fuzz target for the PROF, THERM and PID argument parsers
+ *
+ *  The first byte of the input selects the parser, the remainder is passed to it
+ *  formatted as putData() would deliver it (truncated, '\n' and NUL terminated).\n
+ *  A parser that fails must leave the oven state unchanged.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include "fuzzHarness.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+   static bool (*const parsers[])(char *) = {
+         parseProfile, parseThermocouples, parsePidParameters,
+   };
+   constexpr unsigned NUM_PARSERS = sizeof(parsers)/sizeof(parsers[0]);
+
+   if (size < 1) {
+      return 0;
+   }
+   bool (*parser)(char *) = parsers[data[0]%NUM_PARSERS];
+   data++;
+   size--;
+
+   // Arguments as they appear in a command (less the command name)
+   char arguments[sizeof(FuzzInterface::Command::data)];
+   if (size > (sizeof(arguments)-2)) {
+      size = sizeof(arguments)-2;
+   }
+   memcpy(arguments, data, size);
+   arguments[size++] = '\n';
+   arguments[size++] = '\0';
+
+   Fuzz::reset();
+
+   Fuzz::Snapshot before;
+   before.take();
+
+   bool success = parser(arguments);
+
+   Fuzz::Snapshot after;
+   after.take();
+   if (!success && !before.isSame(after)) {
+      Fuzz::fail("Failed parse changed state");
+   }
+   Fuzz::checkInvariants(before);
+   return 0;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file    fuzzPutData.cpp
+ * @brief   Fuzz target for command assembly by RemoteInterface::putData()
+ *
+ *  The input is delivered in USB-sized chunks. The first byte sets the chunk size (1-64)
+ *  and whether the queue is emptied after each chunk (bit 7) so both queue-full and
+ *  normal operation are exercised.\n
+ *  Every queued command must fit the buffer and be '\n' and NUL terminated.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include "fuzzHarness.h"
+
+/**
+ * Remove all commands from queue checking each is well formed
+ */
+static void checkQueuedCommands() {
+   for(;;) {
+      osEvent event = FuzzInterface::commandQueue.get(0);
+      if (event.status != osEventMail) {
+         return;
+      }
+      FuzzInterface::Command *cmd = (FuzzInterface::Command *)event.value.p;
+      if ((cmd->size < 2) || (cmd->size > sizeof(cmd->data))) {
+         Fuzz::fail("Command size out of range");
+      }
+      if ((cmd->data[cmd->size-2] != '\n') || (cmd->data[cmd->size-1] != '\0')) {
+         Fuzz::fail("Command not terminated");
+      }
+      FuzzInterface::commandQueue.free(cmd);
+      Statistics::commandQueueUsed.add(-1);
+   }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+   if (size < 1) {
+      return 0;
+   }
+   size_t chunkSize   = 1+(data[0]&0x3F);
+   bool   emptyQueue  = (data[0]&0x80) != 0;
+   data++;
+   size--;
+
+   Fuzz::reset();
+
+   while (size > 0) {
+      size_t length = (size<chunkSize)?size:chunkSize;
+      RemoteInterface::putData((int)length, data);
+      data += length;
+      size -= length;
+      if (emptyQueue) {
+         checkQueuedCommands();
+      }
+   }
+   checkQueuedCommands();
+   return 0;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file    ptyOven.cpp
+ * @brief   Simulated oven on a pseudo-terminal for testing the host tools
+ *
+ *  Usage: ptyOven [-l link]
+ *    -l link  Create a symbolic link to the pty (e.g. /tmp/oven0) that is removed on exit
+ *
+ *  The remote command interface (RemoteInterface.cpp) runs unchanged with the host stubs
+ *  used by the fuzz targets, starting from the same state as Fuzz::reset().
+ *  The pty name is printed on standard output once the oven is ready.
+ *  Runs until SIGINT or SIGTERM.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include "fuzzHarness.h"
+
+/**
+ * Gives the simulated oven access to the session lease check
+ */
+class PtyOvenInterface : public FuzzInterface {
+public:
+   using RemoteInterface::checkSessionLease;
+   using RemoteInterface::SESSION_POLL_MS;
+};
+
+/** pty master - the oven end */
+static int master = -1;
+
+/** Set by signal to stop the oven */
+static volatile sig_atomic_t stopRequested = 0;
+
+/**
+ * Signal handler requesting exit
+ */
+static void stop(int) {
+   stopRequested = 1;
+}
+
+/**
+ * Write all data waiting in the transmit ring to the pty\n
+ * Also used as the osDelay() hook so a blocking reply that fills the ring can continue.
+ */
+static void sendTx() {
+   volatile const uint8_t *data;
+   bool isLast;
+   unsigned size;
+   while ((size = RemoteInterface::getTxData(data, RemoteInterface::TX_BUFFER_SIZE, isLast)) > 0) {
+      unsigned offset = 0;
+      while (offset < size) {
+         ssize_t written = write(master, (const uint8_t *)data+offset, size-offset);
+         if (written < 0) {
+            if (errno == EINTR) {
+               continue;
+            }
+            perror("write");
+            exit(EXIT_FAILURE);
+         }
+         offset += written;
+      }
+      RemoteInterface::txDataSent(size);
+   }
+}
+
+/**
+ * Set kernel tick from real time so session lease timeouts behave as on the oven
+ */
+static void updateSysTick() {
+   timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   hostSysTick = (uint32_t)(now.tv_sec*1000000ULL+now.tv_nsec/1000);
+}
+
+/**
+ * Execute all commands waiting in the command queue as the remote thread does
+ */
+static void processCommands() {
+   for(;;) {
+      osEvent event = FuzzInterface::commandQueue.get(0);
+      if (event.status != osEventMail) {
+         return;
+      }
+      FuzzInterface::Command *cmd = (FuzzInterface::Command *)event.value.p;
+      updateSysTick();
+      FuzzInterface::doCommand(cmd);
+      FuzzInterface::commandQueue.free(cmd);
+      Statistics::commandQueueUsed.add(-1);
+      sendTx();
+   }
+}
+
+int main(int argc, char *argv[]) {
+   const char *link = nullptr;
+
+   int opt;
+   while ((opt = getopt(argc, argv, "l:")) != -1) {
+      if (opt == 'l') {
+         link = optarg;
+      }
+      else {
+         fprintf(stderr, "Usage: %s [-l link]\n", argv[0]);
+         return EXIT_FAILURE;
+      }
+   }
+   master = posix_openpt(O_RDWR|O_NOCTTY);
+   if ((master < 0) || (grantpt(master) != 0) || (unlockpt(master) != 0)) {
+      perror("posix_openpt");
+      return EXIT_FAILURE;
+   }
+   const char *name = ptsname(master);
+
+   // Keep the slave open so the pty survives clients closing it, and make it raw until a client configures it
+   int slave = open(name, O_RDWR|O_NOCTTY);
+   termios tio;
+   if ((slave < 0) || (tcgetattr(slave, &tio) != 0)) {
+      perror(name);
+      return EXIT_FAILURE;
+   }
+   cfmakeraw(&tio);
+   tcsetattr(slave, TCSANOW, &tio);
+
+   if (link != nullptr) {
+      unlink(link);
+      if (symlink(name, link) != 0) {
+         perror(link);
+         return EXIT_FAILURE;
+      }
+   }
+   signal(SIGINT,  stop);
+   signal(SIGTERM, stop);
+
+   updateSysTick();
+   Fuzz::reset();
+   hostDelayHook = sendTx;
+
+   printf("%s\n", name);
+   fflush(stdout);
+
+   while (!stopRequested) {
+      pollfd pfd = {master, POLLIN, 0};
+      int rc = poll(&pfd, 1, PtyOvenInterface::SESSION_POLL_MS);
+      if ((rc < 0) && (errno != EINTR)) {
+         perror("poll");
+         break;
+      }
+      if ((rc > 0) && (pfd.revents & POLLIN)) {
+         uint8_t buff[64];
+         ssize_t size = read(master, buff, sizeof(buff));
+         if (size > 0) {
+            // Passed on in the same way as a USB packet
+            RemoteInterface::putData((int)size, buff);
+            processCommands();
+         }
+      }
+      updateSysTick();
+      PtyOvenInterface::checkSessionLease();
+   }
+   if (link != nullptr) {
+      unlink(link);
+   }
+   close(slave);
+   close(master);
+   return EXIT_SUCCESS;
+}
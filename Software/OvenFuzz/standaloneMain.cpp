@@ -0,0 +1,51 @@
+/**
+ * @file    standaloneMain.cpp
+ * @brief   Runs a fuzz target on files or stdin (for AFL and builds without libFuzzer)
+ *
+ *  Usage: fuzzTarget [file...]
+ *    Each file is passed to the target as one input. Standard input is used if no file is given.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+/**
+ * Read entire file
+ *
+ * @param[in]  fp   File to read
+ * @param[out] data Contents of file
+ */
+static void readFile(FILE *fp, std::vector<uint8_t> &data) {
+   uint8_t buffer[4096];
+   size_t  size;
+   data.clear();
+   while ((size = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+      data.insert(data.end(), buffer, buffer+size);
+   }
+}
+
+int main(int argc, char *argv[]) {
+   std::vector<uint8_t> data;
+
+   if (argc < 2) {
+      readFile(stdin, data);
+      return LLVMFuzzerTestOneInput(data.data(), data.size());
+   }
+   for (int index=1; index<argc; index++) {
+      FILE *fp = fopen(argv[index], "rb");
+      if (fp == nullptr) {
+         perror(argv[index]);
+         return EXIT_FAILURE;
+      }
+      readFile(fp, data);
+      fclose(fp);
+      LLVMFuzzerTestOneInput(data.data(), data.size());
+   }
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+/**
+ * @file    hostCmsis.h
+ * @brief   Single-threaded host replacement for the CMSIS-RTOS wrappers used by the remote interface
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#ifndef FUZZ_STUBS_HOSTCMSIS_H_
+#define FUZZ_STUBS_HOSTCMSIS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum osStatus {
+   osOK                 = 0,
+   osEventMail          = 0x20,
+   osErrorResource      = 0x81,
+   osErrorTimeoutResource = 0xC1,
+};
+
+struct osEvent {
+   osStatus status;
+   union {
+      uint32_t v;
+      void    *p;
+   } value;
+};
+
+typedef void *osThreadId;
+
+static constexpr uint32_t osWaitForever            = 0xFFFFFFFF;
+static constexpr uint32_t osKernelSysTickFrequency = 1000000;
+
+/** Free-running tick count (advanced by osDelay) */
+extern uint32_t hostSysTick;
+
+/** Hook called by osDelay() so the harness can drain the transmit ring */
+extern void (*hostDelayHook)();
+
+#define osKernelSysTickMicroSec(microsec) (((uint64_t)(microsec) * (osKernelSysTickFrequency)) / 1000000)
+
+static inline uint32_t osKernelSysTick() {
+   return hostSysTick;
+}
+
+static inline osStatus osDelay(uint32_t ms) {
+   hostSysTick += ms*1000;
+   if (hostDelayHook != nullptr) {
+      hostDelayHook();
+   }
+   return osOK;
+}
+
+static inline osThreadId osThreadGetId() {
+   return nullptr;
+}
+
+namespace CMSIS {
+
+/**
+ * Recursive mutex - single-threaded so only the count is tracked
+ */
+class Mutex {
+   unsigned count = 0;
+public:
+   osStatus wait(uint32_t = osWaitForever) {
+      count++;
+      return osOK;
+   }
+   osStatus release() {
+      if (count == 0) {
+         return osErrorResource;
+      }
+      count--;
+      return osOK;
+   }
+   unsigned getCount() const {
+      return count;
+   }
+   void reset() {
+      count = 0;
+   }
+};
+
+/**
+ * Mail queue with a fixed pool of N entries
+ */
+template<typename T, unsigned N>
+class MailQueue {
+   T        pool[N];
+   bool     used[N];
+   T       *fifo[N];
+   unsigned head = 0;
+   unsigned count = 0;
+public:
+   void create() {
+      for (unsigned index=0; index<N; index++) {
+         used[index] = false;
+      }
+      head  = 0;
+      count = 0;
+   }
+   T *alloc(uint32_t = osWaitForever) {
+      return allocISR();
+   }
+   T *allocISR() {
+      for (unsigned index=0; index<N; index++) {
+         if (!used[index]) {
+            used[index] = true;
+            return &pool[index];
+         }
+      }
+      return nullptr;
+   }
+   osStatus put(T *mail) {
+      fifo[(head+count)%N] = mail;
+      count++;
+      return osOK;
+   }
+   osEvent get(uint32_t = osWaitForever) {
+      osEvent event;
+      if (count == 0) {
+         event.status  = osOK;
+         event.value.p = nullptr;
+         return event;
+      }
+      event.status  = osEventMail;
+      event.value.p = fifo[head];
+      head = (head+1)%N;
+      count--;
+      return event;
+   }
+   osStatus free(T *mail) {
+      used[mail-pool] = false;
+      return osOK;
+   }
+};
+
+/**
+ * Thread - never run on host
+ */
+class Thread {
+public:
+   Thread(void (*)(const void *)) {}
+   void run() {}
+};
+
+}; // namespace CMSIS
+
+#endif /* FUZZ_STUBS_HOSTCMSIS_H_ */
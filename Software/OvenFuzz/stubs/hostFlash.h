@@ -0,0 +1,109 @@
+/**
+ * @file    hostFlash.h
+ * @brief   Non-volatile variables and flash held in RAM (same interface as ftfl.h)
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#ifndef FUZZ_STUBS_HOSTFLASH_H_
+#define FUZZ_STUBS_HOSTFLASH_H_
+
+#include <stdint.h>
+
+namespace USBDM {
+
+enum FlashDriverError_t {
+   FLASH_ERR_OK                = (0),
+   FLASH_ERR_ILLEGAL_PARAMS    = (2),
+};
+
+/**
+ * Program flash held in RAM\n
+ * Programming can only clear bits and erasing sets them as for NOR flash.
+ */
+class Flash {
+public:
+   static constexpr unsigned programFlashSectorSize = 2048;
+   static constexpr unsigned programFlashPhraseSize = 4;
+
+   static bool waitForFlashReady() { return true; }
+   static void waitUntilFlexIdle() {}
+
+   static FlashDriverError_t programRange(const uint8_t *data, uint8_t *address, uint32_t size) {
+      if ((((uintptr_t)address|size)&(programFlashPhraseSize-1)) != 0) {
+         return FLASH_ERR_ILLEGAL_PARAMS;
+      }
+      while (size-- > 0) {
+         *address++ &= *data++;
+      }
+      return FLASH_ERR_OK;
+   }
+
+   static FlashDriverError_t eraseRange(uint8_t *address, uint32_t size) {
+      if ((((uintptr_t)address|size)&(programFlashSectorSize-1)) != 0) {
+         return FLASH_ERR_ILLEGAL_PARAMS;
+      }
+      while (size-- > 0) {
+         *address++ = 0xFF;
+      }
+      return FLASH_ERR_OK;
+   }
+};
+
+/**
+ * Transactions have no effect as writes to RAM are immediate
+ */
+class FlexRamTransaction {
+public:
+   static bool isOpen() { return false; }
+   static void begin()  {}
+   static void commit() {}
+   class Scope {
+   public:
+      Scope()  {}
+      ~Scope() {}
+   };
+};
+
+template <typename T>
+class Nonvolatile {
+   T data;
+public:
+   void operator=(const Nonvolatile<T> &other) {
+      data = (T)other;
+   }
+   void operator=(const T &other) {
+      data = other;
+   }
+   operator T() const {
+      return data;
+   }
+};
+
+template <typename T, int dimension>
+class NonvolatileArray {
+   using TArray = T[dimension];
+   using TPtr   = const T(*);
+   T data[dimension];
+public:
+   void operator=(const TArray &other) {
+      for (int index=0; index<dimension; index++) {
+         data[index] = other[index];
+      }
+   }
+   void operator=(const NonvolatileArray &other) {
+      for (int index=0; index<dimension; index++) {
+         data[index] = other[index];
+      }
+   }
+   const T operator [](int index) {
+      return data[index];
+   }
+   operator TPtr() const {
+      return data;
+   }
+};
+
+}; // namespace USBDM
+
+#endif /* FUZZ_STUBS_HOSTFLASH_H_ */
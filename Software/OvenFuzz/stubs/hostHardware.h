@@ -0,0 +1,44 @@
+/**
+ * @file    hostHardware.h
+ * @brief   Minimal host replacement for the USBDM hardware header
+ *
+ *  Assertions abort so they are reported as crashes by the fuzzer.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#ifndef FUZZ_STUBS_HOSTHARDWARE_H_
+#define FUZZ_STUBS_HOSTHARDWARE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef DEBUG_BUILD
+#define NOINLINE_DEBUG __attribute__((noinline))
+#else
+#define NOINLINE_DEBUG
+#endif
+
+/** Debugger break-point - a crash on host */
+#define __BKPT() abort()
+
+/** Memory barrier - single-threaded on host */
+#define __DMB() ((void)0)
+
+#define usbdm_assert(__e, __m) ((__e) ? (void)0 : (fprintf(stderr, "Assertion Failed @%s:%d - %s\n", __FILE__, __LINE__, __m), abort()))
+
+namespace USBDM {
+
+/**
+ * Critical section - nothing to do on host
+ */
+class CriticalSection {
+public:
+   CriticalSection() {}
+   ~CriticalSection() {}
+};
+
+}; // namespace USBDM
+
+#endif /* FUZZ_STUBS_HOSTHARDWARE_H_ */
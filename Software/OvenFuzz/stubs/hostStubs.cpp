@@ -0,0 +1,150 @@
+/**
+ * @file    hostStubs.cpp
+ * @brief   Host implementations of the objects declared in hostStubs.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <math.h>
+#include "hostStubs.h"
+#include "calibration.h"
+#include "profileLibrary.h"
+#include "uiEvents.h"
+
+uint32_t hostSysTick   = 0;
+void (*hostDelayHook)() = nullptr;
+
+TemperatureSensors          temperatureSensors;
+CMSIS::Mutex                interactiveMutex;
+SeqLock                     configLock;
+USBDM::Nonvolatile<int>     currentProfileIndex;
+USBDM::Nonvolatile<float>   pidKp;
+USBDM::Nonvolatile<float>   pidKi;
+USBDM::Nonvolatile<float>   pidKd;
+
+/** Idle time and RTX time are not measured on the host */
+extern "C" {
+volatile uint32_t os_idle_cycles = 0;
+volatile uint32_t os_time        = 0;
+}
+
+/** Simulated profile library flash (sector aligned) */
+alignas(2048) uint8_t       __profileLibrary_start__[ProfileLibrary::LIBRARY_SIZE];
+
+namespace Draw {
+
+/** Plot with a few points so PLOT? produces a realistic reply */
+static TemperaturePlot plot;
+
+/** Data point returned for every time */
+static const DataPoint point = {s_preheat, 27.8, {0.0, 0.0, 27.5, 0.0}, 0, 100};
+
+const DataPoint &getDataPoint(int) {
+   return point;
+}
+
+TemperaturePlot &getData() {
+   plot.lastValid = 4;
+   return plot;
+}
+
+}; // namespace Draw
+
+namespace Reporter {
+
+const char *getStateName(State state) {
+   static const char *const names[] = {
+         "off", "fail", "init", "preheat", "soak", "ramp_up", "dwell", "ramp_down", "complete", "manual",
+   };
+   usbdm_assert((unsigned)state < (sizeof(names)/sizeof(names[0])), "Illegal state");
+   return names[state];
+}
+
+}; // namespace Reporter
+
+namespace AutoTune {
+
+bool getLastResult(RelayTuner::Result &result) {
+   result = RelayTuner::Result{3.7f, 82.0f, 17.1f, 2.5f, 149.0f, 21.0f, 1.7f, 0.0094f, 22.1f};
+   return true;
+}
+
+}; // namespace AutoTune
+
+namespace RunProfile {
+
+/** Simulated state of remotely run profile */
+static State runState = s_off;
+
+bool remoteStartRunProfile() {
+   runState = s_preheat;
+   return true;
+}
+
+bool remoteStartRunRecipe(unsigned) {
+   runState = s_preheat;
+   return true;
+}
+
+bool remoteStartRunLibrary(unsigned id) {
+   SolderProfile profile;
+   if (!ProfileLibrary::load(id, profile)) {
+      return false;
+   }
+   runState = s_preheat;
+   return true;
+}
+
+void abortRunProfile() {
+   runState = s_fail;
+}
+
+State remoteCheckRunProfile() {
+   // Profile completes after being checked once
+   State state = runState;
+   if (runState == s_preheat) {
+      runState = s_complete;
+   }
+   return state;
+}
+
+}; // namespace RunProfile
+
+namespace Calibration {
+
+/** Calibration of each thermocouple (gain, offset) */
+static float calibrations[NUM_CHANNELS][2] = {{1,0}, {1,0}, {1,0}, {1,0}};
+
+void get(unsigned channel, float &gain, float &offset) {
+   usbdm_assert(channel<NUM_CHANNELS, "Illegal thermocouple");
+   gain   = calibrations[channel][0];
+   offset = calibrations[channel][1];
+}
+
+bool set(unsigned channel, float gain, float offset) {
+   if ((channel >= NUM_CHANNELS) ||
+       !(gain >= MIN_GAIN) || !(gain <= MAX_GAIN) || !(fabsf(offset) <= MAX_OFFSET)) {
+      return false;
+   }
+   calibrations[channel][0] = gain;
+   calibrations[channel][1] = offset;
+   return true;
+}
+
+}; // namespace Calibration
+
+namespace ConfigCache {
+
+/** Nothing to cache as settings are held in RAM */
+void refresh() {
+}
+
+}; // namespace ConfigCache
+
+namespace UiEvents {
+
+/** There is no front panel */
+void post(UiEvent) {
+}
+
+}; // namespace UiEvents
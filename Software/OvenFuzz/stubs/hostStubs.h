@@ -0,0 +1,191 @@
+/**
+ * @file    hostStubs.h
+ * @brief   Host replacements for the oven application headers used by RemoteInterface.cpp
+ *
+ *  This file is force-included before the firmware sources. It defines the include guards
+ *  of the hardware-dependent headers (cmsis.h, hardware.h, system.h, flash.h, configure.h,
+ *  dataPoint.h, plotting.h, reporter.h, settings.h) and provides the few objects the remote interface uses from them.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#ifndef FUZZ_STUBS_HOSTSTUBS_H_
+#define FUZZ_STUBS_HOSTSTUBS_H_
+
+#define INCLUDE_USBDM_CMSIS_H_
+#define INCLUDE_USBDM_HARDWARE_H_
+#define INCLUDE_USBDM_SYSTEM_H_
+#define SOURCES_FLASH_H_
+#define SOURCES_CONFIGURE_H_
+#define SOURCES_DATAPOINT_H_
+#define SOURCES_PLOTTING_H_
+#define REPORTER_H_
+#define SOURCES_SETTINGS_H_
+#define SOURCES_CONFIGCACHE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "hostCmsis.h"
+#include "hostHardware.h"
+#include "hostFlash.h"
+#include "SolderProfile.h"
+#include "seqLock.h"
+#include "relayTuner.h"
+
+/**
+ * Mode of operation within profile (as dataPoint.h)
+ */
+enum State {
+   s_off,
+   s_fail,
+   s_init,
+   s_preheat,
+   s_soak,
+   s_ramp_up,
+   s_dwell,
+   s_ramp_down,
+   s_complete,
+   s_manual,
+};
+
+/**
+ * Thermocouple settings and health (as max31855.h)
+ */
+class Max31855 {
+   bool enabled = true;
+   int  offset  = 0;
+public:
+   enum ThermocoupleStatus {
+      TH_ENABLED,
+      TH_OPEN,
+      TH_SHORT_VCC,
+      TH_SHORT_GND,
+      TH_MISSING,
+      TH_DISABLED=0b111,
+   };
+   struct Health {
+      uint32_t           readings;
+      uint32_t           faults;
+      uint32_t           held;
+      uint32_t           excluded;
+      uint16_t           consecutiveFaults;
+      uint16_t           maxConsecutiveFaults;
+      ThermocoupleStatus lastFault;
+   };
+   void enable(bool enable = true) {
+      enabled = enable;
+   }
+   bool isEnabled() const {
+      return enabled;
+   }
+   void setOffset(int value) {
+      offset = value;
+   }
+   int getOffset() const {
+      return offset;
+   }
+   ThermocoupleStatus getLastReading(float &temperature, float &coldReference) {
+      temperature   = 25.0f+offset;
+      coldReference = 25.0f;
+      return enabled?TH_ENABLED:TH_DISABLED;
+   }
+   Health getHealth() const {
+      return Health{4800, 2, 2, 0, 0, 1, TH_OPEN};
+   }
+   void clearHealth() {
+   }
+};
+
+class TemperatureSensors {
+   Max31855 thermocouples[4];
+public:
+   static constexpr unsigned NUM_THERMOCOUPLES = 4;
+
+   Max31855 &getThermocouple(int index) {
+      usbdm_assert((index>=0) && (index<4), "Illegal thermocouple");
+      return thermocouples[index];
+   }
+   bool isRejected(int index) {
+      return index == 2;
+   }
+   void clearHealth() {
+   }
+};
+
+/**
+ * Data point for plotting (as dataPoint.h)
+ */
+class DataPoint {
+public:
+   static constexpr unsigned NUM_THERMOCOUPLES = 4;
+
+   State   state;
+   float   target;
+   float   temperatures[NUM_THERMOCOUPLES];
+   uint8_t heater;
+   uint8_t fan;
+
+   State getState() const {
+      return state;
+   }
+   float getTargetTemperature() const {
+      return target;
+   }
+   float getAverageTemperature() const {
+      return (temperatures[0]+temperatures[1]+temperatures[2]+temperatures[3])/NUM_THERMOCOUPLES;
+   }
+   int getTemperature(unsigned index, float &temperature) const {
+      temperature = temperatures[index];
+      return 0;
+   }
+   uint8_t getHeater() const {
+      return heater;
+   }
+   uint8_t getFan() const {
+      return fan;
+   }
+};
+
+class TemperaturePlot {
+public:
+   int lastValid = -1;
+   int getLastValid() const {
+      return lastValid;
+   }
+};
+
+namespace Draw {
+const DataPoint &getDataPoint(int time);
+TemperaturePlot &getData();
+};
+
+namespace Reporter {
+const char *getStateName(State state);
+};
+
+namespace ConfigCache {
+void refresh();
+};
+
+namespace AutoTune {
+bool getLastResult(RelayTuner::Result &result);
+};
+
+namespace RunProfile {
+bool  remoteStartRunProfile();
+bool  remoteStartRunRecipe(unsigned index);
+bool  remoteStartRunLibrary(unsigned id);
+void  abortRunProfile();
+State remoteCheckRunProfile();
+};
+
+extern TemperatureSensors          temperatureSensors;
+extern CMSIS::Mutex                interactiveMutex;
+extern SeqLock                     configLock;
+extern USBDM::Nonvolatile<int>     currentProfileIndex;
+extern USBDM::Nonvolatile<float>   pidKp;
+extern USBDM::Nonvolatile<float>   pidKi;
+extern USBDM::Nonvolatile<float>   pidKd;
+
+#endif /* FUZZ_STUBS_HOSTSTUBS_H_ */
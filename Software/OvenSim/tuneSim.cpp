@@ -0,0 +1,174 @@
+/**
+ * @file    tuneSim.cpp
+ * @brief   Host simulation of relay auto-tuning against an oven plant model
+ *
+ *  Usage: tuneSim [-K gain] [-T tau] [-L deadTime] [-a ambient] [-n noise]
+ *    -K gain      Plant steady-state gain (Celsius/%, default 2.5)
+ *    -T tau       Plant time constant (s, default 150)
+ *    -L deadTime  Plant dead time (s, default 20)
+ *    -a ambient   Ambient temperature (Celsius, default 25)
+ *    -n noise     Peak thermocouple noise (Celsius, default 0.25)
+ *
+ *  The firmware RelayTuner is run against a first-order-plus-dead-time model of the oven
+ *  sampled once a second with thermocouple quantisation (0.25 Celsius) and noise.
+ *  The identified model is compared with the plant and the tuned gains are then used
+ *  in a copy of the firmware PID calculation to follow a step to TUNE_SETPOINT.
+ *
+ *  Exit status is non-zero if the identified model is more than 30% from the plant.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+#include <deque>
+#include "autoTune.h"
+
+/**
+ * First-order-plus-dead-time model of the oven
+ */
+class Plant {
+   const float gain, tau, ambient;
+   std::deque<float> delay;
+   float temperature;
+
+public:
+   /**
+    * @param[in] gain     Steady-state gain (Celsius/%)
+    * @param[in] tau      Time constant (s)
+    * @param[in] deadTime Dead time (s)
+    * @param[in] ambient  Ambient temperature (Celsius)
+    * @param[in] step     Simulation step (s)
+    */
+   Plant(float gain, float tau, float deadTime, float ambient, float step) :
+      gain(gain), tau(tau), ambient(ambient), delay((size_t)(deadTime/step), 0.0f), temperature(ambient) {
+   }
+
+   /**
+    * Advance model by one step
+    *
+    * @param[in] heater Heater drive (%)
+    * @param[in] step   Simulation step (s)
+    *
+    * @return Temperature (Celsius)
+    */
+   float advance(float heater, float step) {
+      delay.push_back(heater);
+      float applied = delay.front();
+      delay.pop_front();
+      temperature += step*(ambient + gain*applied - temperature)/tau;
+      return temperature;
+   }
+};
+
+/**
+ * Thermocouple reading - quantised to 0.25 Celsius with noise
+ *
+ * @param[in] temperature True temperature
+ * @param[in] noise       Peak noise
+ *
+ * @return Reading
+ */
+static float measure(float temperature, float noise) {
+   float reading = temperature + noise*(2*(rand()/(float)RAND_MAX)-1);
+   return roundf(reading*4)/4;
+}
+
+/**
+ * Check identified value against plant
+ *
+ * @param[in] name     Name of value
+ * @param[in] value    Identified value
+ * @param[in] expected Plant value
+ *
+ * @return true if within 30%
+ */
+static bool check(const char *name, float value, float expected) {
+   float error = 100*(value-expected)/expected;
+   bool ok = fabsf(error) <= 30;
+   printf("%-10s %8.3f  plant %8.3f  error %+6.1f%% %s\n", name, value, expected, error, ok?"":"<- FAIL");
+   return ok;
+}
+
+int main(int argc, char *argv[]) {
+   float gain     = 2.5f;
+   float tau      = 150;
+   float deadTime = 20;
+   float ambient  = 25;
+   float noise    = 0.25f;
+
+   int opt;
+   while ((opt = getopt(argc, argv, "K:T:L:a:n:")) != -1) {
+      switch(opt) {
+         case 'K': gain     = strtof(optarg, nullptr); break;
+         case 'T': tau      = strtof(optarg, nullptr); break;
+         case 'L': deadTime = strtof(optarg, nullptr); break;
+         case 'a': ambient  = strtof(optarg, nullptr); break;
+         case 'n': noise    = strtof(optarg, nullptr); break;
+         default:
+            fprintf(stderr, "Usage: %s [-K gain] [-T tau] [-L deadTime] [-a ambient] [-n noise]\n", argv[0]);
+            return EXIT_FAILURE;
+      }
+   }
+   constexpr float STEP = 0.05f;
+
+   // Same parameters as the firmware auto-tune
+   using namespace AutoTune;
+   Plant      plant(gain, tau, deadTime, ambient, STEP);
+   RelayTuner tuner(TUNE_SETPOINT, ambient, TUNE_HIGH, TUNE_LOW, TUNE_HYSTERESIS, TUNE_TIMEOUT);
+
+   float temperature = ambient;
+   float heater      = 0;
+   int   time;
+   for (time=0; tuner.getStatus() == RelayTuner::Tune_Running; time++) {
+      heater = tuner.update(time, measure(temperature, noise));
+      for (int sub=0; sub<(int)(1/STEP); sub++) {
+         temperature = plant.advance(heater, STEP);
+      }
+   }
+   if (tuner.getStatus() != RelayTuner::Tune_Complete) {
+      printf("Tuning failed after %d s\n", time);
+      return EXIT_FAILURE;
+   }
+   const RelayTuner::Result &result = tuner.getResult();
+   printf("Tuning complete after %d s\n", time);
+   printf("Ku=%.3f %%/C, Pu=%.1f s, amplitude=%.2f C\n", result.ultimateGain, result.ultimatePeriod, result.amplitude);
+   printf("Kp=%.3f, Ki=%.5f, Kd=%.2f\n\n", result.kp, result.ki, result.kd);
+
+   bool ok = true;
+   ok = check("gain",     result.processGain,  gain)     && ok;
+   ok = check("tau",      result.timeConstant, tau)      && ok;
+   ok = check("deadTime", result.deadTime,     deadTime) && ok;
+
+   // Closed loop step to TUNE_SETPOINT using the firmware PID calculation (pid.h) at 0.25 s
+   constexpr float INTERVAL = 0.25f;
+   Plant loop(gain, tau, deadTime, ambient, STEP);
+   float ki        = result.ki*INTERVAL;
+   float kd        = result.kd/INTERVAL;
+   float integral  = 0;
+   float input     = ambient;
+   float peak      = ambient;
+   float settled   = -1;
+   temperature     = ambient;
+   for (int tick=0; tick<(int)(1800/INTERVAL); tick++) {
+      float lastInput = input;
+      input = measure(temperature, noise);
+      float error = TUNE_SETPOINT - input;
+      integral += ki*error;
+      integral  = fminf(fmaxf(integral, -100), 100);
+      float output = fminf(fmaxf(result.kp*error + integral - kd*(input-lastInput), -100), 100);
+      for (int sub=0; sub<(int)(INTERVAL/STEP); sub++) {
+         temperature = loop.advance(fmaxf(output, 0), STEP);
+      }
+      peak = fmaxf(peak, temperature);
+      if ((settled < 0) && (fabsf(temperature-TUNE_SETPOINT) < 2)) {
+         settled = tick*INTERVAL;
+      }
+   }
+   printf("\nClosed-loop step to %.0f C: overshoot %.1f C, within 2 C after %.0f s, final %.1f C\n",
+         TUNE_SETPOINT, peak-TUNE_SETPOINT, settled, temperature);
+
+   return ok?EXIT_SUCCESS:EXIT_FAILURE;
+}
@@ -14,10 +14,12 @@
 #ifndef SOURCES_FLASH_H_
 #define SOURCES_FLASH_H_
 
+#include <string.h>
 #include "derivative.h"
 #include "hardware.h"
 #include "delay.h"
 #include "smc.h"
+#include "cmsis_os.h"
 
 namespace USBDM {
 /**
@@ -351,6 +353,199 @@ public:
    static void eraseAll();
 };
 
+/**
+ * Groups updates of Nonvolatile variables so they are written to FlexRAM together.
+ *
+ * While a transaction is open, writes to Nonvolatile and NonvolatileArray objects go to a
+ * RAM shadow of the affected 32-bit FlexRAM words. Several writes to the same word are
+ * coalesced. On commit each shadowed word that differs from FlexRAM is written as a single
+ * 32-bit EEPROM record. Words that are unchanged are not written at all.
+ *
+ * The EEPROM emulation ignores FlexRAM writes while busy so there is still a wait after each
+ * changed word. However a 50 character description is at most 13 writes (rather than 50)
+ * and re-saving an unchanged profile does no writes.
+ *
+ * Reads through Nonvolatile objects on the thread that opened the transaction see the shadow.
+ * Other threads read FlexRAM as usual and only see changes after commit.
+ * Pointers obtained from NonvolatileArray (e.g. for strings) refer to FlexRAM and
+ * only see changes after commit.
+ *
+ * Transactions may be nested - the outermost commit writes to FlexRAM.
+ * Writes made outside a transaction are committed immediately.
+ * Only one thread may write Nonvolatile variables at a time (see configLock).
+ *
+ * @code
+ * {
+ *    FlexRamTransaction::Scope transaction;
+ *    profiles[3] = newProfile;
+ *    currentProfileIndex = 3;
+ * } // Written here
+ * @endcode
+ */
+class FlexRamTransaction {
+
+public:
+   /** Maximum number of words shadowed - a full shadow is written early */
+   static constexpr unsigned MAX_WORDS = 128;
+
+   /** Function called after changes are written to FlexRAM */
+   using CommitCallback = void (*)();
+
+private:
+   /**
+    * Shadowed FlexRAM word
+    */
+   struct Entry {
+      volatile uint32_t *address;   // Word in FlexRAM
+      uint32_t           value;     // New value of word
+   };
+
+   /** Shadowed words */
+   static Entry entries[MAX_WORDS];
+
+   /** Number of entries used */
+   static volatile unsigned count;
+
+   /** Nesting depth of transactions */
+   static volatile unsigned depth;
+
+   /** Thread that opened the outermost transaction */
+   static volatile osThreadId owner;
+
+   /** Called before changes are written */
+   static CommitCallback startCallback;
+
+   /** Called after changes are written */
+   static CommitCallback commitCallback;
+
+   /**
+    * Find the shadow of a FlexRAM word
+    *
+    * @param[in] address Address of word
+    *
+    * @return Shadow entry or nullptr if the word is not shadowed
+    */
+   static Entry *find(const volatile uint32_t *address) {
+      for (unsigned index=0; index<count; index++) {
+         if (entries[index].address == address) {
+            return &entries[index];
+         }
+      }
+      return nullptr;
+   }
+
+   /**
+    * Write shadowed words that have changed to FlexRAM and empty the shadow
+    */
+   static void flush();
+
+public:
+   /**
+    * Set functions to call before and after changes are written to FlexRAM\n
+    * This may be used to maintain a checksum of the FlexRAM contents.
+    * The callbacks must write to FlexRAM directly rather than through Nonvolatile variables.
+    *
+    * @param[in] start  Function to call before the first changed word is written (nullptr for none)
+    * @param[in] commit Function to call after all changed words are written (nullptr for none)
+    */
+   static void setCommitCallbacks(CommitCallback start, CommitCallback commit) {
+      startCallback  = start;
+      commitCallback = commit;
+   }
+
+   /**
+    * Indicates if a transaction is open on the current thread\n
+    * Only the thread that opened the transaction sees the shadow.
+    *
+    * @return true if open
+    */
+   static bool isOpen() {
+      return (depth > 0) && (owner == osThreadGetId());
+   }
+
+   /**
+    * Open a transaction (may be nested)
+    */
+   static void begin() {
+      if (depth == 0) {
+         owner = osThreadGetId();
+      }
+      depth = depth + 1;
+   }
+
+   /**
+    * Close a transaction\n
+    * Closing the outermost transaction writes the changes to FlexRAM.
+    */
+   static void commit() {
+      usbdm_assert(depth>0, "FlexRAM commit without begin");
+      if (depth == 1) {
+         flush();
+      }
+      depth = depth - 1;
+   }
+
+   /**
+    * Write a value to the shadow of FlexRAM
+    *
+    * @tparam T Type of value (1, 2 or 4 bytes, naturally aligned)
+    *
+    * @param[in] address Address of value in FlexRAM
+    * @param[in] value   Value to write
+    */
+   template<typename T>
+   static void write(T *address, const T &value) {
+      volatile uint32_t *word = (volatile uint32_t *)((uintptr_t)address & ~3);
+      Entry *entry = find(word);
+      if (entry == nullptr) {
+         if (count >= MAX_WORDS) {
+            // Shadow full
+            flush();
+         }
+         entry = &entries[count];
+         entry->address = word;
+         entry->value   = *word;
+         // Entry must be complete before it is visible to readers
+         __asm__ volatile("" ::: "memory");
+         count = count + 1;
+      }
+      memcpy((uint8_t *)&entry->value + ((uintptr_t)address & 3), &value, sizeof(T));
+   }
+
+   /**
+    * Read a value taking account of the shadow
+    *
+    * @tparam T Type of value (1, 2 or 4 bytes, naturally aligned)
+    *
+    * @param[in] address Address of value in FlexRAM
+    *
+    * @return Value
+    */
+   template<typename T>
+   static T read(const T *address) {
+      const Entry *entry = find((const volatile uint32_t *)((uintptr_t)address & ~3));
+      if (entry == nullptr) {
+         return *address;
+      }
+      T value;
+      memcpy(&value, (const uint8_t *)&entry->value + ((uintptr_t)address & 3), sizeof(T));
+      return value;
+   }
+
+   /**
+    * Transaction open for the life of the object
+    */
+   class Scope {
+   public:
+      Scope() {
+         begin();
+      }
+      ~Scope() {
+         commit();
+      }
+   };
+};
+
 /**
  * Class to wrap a scalar variable allocated within the FlexRam area.
  * Size is limited to 1, 2 or 4 bytes.
@@ -384,63 +579,57 @@ private:
 public:
    /**
     * Assign to underlying type.
-    * This adds a wait for the Flash to be updated
+    * This adds a wait for the Flash to be updated unless a transaction is open
     *
     * @param[in]  data The data to assign
     */
    void operator=(const Nonvolatile<T> &data ) {
-      this->data = (T)data;
-      Flash::waitUntilFlexIdle();
+      assign((T)data);
    }
    /**
     * Assign to underlying type.
-    * This adds a wait for the Flash to be updated
+    * This adds a wait for the Flash to be updated unless a transaction is open
     *
     * @param[in]  data The data to assign
     */
    void operator=(const T &data ) {
-      this->data = data;
-      Flash::waitUntilFlexIdle();
+      assign(data);
    }
    /**
     * Increment underlying type.
-    * This adds a wait for the Flash to be updated
+    * This adds a wait for the Flash to be updated unless a transaction is open
     *
     * @param[in]  change The amount to increment
     */
    void operator+=(const Nonvolatile<T> &change ) {
-      this->data += (T)change;
-      Flash::waitUntilFlexIdle();
+      assign((T)*this + (T)change);
    }
    /**
     * Increment underlying type.
-    * This adds a wait for the Flash to be updated
+    * This adds a wait for the Flash to be updated unless a transaction is open
     *
     * @param[in]  change The amount to increment
     */
    void operator+=(const T &change ) {
-      this->data += change;
-      Flash::waitUntilFlexIdle();
+      assign((T)*this + change);
    }
    /**
     * Decrement underlying type.
-    * This adds a wait for the Flash to be updated
+    * This adds a wait for the Flash to be updated unless a transaction is open
     *
     * @param[in]  change The amount to increment
     */
    void operator-=(const Nonvolatile<T> &change ) {
-      this->data -= (T)change;
-      Flash::waitUntilFlexIdle();
+      assign((T)*this - (T)change);
    }
    /**
     * Decrement underlying type.
-    * This adds a wait for the Flash to be updated
+    * This adds a wait for the Flash to be updated unless a transaction is open
     *
     * @param[in]  change The amount to increment
     */
    void operator-=(const T &change ) {
-      this->data -= change;
-      Flash::waitUntilFlexIdle();
+      assign((T)*this - change);
    }
    /**
     * Return the underlying object - <b>read-only</b>.
@@ -448,9 +637,24 @@ public:
     * @return underlying object
     */
    operator T() const {
+      if (FlexRamTransaction::isOpen()) {
+         return FlexRamTransaction::read(&data);
+      }
       Flash::waitUntilFlexIdle();
       return data;
    }
+
+private:
+   /**
+    * Assign to underlying type.
+    * This adds a wait for the Flash to be updated unless a transaction is open
+    *
+    * @param[in]  value The value to assign
+    */
+   void assign(const T &value) {
+      FlexRamTransaction::Scope transaction;
+      FlexRamTransaction::write(&data, value);
+   }
 };
 
 /**
@@ -493,12 +697,12 @@ public:
     *
     * @param[in]  other TArray to assign from
     *
-    * This adds a wait for the Flash to be updated after each element is assigned
+    * Elements are written as a transaction (see FlexRamTransaction)
     */
    void operator=(const TArray &other ) {
+      FlexRamTransaction::Scope transaction;
       for (int index=0; index<dimension; index++) {
-         data[index] = other[index];
-         Flash::waitUntilFlexIdle();
+         FlexRamTransaction::write(&data[index], other[index]);
       }
    }
 
@@ -507,16 +711,16 @@ public:
     *
     * @param[in]  other NonvolatileArray to assign from
     *
-    * This adds a wait for the Flash to be updated after each element is assigned
+    * Elements are written as a transaction (see FlexRamTransaction)
     */
    void operator=(const NonvolatileArray &other ) {
       if (this == &other) {
          // Identity check
          return;
       }
+      FlexRamTransaction::Scope transaction;
       for (int index=0; index<dimension; index++) {
-         data[index] = other[index];
-         Flash::waitUntilFlexIdle();
+         FlexRamTransaction::write(&data[index], other[index]);
       }
    }
 
@@ -525,11 +729,11 @@ public:
     *
     * @param[in]  other NonvolatileArray to assign to
     *
-    * This adds a wait for the Flash to be updated after each element is assigned
+    * Reads the pending values if a transaction is open on this thread
     */
    void copyTo(T *other) const {
       for (int index=0; index<dimension; index++) {
-         other[index] = data[index];
+         other[index] = (*this)[index];
       }
    }
 
@@ -540,12 +744,16 @@ public:
     *
     * @return Reference to underlying array
     */
-   const T operator [](int index) {
+   const T operator [](int index) const {
+      if (FlexRamTransaction::isOpen()) {
+         return FlexRamTransaction::read(&data[index]);
+      }
       return data[index];
    }
 
    /**
     * Return a pointer to the underlying array - read-only.
+    * This refers to FlexRAM so does not see changes until a transaction is committed.
     */
    operator TPtr() const {
       return data;
@@ -558,8 +766,8 @@ public:
     * @param[in]  value Value to initialise array elements to
     */
    void set(int index, T value) {
-      data[index] = value;
-      Flash::waitUntilFlexIdle();
+      FlexRamTransaction::Scope transaction;
+      FlexRamTransaction::write(&data[index], value);
    }
    /**
     * Set all elements of the array to the value provided.
@@ -567,9 +775,9 @@ public:
     * @param[in]  value Value to initialise array elements to
     */
    void set(T value) {
+      FlexRamTransaction::Scope transaction;
       for (int index=0; index<dimension; index++) {
-         data[index] = value;
-         Flash::waitUntilFlexIdle();
+         FlexRamTransaction::write(&data[index], value);
       }
    }
 };
@@ -872,6 +872,308 @@ public:
    }
 };
 
+/**
+ * Class for double-buffered (ping-pong) bulk/interrupt IN endpoint
+ *
+ * Separate buffers are used for the even and odd transmit BDTs so the next
+ * DATA transaction is already queued when the current one is acknowledged.\n
+ * The data is copied to the endpoint buffers when queued so the call-back is made
+ * as soon as the entire transfer has been queued (rather than sent).
+ * A new transfer may be started from the call-back while the tail of the
+ * previous transfer is still being transmitted.
+ *
+ * @tparam Info         Class describing associated USB hardware
+ * @tparam ENDPOINT_NUM Endpoint number
+ * @tparam EP_MAXSIZE   Maximum size of DATA transaction
+ */
+template<class Info, unsigned ENDPOINT_NUM, unsigned EP_MAXSIZE>
+class PingPongInEndpoint : public Endpoint_T<Info, ENDPOINT_NUM, EP_MAXSIZE> {
+
+protected:
+   using Endpoint_T<Info, ENDPOINT_NUM, EP_MAXSIZE>::fUsb;
+   using Endpoint = Endpoint_T<Info, ENDPOINT_NUM, EP_MAXSIZE>;
+   using Endpoint::fDataToggle;
+   using Endpoint::fTxOdd;
+   using Endpoint::fState;
+   using Endpoint::fNeedZLP;
+   using Endpoint::fDataPtr;
+   using Endpoint::fDataRemaining;
+   using Endpoint::fDataTransferred;
+   using Endpoint::fCallback;
+   using Endpoint::fDataBuffer;
+   using Endpoint::fEndpointSize;
+
+private:
+   // Make private
+   using Endpoint::startRxStage;
+   using Endpoint::startRxTransaction;
+   using Endpoint::saveRxData;
+   using Endpoint::startTxTransaction;
+
+   /** Buffer for odd transmit BDT */
+   static uint8_t fOddDataBuffer[EP_MAXSIZE] __attribute__ ((aligned (8)));
+
+   /** Number of transactions queued to USB hardware (0-2) */
+   volatile unsigned fInFlight;
+
+   /**
+    * Queue next DATA transaction if a BDT is free and data (or ZLP) remains
+    */
+   void queueTxTransaction() {
+      if ((fInFlight >= 2) || ((fDataRemaining == 0) && !fNeedZLP)) {
+         return;
+      }
+      // BDT and DATA0/1 for this transaction follow any transaction already queued
+      bool odd = (fTxOdd != BufferToggle_Even) ^ (fInFlight != 0);
+      bool data1 = (fDataToggle != DataToggle_0) ^ (fInFlight != 0);
+
+      volatile BdtEntry *bdt    = odd?&endPointBdts[ENDPOINT_NUM].txOdd:&endPointBdts[ENDPOINT_NUM].txEven;
+      volatile uint8_t  *buffer = odd?fOddDataBuffer:fDataBuffer;
+
+      usbdm_assert(bdt->own == BdtOwner_MCU, "MCU doesn't own BDT!");
+
+      uint16_t size = fDataRemaining;
+      if (size > fEndpointSize) {
+         size = fEndpointSize;
+      }
+      // No ZLP needed if sending undersize transaction
+      if (size<fEndpointSize) {
+         fNeedZLP = false;
+      }
+      if (fDataPtr != nullptr) {
+         Endpoint::safeCopy(buffer, fDataPtr, size);
+         fDataPtr += size;
+      }
+      fDataTransferred += size;
+      fDataRemaining   -= size;
+      fInFlight++;
+
+      bdt->setByteCount((uint8_t)size);
+      if (data1) {
+         bdt->setControl(BDTEntry_OWN_MASK|BDTEntry_DATA1_MASK|BDTEntry_DTS_MASK);
+      }
+      else {
+         bdt->setControl(BDTEntry_OWN_MASK|BDTEntry_DATA0_MASK|BDTEntry_DTS_MASK);
+      }
+   }
+
+public:
+   /**
+    * Constructor
+    */
+   constexpr PingPongInEndpoint(EndPointType endPointType) : Endpoint(endPointType), fInFlight(0) {
+   }
+
+   /**
+    * Initialise endpoint
+    *  - Internal state
+    *  - BDTs
+    *  - fUsb.ENDPOINT[].ENDPT
+    */
+   void initialise() {
+      Endpoint::initialise();
+      fInFlight = 0;
+
+      endPointBdts[ENDPOINT_NUM].txOdd.setAddress(nativeToLe32((uint32_t)fOddDataBuffer));
+
+      // Transmit only
+      fUsb.ENDPOINT[ENDPOINT_NUM].ENDPT = USB_ENDPT_EPTXEN_MASK|USB_ENDPT_EPHSHK_MASK;
+   }
+
+   /**
+    * Start IN transfer [Transmit, device -> host, DATA0/1 sequence]\n
+    * Up to two transactions are queued immediately.
+    *
+    * @param[in]  state   State to adopt for this phase (EPDataIn)
+    * @param[in]  bufSize Size of buffer to send (may be zero)
+    * @param[in]  bufPtr  Pointer to external buffer
+    */
+   void startTxStage(EndpointState state, uint8_t bufSize, volatile const uint8_t *bufPtr) {
+      fDataPtr         = (uint8_t*)bufPtr;
+      fDataTransferred = 0;
+      fDataRemaining   = bufSize;
+      fState           = state;
+      queueTxTransaction();
+      queueTxTransaction();
+   }
+
+   /**
+    * Handle IN token [Transmit, device -> host]
+    */
+   void handleInToken() {
+      // Toggle DATA0/1 for next transaction
+      fDataToggle = !fDataToggle;
+
+      if (fInFlight > 0) {
+         fInFlight--;
+      }
+      if (fState != EPDataIn) {
+         console.WRITE("Unexpected IN, ep=").WRITE(ENDPOINT_NUM).WRITE(", s=").WRITELN(Endpoint::getStateName());
+         fState = EPIdle;
+         return;
+      }
+      // Continue current transfer
+      queueTxTransaction();
+
+      if ((fDataRemaining == 0) && !fNeedZLP) {
+         // Entire transfer queued - call-back may start another transfer
+         EndpointState state = fCallback(EPDataIn);
+         if ((state == EPIdle) && (fInFlight > 0)) {
+            // Remain active until queued transactions complete
+            state = EPDataIn;
+         }
+         fState = state;
+      }
+   }
+
+   /**
+    * Get number of transactions queued to hardware
+    *
+    * @return Count (0-2)
+    */
+   unsigned getTransactionsInFlight() const {
+      return fInFlight;
+   }
+};
+
+template<class Info, unsigned ENDPOINT_NUM, unsigned EP_MAXSIZE>
+uint8_t PingPongInEndpoint<Info, ENDPOINT_NUM, EP_MAXSIZE>::fOddDataBuffer[EP_MAXSIZE];
+
+/**
+ * Class for double-buffered (ping-pong) bulk/interrupt OUT endpoint
+ *
+ * Separate buffers are used for the even and odd receive BDTs and both BDTs are
+ * kept armed so the host may send the next DATA transaction while the call-back
+ * processes the previous one.\n
+ * Each transaction is passed to the call-back individually (getBuffer(), getDataTransferredSize())
+ * and the BDT is re-armed when the call-back returns EPDataOut.
+ *
+ * @tparam Info         Class describing associated USB hardware
+ * @tparam ENDPOINT_NUM Endpoint number
+ * @tparam EP_MAXSIZE   Maximum size of DATA transaction
+ */
+template<class Info, unsigned ENDPOINT_NUM, unsigned EP_MAXSIZE>
+class PingPongOutEndpoint : public Endpoint_T<Info, ENDPOINT_NUM, EP_MAXSIZE> {
+
+protected:
+   using Endpoint_T<Info, ENDPOINT_NUM, EP_MAXSIZE>::fUsb;
+   using Endpoint = Endpoint_T<Info, ENDPOINT_NUM, EP_MAXSIZE>;
+   using Endpoint::fDataToggle;
+   using Endpoint::fRxOdd;
+   using Endpoint::fState;
+   using Endpoint::fDataTransferred;
+   using Endpoint::fCallback;
+   using Endpoint::fDataBuffer;
+   using Endpoint::fEndpointSize;
+
+private:
+   // Make private
+   using Endpoint::startTxStage;
+   using Endpoint::startTxTransaction;
+   using Endpoint::startRxTransaction;
+   using Endpoint::saveRxData;
+
+   /** Buffer for odd receive BDT */
+   static uint8_t fOddDataBuffer[EP_MAXSIZE] __attribute__ ((aligned (8)));
+
+   /** Buffer holding data from last completed transaction */
+   volatile uint8_t *fCompletedBuffer;
+
+   /**
+    * Arm receive BDT
+    *
+    * @param[in] bdt    BDT to arm
+    * @param[in] data1  True for DATA1, false for DATA0
+    */
+   void armRxBdt(volatile BdtEntry *bdt, bool data1) {
+      if (bdt->own != BdtOwner_MCU) {
+         // Already armed
+         return;
+      }
+      bdt->setByteCount(fEndpointSize);
+      if (data1) {
+         bdt->setControl(BDTEntry_OWN_MASK|BDTEntry_DATA1_MASK|BDTEntry_DTS_MASK);
+      }
+      else {
+         bdt->setControl(BDTEntry_OWN_MASK|BDTEntry_DATA0_MASK|BDTEntry_DTS_MASK);
+      }
+   }
+
+public:
+   /**
+    * Constructor
+    */
+   constexpr PingPongOutEndpoint(EndPointType endPointType) : Endpoint(endPointType), fCompletedBuffer(nullptr) {
+   }
+
+   /**
+    * Initialise endpoint
+    *  - Internal state
+    *  - BDTs
+    *  - fUsb.ENDPOINT[].ENDPT
+    */
+   void initialise() {
+      Endpoint::initialise();
+      fCompletedBuffer = fDataBuffer;
+
+      endPointBdts[ENDPOINT_NUM].rxOdd.setAddress(nativeToLe32((uint32_t)fOddDataBuffer));
+
+      // Receive only
+      fUsb.ENDPOINT[ENDPOINT_NUM].ENDPT = USB_ENDPT_EPRXEN_MASK|USB_ENDPT_EPHSHK_MASK;
+   }
+
+   /**
+    * Start receiving [Receive, device <- host, DATA0/1 sequence]\n
+    * Both BDTs are armed.
+    *
+    * @param[in]  state   State to adopt (EPDataOut)
+    */
+   void startRxStage(EndpointState state) {
+      fState           = state;
+      fDataTransferred = 0;
+      armRxBdt(Endpoint::getFreeBdtReceiveEntry(),  fDataToggle != DataToggle_0);
+      armRxBdt(Endpoint::getCompleteBdtReceiveEntry(), fDataToggle == DataToggle_0);
+   }
+
+   /**
+    * Handle OUT [Receive, device <- host, DATA0/1]
+    */
+   void handleOutToken() {
+      // BDT just completed (fRxOdd already advanced by flipOddEven())
+      volatile BdtEntry *bdt = Endpoint::getCompleteBdtReceiveEntry();
+
+      // Toggle DATA0/1 for next transaction (already armed in other BDT)
+      fDataToggle = !fDataToggle;
+
+      if (fState != EPDataOut) {
+         console.WRITE("Unexpected OUT, ep=").WRITE(ENDPOINT_NUM).WRITE(", s=").WRITELN(Endpoint::getStateName());
+         fState = EPIdle;
+         return;
+      }
+      fCompletedBuffer = (bdt == &endPointBdts[ENDPOINT_NUM].rxOdd)?fOddDataBuffer:fDataBuffer;
+      fDataTransferred = bdt->bc;
+
+      fState = fCallback(EPDataOut);
+
+      if (fState == EPDataOut) {
+         // Re-arm this BDT - it follows the transaction already armed in the other BDT
+         armRxBdt(bdt, fDataToggle == DataToggle_0);
+      }
+   }
+
+   /**
+    * Gets pointer to data from last completed transaction
+    *
+    * @return Pointer to buffer
+    */
+   volatile uint8_t *getBuffer() {
+      return fCompletedBuffer;
+   }
+};
+
+template<class Info, unsigned ENDPOINT_NUM, unsigned EP_MAXSIZE>
+uint8_t PingPongOutEndpoint<Info, ENDPOINT_NUM, EP_MAXSIZE>::fOddDataBuffer[EP_MAXSIZE];
+
 /**
  * End USB_Group
  * @}
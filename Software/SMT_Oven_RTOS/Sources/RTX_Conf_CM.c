@@ -35,6 +35,8 @@
  *---------------------------------------------------------------------------*/
 
 #include "cmsis_os.h"
+#include "derivative.h"
+#include "lowPower.h"
 #include "RTX_Conf_CM.cfg"
 
 #define OS_TRV          ((uint32_t)(((double)OS_CLOCK*(double)OS_TICK)/1E6)-1)
@@ -46,12 +48,56 @@
 
 /*--------------------------- os_idle_demon ---------------------------------*/
 
+/// Processor cycles spent sleeping in the idle demon (SysTick counts - used for CPU idle statistics)
+volatile uint32_t os_idle_cycles = 0U;
+
+#if (OS_TICK != 1000)
+#error "lowPowerSleep() assumes a 1 ms RTX tick"
+#endif
+
+/// Post service queue holding requests from ISRs (struct OS_PSQ - byte 2 is the count)
+extern uint32_t os_fifo[];
+#define OS_PSQ_COUNT (((volatile uint8_t *)os_fifo)[2])
+
 /// \brief The idle demon is running when no other thread is ready to run
 void os_idle_demon (void) {
 
   for (;;) {
-    /* HERE: include optional user code to be executed when no thread runs.*/
-     __asm__("wfi");
+    uint32_t start, end, ticks;
+
+    // Suspend the tick and sleep until the next delay or timer is due (see lowPower.h)
+    // An ISR may have posted to a thread after the tick was suspended - this is still
+    // in the queue as the scheduler doesn't run until resumed
+    ticks = os_suspend();
+    __disable_irq();
+    if ((ticks > 1U) && (OS_PSQ_COUNT == 0U)) {
+      // Wake a tick early so the SysTick finishes the partial tick
+      ticks = lowPowerSleep(ticks - 1U);
+    }
+    else {
+      ticks = 0U;
+    }
+    os_idle_cycles += ticks * (SysTick->LOAD + 1U);
+    __enable_irq();
+    os_resume(ticks);
+    if (ticks != 0U) {
+      continue;
+    }
+
+    // Sleep until the next tick or interrupt
+    // Interrupts are masked so the sleep is timed before the waking interrupt is serviced
+    // (WFI still wakes on a pending interrupt)
+    __disable_irq();
+    start = SysTick->VAL;
+    __asm__("wfi");
+    end   = SysTick->VAL;
+
+    // SysTick counts down and can only reload once as its interrupt ends the sleep
+    if (end > start) {
+      start += SysTick->LOAD + 1U;
+    }
+    os_idle_cycles += start - end;
+    __enable_irq();
   }
 }
 
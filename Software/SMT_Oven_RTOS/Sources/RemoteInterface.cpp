@@ -4,7 +4,7 @@
  *
  *  This file contains the handler for the remote USB CDC command handler.\n
  *  It runs as a separate thread communicating with the USB interrupt handler
- *  through MailQueue queues.
+ *  through a MailQueue (commands) and a transmit ring buffer (replies).
  *
  *  Created on: 26Feb.,2017
  *      Author: podonoghue
@@ -23,6 +23,16 @@
  *  -> "THERM?"
  *  <- "T1Enable,T1Offset,T2Enable,T2Offset,T3Enable,T3Offset,T4Enable,T5Offset;"
  *
+ * Set thermocouple calibration (see Calibrate probes on the front panel)
+ *  -> "CAL T1Gain,T1Offset,T2Gain,T2Offset,T3Gain,T3Offset,T4Gain,T4Offset"
+ *  <- "OK"
+ *  Temperature = Gain * ITS-90 corrected reading + Offset (+ manual offset from THERM).
+ *  Gain must be 0.8 to 1.2 and Offset -50 to 50. All values are checked before any are changed.
+ *
+ * Get thermocouple calibration
+ *  -> "CAL?"
+ *  <- "T1Gain,T1Offset,T2Gain,T2Offset,T3Gain,T3Offset,T4Gain,T4Offset;"
+ *
  * Set PID parameters
  *  -> "PID Proportional,Integral,Differential"
  *  <- "OK"
@@ -31,6 +41,18 @@
  *  -> "PID?"
  *  <- "Proportional,Integral,Differential;"
  *
+ * Set PID parameters for a phase of the profile
+ *  -> "GAINS state,Proportional,Integral,Differential"
+ *  <- "OK"
+ *  state is one of preheat, soak, ramp_up, dwell or ramp_down.
+ *  A Proportional value of 0 makes the phase use the PID parameters above.
+ *
+ * Get PID parameters for all phases of the profile
+ *  -> "GAINS?"
+ *  <- "5;preheat,Proportional,Integral,Differential;soak,...;...;ramp_down,...;"
+ *  Format: number_of_phases;[state,Proportional,Integral,Differential;]*number_of_phases
+ *  The values are those used in the phase i.e. the PID parameters for a phase without its own.
+ *
  * Set profile parameters
  *  -> "PROF profile-number,description,flags,liquidus,preheatTime,soakTemp1,soakTemp2,soakTime,rampUpSlope,peakTemp,peakDwell,rampDownSlope;
  *  <- "OK"
@@ -38,6 +60,26 @@
  * Get current profile parameters
  *  -> "PROF?"
  *  -> "profile-number,description,flags,liquidus,preheatTime,soakTemp1,soakTemp2,soakTime,rampUpSlope,peakTemp,peakDwell,rampDownSlope;
+ *  The record has the same format as for PROF (flags in hex).
+ *
+ * Get all profiles as a single checksummed block
+ *  -> "PROFS?"
+ *  <- "10;0,description,flags,...,rampDownSlope;1,description,...;...//...;9,description,...;checksum"
+ *  Format: number_of_profiles;[profile-record;]*number_of_profiles checksum
+ *  The profile-record has the same format as for PROF (flags in hex).
+ *  The checksum is the CRC-32 (hex) of all characters of the profile records including the ';' terminators.
+ *
+ * Set several profiles in one transaction
+ *  -> "PROFS number_of_profiles"
+ *  <- "OK"
+ *  -> "profile-record;"  (number_of_profiles times)
+ *  <- "OK" or "Failed - Data error" (for each record)
+ *  -> "PROFS END,checksum"
+ *  <- "OK"
+ *  The profiles are only written to non-volatile memory if all records are valid, the count and checksum
+ *  agree and no locked profile would be changed. Any other command aborts the transaction.
+ *  Each record is acknowledged so the host must wait for the reply before sending the next record
+ *  (the oven has a small command queue and discards commands that arrive while it is full).
  *
  *  Get plot value
  *  <- "PLOT?"
@@ -56,67 +98,275 @@
  *  <- "RUN?"
  *  -> "OK|Failed|Running"
  *
+ * Get result of last PID auto-tune (front panel Auto-tune PID)
+ *  <- "TUNE?"
+ *  -> "Kp,Ki,Kd,Ku,Pu,amplitude,K,tau,L;"
+ *  PID gains, ultimate gain and period, oscillation amplitude and the identified oven model
+ *  (static gain, time constant and dead time). "Failed - No result" if no tuning has completed.
+ *
+ * Get recipes (built-in bake-out, cure etc. followed by the uploaded recipe if any)
+ *  <- "RECIPES?"
+ *  -> "3;0,PCB BAKE-OUT 125C 4H,7;1,LOW-TEMP BAKE 90C 8H,7;2,SMT ADHESIVE CURE 150C,9;"
+ *  Format: number_of_recipes;[recipe-number,name,number_of_steps;]*number_of_recipes
+ *
+ * Get steps of a recipe
+ *  <- "RECIPE? recipe-number"
+ *  -> "PCB BAKE-OUT 125C 4H;7;fan,preheat,0,30.0;ramp,preheat,125,1.0;...//...;wait,ramp_down,50,0.0;"
+ *  Format: name;number_of_steps;[type,state,temperature,value;]*number_of_steps
+ *  type is ramp, hold, wait or fan and state is the state reported while the step runs
+ *  (preheat, soak, ramp_up, dwell or ramp_down). value is the slope, time, timeout or fan speed (see StepType).
+ *
+ * Start running recipe
+ *  <- "RECIPE recipe-number"
+ *  -> "OK"
+ *  Progress is checked with RUN? and stopped with ABORT as for a profile.
+ *
+ * Upload a recipe
+ *  -> "PROG name"
+ *  <- "OK"
+ *  -> "PROG STEP type,state,temperature,value"  (for each step, in order)
+ *  <- "OK"
+ *  -> "PROG END"
+ *  <- "OK"
+ *  The steps have the same format as for RECIPE?. The program is checked when complete and becomes
+ *  the last recipe (numbered after the built-in recipes) replacing any earlier upload.
+ *  It is held in RAM so must be uploaded again after a reset.
+ *
+ * Get index of profile library (profiles stored in program flash in addition to the 10 above)
+ *  <- "LIB?"
+ *  -> "2;7,3A1F,5C0E2D11,Sn63Pb37 Kester;42,91C4,0B7E4410,SAC305 Large board;"
+ *  Format: number_of_profiles;[id,name_hash,checksum,description;]*number_of_profiles
+ *  name_hash (16-bit) and checksum (CRC-32 of the stored record) are in hex and change whenever the profile
+ *  is changed so a host can tell which profiles need to be uploaded.
+ *
+ * Get profile from library
+ *  <- "LIB? id"
+ *  -> "id,description,flags,liquidus,preheatTime,soakTemp1,soakTemp2,soakTime,rampUpSlope,peakTemp,peakDwell,rampDownSlope;
+ *  The record has the same format as for PROF (flags in hex).
+ *
+ * Add or replace profile in library
+ *  -> "LIB id,description,flags,liquidus,preheatTime,soakTemp1,soakTemp2,soakTime,rampUpSlope,peakTemp,peakDwell,rampDownSlope;
+ *  <- "OK"
+ *  id is 1 to 100. Fails with "Failed - Data error" if the profile is invalid or the library is full.
+ *
+ * Delete profile from library
+ *  <- "LIB DEL id"
+ *  -> "OK"
+ *
+ *  LIB and LIB DEL fail with "Failed - Busy" while a remotely started profile is running as programming
+ *  the flash stalls the processor.
+ *
+ * Start running profile from library
+ *  <- "LIB RUN id"
+ *  -> "OK"
+ *  The profile is copied to RAM when started. Progress is checked with RUN? and stopped with ABORT.
+ *
+ * Get synthetic bulk data for USB throughput measurement
+ *  <- "BENCH? size"
+ *  -> "0000000,preheat,0,27.8,27.5,0,100,0.0,0.0,27.5,0.0;0000064,preheat,...;...
+ *  Returns approximately size bytes (maximum 1000000) of 64-byte records similar to log entries.
+ *  Each record starts with its byte offset. Used by Software/OvenControl/cdcBenchmark.
+ *
+ * Get run-time statistics
+ *  <- "STATS?"
+ *  -> "commandQueueUsed,gauge,0,2;...;pidPeriod_us,histogram,120,249980,250001,250020,0/0/0/120/0/0/0/0;...;"
+ *  Format: [name,counter,count;|name,gauge,current,high-water;|name,rate,count,per-second;|
+ *           name,histogram,count,minimum,mean,maximum,bucket0/bucket1/.../bucket7;]*
+ *  Histogram bucket n counts values less than (base<<n) and the last bucket counts all larger values.
+ *  cpuIdle_pct has one sample a second of the time spent asleep in the idle thread (mean is the average idle time).
+ *
+ * Clear run-time statistics (gauges retain their current value)
+ *  <- "STATS CLEAR"
+ *  -> "OK"
+ *
+ * Get thermocouple health
+ *  <- "HEALTH?"
+ *  -> "4;1,0,4800,2,2,0,0,1,0;2,1,4800,4800,4,1196,1200,1200,0;...;"
+ *  Format: number_of_thermocouples;[thermocouple,status,readings,faults,held,excluded,consecutive,maximum_consecutive,rejected;]*
+ *  status is that of the last reading (0=OK, 1=open, 2=short to Vcc, 3=short to Gnd, 4=missing, 7=disabled).
+ *  readings and faults count individual readings. held counts measurements where the last good temperature
+ *  was used over a fault (see Fault hold setting) and excluded those where the thermocouple was treated
+ *  as failed. consecutive is the current run of faulty measurements. rejected is 1 if the thermocouple
+ *  is currently excluded as implausible (rate of change or disagreement with the others).
+ *  Counters only advance while the thermocouple is enabled.
+ *
+ * Clear thermocouple health counters
+ *  <- "HEALTH CLEAR"
+ *  -> "OK"
+ *
+ * Get event trace (only available if built with TRACE_ENABLED=1)
+ *  <- "TRACE?"
+ *  -> "120000000,3,2;1FFF1234,UI;1FFF2345,Remote;...;3A2F01,B,1FFF1234,lcd;3A9C44,E,1FFF1234,lcd;..."
+ *  Format: frequency,number_of_threads,number_of_events;[context,thread name;]*number_of_threads
+ *          [timestamp,phase,context,event name;]*number_of_events
+ *  Context and timestamp are in hex. A context less than 256 is an exception (ISR) number.
+ *  Timestamps are counter ticks at frequency Hz and wrap at 32 bits.
+ *  Recording is suspended while the trace is sent.
+ *  Use Software/OvenControl/traceToChrome to convert to Chrome trace JSON.
+ *
+ * Clear event trace
+ *  <- "TRACE CLEAR"
+ *  -> "OK"
+ *
  * Unknown command
  *  <- "?????"
  *  -> "Failed - unrecognized command"
+ *
+ * Ownership
+ *  Queries (IDN?, THERM?, CAL?, PID?, GAINS?, PROF?, PROFS?, PLOT?, RUN?, TUNE?, RECIPES?, RECIPE?, LIB?, HEALTH?, STATS?, BENCH?) never lock anything and are
+ *  never refused. Settings are copied as consistent snapshots using configLock and the run state is
+ *  read without locking.
+ *
+ *  Commands that change the oven (THERM, CAL, PID, GAINS, PROF, PROFS, RUN, RECIPE, PROG, LIB, ABORT) need the session lease.
+ *  The lease is interactiveMutex held by the remote thread so the front panel is locked out while
+ *  the host is in control. It is obtained by the first such command and renewed by each later one.
+ *  If the front panel is in use these commands fail with "Failed - Busy".
+ *  The lease is released:
+ *   - by ABORT,
+ *   - by RUN? when it reports a remotely started profile has finished,
+ *   - after SESSION_LEASE_MS without a changing command while no remotely started profile is running.
  */
 
+#include <ctype.h>
+#include <math.h>
+#include "autoTune.h"
+#include "calibration.h"
+#include "configCache.h"
 #include "configure.h"
 #include "cmsis.h"
+#include "crc32.h"
+#include "gainSchedule.h"
+#include "profileLibrary.h"
+#include "profileProgram.h"
 #include "RemoteInterface.h"
 #include "stringFormatter.h"
+#include "trace.h"
+#include "uiEvents.h"
 
 /** Current command */
 RemoteInterface::Command   *RemoteInterface::command;
 
-/** Current response */
-RemoteInterface::Response  *RemoteInterface::response;
-
 /** The remote handler thread */
 CMSIS::Thread RemoteInterface::handlerThread(RemoteInterface::commandThread);
 
 /** Mail queue USB -> handler thread */
 CMSIS::MailQueue<RemoteInterface::Command,  4> RemoteInterface::commandQueue;
 
-/** Mail queue USB <- handler thread */
-CMSIS::MailQueue<RemoteInterface::Response, 4> RemoteInterface::responseQueue;
+/** Transmit ring USB <- handler thread */
+uint8_t RemoteInterface::txBuffer[TX_BUFFER_SIZE];
+
+/** Index of next byte to be sent by USB */
+volatile unsigned RemoteInterface::txTail = 0;
+
+/** Index after last byte committed for sending */
+volatile unsigned RemoteInterface::txHead = 0;
+
+/** Serialises writers to the transmit ring */
+CMSIS::Mutex RemoteInterface::txMutex;
+
+/** Remote host holds interactiveMutex as a session lease */
+bool RemoteInterface::sessionLeaseHeld = false;
+
+/** Time the session lease was last used (kernel ticks) */
+uint32_t RemoteInterface::sessionLastUsed = 0;
+
+/** A profile started remotely has not yet been seen to finish */
+bool RemoteInterface::sessionRunActive = false;
 
 /** ID string for Oven */
 const char *RemoteInterface::IDN = "SMT-Oven 1.0.0.0\n\r";
 
+static_assert((RemoteInterface::TX_BUFFER_SIZE&(RemoteInterface::TX_BUFFER_SIZE-1)) == 0, "TX_BUFFER_SIZE must be a power of 2");
+
 /**
- * Set response over CDC
- *
- * @param response Response text to send
+ * Create reply
  *
- * @return true Success
+ * @param[in] blocking  true  => Wait for the ring lock and for space in the ring as needed.\n
+ *                               The rest of the reply is discarded if no space is freed within TX_TIMEOUT_MS.\n
+ *                      false => Discard the entire reply if the ring is locked or full.
+ */
+RemoteInterface::Reply::Reply(bool blocking) : blocking(blocking), discarded(false), writeIndex(0) {
+   discarded  = (txMutex.wait(blocking?osWaitForever:0) != osOK);
+   writeIndex = txHead;
+}
+
+/**
+ * Destructor - commits reply for sending and releases ring
+ */
+RemoteInterface::Reply::~Reply() {
+   if (discarded) {
+      return;
+   }
+   commit();
+   txMutex.release();
+}
+
+/**
+ * Make data written so far available to USB
  */
-bool RemoteInterface::send(Response *response) {
-   responseQueue.put(response);
-//   PUTS("send()");
+void RemoteInterface::Reply::commit() {
+   txHead = writeIndex;
+   Statistics::txBufferUsed.set((txHead-txTail)%TX_BUFFER_SIZE);
    notifyUsbIn();
-   return true;
 }
 
 /**
- * Writes thermocouple status to remote
- *
- * @param time       Time of log entry to send
- * @param lastEntry  Indicates this is the last entry so append "\n\r"
+ * Commit data written so far for sending (blocking reply only)
  */
-void RemoteInterface::logThermocoupleStatus(int time, bool lastEntry) {
+void RemoteInterface::Reply::flushOutput() {
+   if (blocking && !discarded) {
+      commit();
+   }
+}
 
-   // Allocate buffer for response
-   Response *response = allocResponseBuffer();
-   if (response == nullptr) {
-      // Failed allocation - discard
+/**
+ * Writes a character into the transmit ring
+ *
+ * @param[in]  ch - character to send
+ */
+void RemoteInterface::Reply::_writeChar(char ch) {
+   if (discarded) {
       return;
    }
+   unsigned nextIndex = (writeIndex+1)%TX_BUFFER_SIZE;
+   if (nextIndex == txTail) {
+      // Ring full
+      Statistics::txBufferFull.increment();
+      if (!blocking) {
+         // Discard entire reply
+         discarded = true;
+         txMutex.release();
+         return;
+      }
+      // Send what we have so far and wait for USB to make space
+      commit();
+      for (unsigned waited=0; nextIndex == txTail; waited++) {
+         if (waited >= TX_TIMEOUT_MS) {
+            // Host isn't reading - discard rest of reply so other writers may use the ring
+            Statistics::txReplyTimeout.increment();
+            discarded = true;
+            txMutex.release();
+            return;
+         }
+         osDelay(1);
+      }
+   }
+   txBuffer[writeIndex] = ch;
+   writeIndex = nextIndex;
+}
+
+/**
+ * Writes a thermocouple status log entry e.g.\n
+ * preheat,0,27.8,27.5,0,100,0.0,0.0,27.5,0.0;
+ *
+ * @param sf    Formatter to write to
+ * @param time  Time of log entry to write
+ */
+void RemoteInterface::writeThermocoupleStatus(USBDM::FormattedIO &sf, int time) {
+
    // Data point to log
    const DataPoint &point = Draw::getDataPoint(time);
 
-   // Format response
-   USBDM::StringFormatter sf(reinterpret_cast<char*>(response->data), sizeof(response->data));
    sf.setFloatFormat(1);
    sf.write(Reporter::getStateName(point.getState())).write(',')
      .write(time).write(',')
@@ -134,12 +384,133 @@ void RemoteInterface::logThermocoupleStatus(int time, bool lastEntry) {
       }
    }
    sf.write(';');
+}
+
+/**
+ * Writes thermocouple status to remote\n
+ * The entry is discarded rather than waiting if the transmit ring is busy or full
+ *
+ * @param time       Time of log entry to send
+ * @param lastEntry  Indicates this is the last entry so append "\n\r"
+ */
+void RemoteInterface::logThermocoupleStatus(int time, bool lastEntry) {
+
+   Reply reply(false);
+
+   writeThermocoupleStatus(reply, time);
    if (lastEntry) {
       // Terminate the whole transfer sequence
-      sf.write("\n\r");
+      reply.write("\n\r");
+   }
+   if (reply.isDiscarded()) {
+      Statistics::droppedLogPoints.increment();
+   }
+}
+
+/**
+ * Writes a profile record to a formatter e.g.\n
+ * 4,My Profile,FF,183,140,183,90,1.4,210,15,-3.0;
+ *
+ * @param sf      Formatter to write to
+ * @param index   Index of profile
+ * @param profile Profile to write
+ */
+static void writeProfileRecord(USBDM::FormattedIO &sf, unsigned index, const SolderProfile &profile) {
+   sf.write(index).write(',');                                  /* index         */
+   sf.write((const char *) profile.description).write(',');     /* description   */
+   sf.write((unsigned)     profile.flags, USBDM::Radix_16).write(','); /* flags  */
+   sf.write((int)          profile.liquidus).write(',');        /* liquidus      */
+   sf.write((int)          profile.preheatTime).write(',');     /* preheatTime   */
+   sf.write((int)          profile.soakTemp1).write(',');       /* soakTemp1     */
+   sf.write((int)          profile.soakTemp2).write(',');       /* soakTemp2     */
+   sf.write((int)          profile.soakTime).write(',');        /* soakTime      */
+   sf.write((float)        profile.rampUpSlope).write(',');     /* ramp2Slope    */
+   sf.write((int)          profile.peakTemp).write(',');        /* peakTemp      */
+   sf.write((int)          profile.peakDwell).write(',');       /* peakDwell     */
+   sf.write((float)        profile.rampDownSlope).write(';');   /* rampDownSlope */
+}
+
+/**
+ * Take a consistent copy of a profile\n
+ * This does not lock out writers (see configLock)
+ *
+ * @param[in]  index   Index of profile
+ * @param[out] profile Copy of profile
+ */
+static void readProfile(unsigned index, SolderProfile &profile) {
+   uint32_t sequence;
+   do {
+      sequence = configLock.beginRead();
+      profile  = profiles[index];
+   } while (configLock.retryRead(sequence));
+}
+
+/**
+ *  Parse the profile fields following the profile number into a profile
+ *
+ *  @param[in]  tok     Description token (already obtained from strtok())
+ *  @param[out] profile Profile to update
+ *
+ *  @return true  Successfully parsed
+ *  @return false Failed parse
+ *
+ *  @note Uses strtok() to obtain the remaining fields
+ */
+static bool parseProfileFields(char *tok, SolderProfile &profile) {
+   memset(profile.description, 0, sizeof(profile.description));
+   strncpy(profile.description, tok, sizeof(profile.description)-1);
+   tok = strtok(nullptr, ",");
+   if (tok == nullptr) {
+      return false;
+   }
+   profile.flags = strtol(tok, nullptr, 16);
+   tok = strtok(nullptr, ",");
+   if (tok == nullptr) {
+      return false;
+   }
+   profile.liquidus = strtol(tok, nullptr, 10);
+   tok = strtok(nullptr, ",");
+   if (tok == nullptr) {
+      return false;
+   }
+   profile.preheatTime = strtol(tok, nullptr, 10);
+   tok = strtok(nullptr, ",");
+   if (tok == nullptr) {
+      return false;
+   }
+   profile.soakTemp1 = strtol(tok, nullptr, 10);
+   tok = strtok(nullptr, ",");
+   if (tok == nullptr) {
+      return false;
+   }
+   profile.soakTemp2 = strtol(tok, nullptr, 10);
+   tok = strtok(nullptr, ",");
+   if (tok == nullptr) {
+      return false;
    }
-   response->size = sf.length();
-   send(response);
+   profile.soakTime = strtol(tok, nullptr, 10);
+   tok = strtok(nullptr, ",");
+   if (tok == nullptr) {
+      return false;
+   }
+   profile.rampUpSlope = strtof(tok, nullptr);
+   tok = strtok(nullptr, ",");
+   if (tok == nullptr) {
+      return false;
+   }
+   profile.peakTemp = strtol(tok, nullptr, 10);
+   tok = strtok(nullptr, ",");
+   if (tok == nullptr) {
+      return false;
+   }
+   profile.peakDwell = strtol(tok, nullptr, 10);
+   tok = strtok(nullptr, ";\n\r");
+   if (tok == nullptr) {
+      return false;
+   }
+   profile.rampDownSlope = strtof(tok, nullptr);
+
+   return isfinite(profile.rampUpSlope) && isfinite(profile.rampDownSlope);
 }
 
 /**
@@ -157,16 +528,19 @@ bool parseProfile(char *cmd) {
    SolderProfile profile;
 
    char *tok = strtok(cmd, ",");
+   if (tok == nullptr) {
+      return false;
+   }
+   profileNum = strtoul(tok, &cmd, 10);
 
-   profileNum = strtol(tok, &cmd, 10);
-
-   if (profileNum>=MAX_PROFILES) {
+   if ((cmd == tok) || (profileNum>=MAX_PROFILES)) {
       return false;
    }
 
    tok = strtok(nullptr, ",");
    if (tok == nullptr) {
       // Assume setting current profile without changes
+      SeqLock::WriteScope ws(configLock);
       currentProfileIndex = profileNum;
       return true;
    }
@@ -176,61 +550,295 @@ bool parseProfile(char *cmd) {
       return false;
    }
 
-   strncpy(profile.description, tok, sizeof(profile.description)-1);
-   tok = strtok(nullptr, ",");
-   if (tok == nullptr) {
+   if (!parseProfileFields(tok, profile) || !profile.isValid()) {
       return false;
    }
-   profile.flags = strtol(tok, nullptr, 16);
-   tok = strtok(nullptr, ",");
+   SeqLock::WriteScope ws(configLock);
+   USBDM::FlexRamTransaction::Scope transaction;
+   currentProfileIndex = profileNum;
+   profiles[profileNum] = profile;
+
+   return true;
+}
+
+/**
+ *  Parse profile information into the profile library
+ *
+ *  @param cmd    Profile described by a string e.g.\n
+ *  42,My Profile,FF,183,140,183,90,1.4,210,15,-3.0;
+ *  id,description,flags,liquidus,preheatTime,soakTemp1,soakTemp2,soakTime,rampUpSlope,peakTemp,peakDwell,rampDownSlope
+ *
+ *  @return true  Successfully parsed and stored
+ *  @return false Failed parse, library full or flash failure
+ */
+static bool parseLibraryProfile(char *cmd) {
+   unsigned id;
+   SolderProfile profile;
+
+   char *tok = strtok(cmd, ",");
    if (tok == nullptr) {
       return false;
    }
-   profile.liquidus = strtol(tok, nullptr, 10);
-   tok = strtok(nullptr, ",");
-   if (tok == nullptr) {
+   id = strtoul(tok, &cmd, 10);
+
+   if ((cmd == tok) || (*cmd != '\0') || (id == 0) || (id > ProfileLibrary::MAX_ID)) {
       return false;
    }
-   profile.preheatTime = strtol(tok, nullptr, 10);
    tok = strtok(nullptr, ",");
    if (tok == nullptr) {
       return false;
    }
-   profile.soakTemp1 = strtol(tok, nullptr, 10);
-   tok = strtok(nullptr, ",");
-   if (tok == nullptr) {
+   if (!parseProfileFields(tok, profile) || !profile.isValid()) {
       return false;
    }
-   profile.soakTemp2 = strtol(tok, nullptr, 10);
-   tok = strtok(nullptr, ",");
-   if (tok == nullptr) {
+   return ProfileLibrary::store(id, profile);
+}
+
+/**
+ *  Parse profile id of a library command
+ *
+ *  @param[in]  number Id followed by newline
+ *  @param[out] id     Id parsed
+ *
+ *  @return true  Successfully parsed
+ *  @return false Failed parse or illegal id
+ */
+static bool parseLibraryId(const char *number, unsigned &id) {
+   char *end;
+   unsigned long value = strtoul(number, &end, 10);
+   if ((end == number) || (*end != '\n') || (value == 0) || (value > ProfileLibrary::MAX_ID)) {
       return false;
    }
-   profile.soakTime = strtol(tok, nullptr, 10);
-   tok = strtok(nullptr, ",");
+   id = value;
+   return true;
+}
+
+/** Names of program step types as used by RECIPE? and PROG STEP (in StepType order) */
+static const char *const stepTypeNames[] = {
+      "ramp", "hold", "wait", "fan",
+};
+
+/**
+ * Write a program step e.g. "ramp,preheat,125,1.0;"
+ *
+ * @param sf    Formatter to write to
+ * @param step  Step to write
+ */
+static void writeProgramStep(USBDM::FormattedIO &sf, const ProfileStep &step) {
+   sf.write(stepTypeNames[step.type]).write(',');
+   sf.write(Reporter::getStateName((State)step.state)).write(',');
+   sf.write((int)step.temperature).write(',');
+   sf.write(step.value).write(';');
+}
+
+/**
+ *  Parse a program step
+ *
+ *  @param[in]  cmd  Step described by a string e.g. "ramp,preheat,125,1.0"
+ *  @param[out] step Step to update
+ *
+ *  @return true  Successfully parsed
+ *  @return false Failed parse
+ */
+static bool parseProgramStep(char *cmd, ProfileStep &step) {
+   char *tok = strtok(cmd, ",");
    if (tok == nullptr) {
       return false;
    }
-   profile.rampUpSlope = strtof(tok, nullptr);
+   unsigned type = 0;
+   while ((type < (sizeof(stepTypeNames)/sizeof(stepTypeNames[0]))) && (strcasecmp(tok, stepTypeNames[type]) != 0)) {
+      type++;
+   }
+   if (type >= (sizeof(stepTypeNames)/sizeof(stepTypeNames[0]))) {
+      return false;
+   }
+   step.type = (StepType)type;
    tok = strtok(nullptr, ",");
    if (tok == nullptr) {
       return false;
    }
-   profile.peakTemp = strtol(tok, nullptr, 10);
+   unsigned state = s_preheat;
+   while ((state <= s_ramp_down) && (strcasecmp(tok, Reporter::getStateName((State)state)) != 0)) {
+      state++;
+   }
+   if (state > s_ramp_down) {
+      return false;
+   }
+   step.state = state;
    tok = strtok(nullptr, ",");
    if (tok == nullptr) {
       return false;
    }
-   profile.peakDwell = strtol(tok, nullptr, 10);
+   char *end;
+   long temperature = strtol(tok, &end, 10);
+   if ((end == tok) || (temperature < 0) || (temperature > ProfileProgram::MAX_TEMPERATURE)) {
+      return false;
+   }
+   step.temperature = (int16_t)temperature;
    tok = strtok(nullptr, ";\n\r");
    if (tok == nullptr) {
       return false;
    }
-   profile.rampDownSlope = strtof(tok, nullptr);
+   step.value = strtof(tok, &end);
+   return (end != tok) && isfinite(step.value);
+}
 
-   currentProfileIndex = profileNum;
-   profiles[profileNum] = profile;
+/**
+ * State of a recipe upload (PROG)
+ */
+static struct {
+   /** Indicates an upload is in progress */
+   bool           active;
+   /** Indicates a step failed to parse or didn't fit */
+   bool           error;
+   /** Program being assembled */
+   ProfileProgram program;
+} programUpload;
+
+/**
+ * State of a bulk profile upload (PROFS)
+ */
+static struct {
+   /** Indicates a transaction is in progress (session lease is held) */
+   bool          active;
+   /** Number of profile records expected */
+   unsigned      expected;
+   /** Number of profile records received */
+   unsigned      received;
+   /** Bit-mask of profile numbers received */
+   uint32_t      present;
+   /** Indicates a record failed to parse */
+   bool          error;
+   /** CRC-32 of records received */
+   uint32_t      checksum;
+   /** Staging area for received profiles */
+   SolderProfile staged[MAX_PROFILES];
+} bulkProfiles;
+
+static_assert(MAX_PROFILES<=32, "bulkProfiles.present too small");
+
+/**
+ * Start a bulk profile upload
+ *
+ * @param cmd Number of profile records to follow e.g. "10"
+ *
+ * @return true  Transaction started
+ * @return false Illegal count
+ */
+static bool bulkProfilesBegin(const char *cmd) {
+   char *end;
+   unsigned long count = strtoul(cmd, &end, 10);
+   if ((end == cmd) || (count == 0) || (count > MAX_PROFILES)) {
+      return false;
+   }
+   bulkProfiles.active   = true;
+   bulkProfiles.expected = count;
+   bulkProfiles.received = 0;
+   bulkProfiles.present  = 0;
+   bulkProfiles.error    = false;
+   bulkProfiles.checksum = 0;
+   return true;
+}
+
+/**
+ * Add a profile record to the bulk profile upload
+ *
+ * @param cmd Profile record e.g. "4,My Profile,FF,183,140,183,90,1.4,210,15,-3.0;\n"
+ *
+ * @return true  Record accepted
+ * @return false Record invalid - the transaction will fail
+ */
+static bool bulkProfilesAdd(char *cmd) {
+   // Checksum covers the record excluding line terminators
+   bulkProfiles.checksum = crc32(cmd, strcspn(cmd, "\n\r"), bulkProfiles.checksum);
+   bulkProfiles.received++;
 
+   char *tok = strtok(cmd, ",");
+   char *end;
+   unsigned long profileNum = strtoul(tok, &end, 10);
+   if ((end == tok) || (profileNum >= MAX_PROFILES) || (bulkProfiles.present & (1<<profileNum))) {
+      bulkProfiles.error = true;
+      return false;
+   }
+   tok = strtok(nullptr, ",");
+   if ((tok == nullptr) ||
+       !parseProfileFields(tok, bulkProfiles.staged[profileNum]) ||
+       !bulkProfiles.staged[profileNum].isValid()) {
+      bulkProfiles.error = true;
+      return false;
+   }
+   bulkProfiles.present |= (1<<profileNum);
+   return true;
+}
+
+/**
+ * Check if a staged profile differs from the profile in non-volatile memory
+ *
+ * @param staged    Staged profile
+ * @param nvProfile Profile in non-volatile memory
+ *
+ * @return true if different
+ */
+static bool isProfileChanged(const SolderProfile &staged, const NvSolderProfile &nvProfile) {
+   SolderProfile current;
+   current = nvProfile;
+   return
+         (strncmp(staged.description, current.description, sizeof(current.description)) != 0) ||
+         (staged.flags         != current.flags)         ||
+         (staged.liquidus      != current.liquidus)      ||
+         (staged.preheatTime   != current.preheatTime)   ||
+         (staged.soakTemp1     != current.soakTemp1)     ||
+         (staged.soakTemp2     != current.soakTemp2)     ||
+         (staged.soakTime      != current.soakTime)      ||
+         (staged.rampUpSlope   != current.rampUpSlope)   ||
+         (staged.peakTemp      != current.peakTemp)      ||
+         (staged.peakDwell     != current.peakDwell)     ||
+         (staged.rampDownSlope != current.rampDownSlope);
+}
+
+/**
+ * Complete a bulk profile upload\n
+ * The profiles are written to non-volatile memory only if the whole transfer is valid.
+ * Unchanged profiles are not re-written.
+ *
+ * @param cmd Checksum of records e.g. "1A2F"
+ *
+ * @return true  Profiles committed
+ * @return false Transfer failed - no profiles changed
+ */
+static bool bulkProfilesCommit(const char *cmd) {
+   bulkProfiles.active = false;
+
+   char *end;
+   unsigned long checksum = strtoul(cmd, &end, 16);
+   if ((end == cmd) || bulkProfiles.error ||
+       (checksum != bulkProfiles.checksum) ||
+       (bulkProfiles.received != bulkProfiles.expected)) {
+      return false;
+   }
+   // Check for changes to locked profiles before changing anything
+   uint32_t changed = 0;
+   for (unsigned index=0; index<MAX_PROFILES; index++) {
+      if ((bulkProfiles.present & (1<<index)) == 0) {
+         continue;
+      }
+      if (!isProfileChanged(bulkProfiles.staged[index], profiles[index])) {
+         continue;
+      }
+      if ((profiles[index].flags & P_UNLOCKED) == 0) {
+         // Profile is locked
+         return false;
+      }
+      changed |= (1<<index);
+   }
+   // Write changed profiles as a single batch
+   SeqLock::WriteScope ws(configLock);
+   USBDM::FlexRamTransaction::Scope transaction;
+   for (unsigned index=0; index<MAX_PROFILES; index++) {
+      if (changed & (1<<index)) {
+         profiles[index] = bulkProfiles.staged[index];
+      }
+   }
    return true;
 }
 
@@ -245,8 +853,8 @@ bool parseProfile(char *cmd) {
  */
 bool parseThermocouples(char *cmd) {
    char *tok;
-   bool enable;
-   int  offset;
+   bool enable[4];
+   int  offset[4];
 
    tok = strtok(cmd, ",");
 
@@ -254,18 +862,62 @@ bool parseThermocouples(char *cmd) {
       if (tok == nullptr) {
          return false;
       }
-      enable = (strtol(tok, nullptr, 10)!=0);
-      tok    = strtok(nullptr, ",;\n\r");
+      enable[t] = (strtol(tok, nullptr, 10)!=0);
+      tok       = strtok(nullptr, ",;\n\r");
       if (tok == nullptr) {
          return false;
       }
-      offset = strtol(tok, nullptr, 10);
-      tok    = strtok(nullptr, ",");
-      if ((offset<-10) || (offset>10)) {
+      long value = strtol(tok, nullptr, 10);
+      tok        = strtok(nullptr, ",");
+      if ((value<-10) || (value>10)) {
          return false;
       }
-      temperatureSensors.getThermocouple(t).enable(enable);
-      temperatureSensors.getThermocouple(t).setOffset(offset);
+      offset[t] = (int)value;
+   }
+   // Only change thermocouples once all values are known to be valid
+   SeqLock::WriteScope ws(configLock);
+   USBDM::FlexRamTransaction::Scope transaction;
+   for (int t=0; t<4; t++) {
+      temperatureSensors.getThermocouple(t).enable(enable[t]);
+      temperatureSensors.getThermocouple(t).setOffset(offset[t]);
+   }
+   return true;
+}
+
+/**
+ *  Parse calibration information into thermocouple calibrations
+ *
+ *  @param cmd Describes the calibration of each thermocouple e.g.\n
+ *  1.0123,-0.85,1,0,0.9987,0.42,1,0
+ *
+ *  @return true  Successfully parsed
+ *  @return false Failed parse
+ */
+bool parseCalibration(char *cmd) {
+   float gain[Calibration::NUM_CHANNELS];
+   float offset[Calibration::NUM_CHANNELS];
+
+   char *tok = cmd;
+   for (unsigned t=0; t<Calibration::NUM_CHANNELS; t++) {
+      tok = strtok(tok, ",");
+      if (tok == nullptr) {
+         return false;
+      }
+      gain[t] = strtof(tok, nullptr);
+      tok = strtok(nullptr, (t==Calibration::NUM_CHANNELS-1)?";\n\r":",");
+      if (tok == nullptr) {
+         return false;
+      }
+      offset[t] = strtof(tok, nullptr);
+      if (!(gain[t] >= Calibration::MIN_GAIN) || !(gain[t] <= Calibration::MAX_GAIN) ||
+          !(fabsf(offset[t]) <= Calibration::MAX_OFFSET)) {
+         return false;
+      }
+      tok = nullptr;
+   }
+   // Only change calibration once all values are known to be valid
+   for (unsigned t=0; t<Calibration::NUM_CHANNELS; t++) {
+      Calibration::set(t, gain[t], offset[t]);
    }
    return true;
 }
@@ -300,6 +952,11 @@ bool parsePidParameters(char *cmd) {
    }
    float kd = strtof(tok, nullptr);
 
+   if (!isfinite(kp) || !isfinite(ki) || !isfinite(kd)) {
+      return false;
+   }
+   SeqLock::WriteScope ws(configLock);
+   USBDM::FlexRamTransaction::Scope transaction;
    pidKp = kp;
    pidKi = ki;
    pidKd = kd;
@@ -307,25 +964,108 @@ bool parsePidParameters(char *cmd) {
 }
 
 /**
- * Try to lock the Interactive MUTEX so that the remote session has ownership
+ *  Parse phase and PID information into scheduled PID parameters
+ *
+ *  @param cmd Describes the phase and PID parameters e.g.\n
+ *  soak,.1,.024,23.4;
+ *
+ *  @return true  Successfully parsed
+ *  @return false Failed parse
+ */
+bool parseGainSchedule(char *cmd) {
+   char *tok;
+
+   tok = strtok(cmd, ",");
+   if (tok == nullptr) {
+      return false;
+   }
+   unsigned index;
+   for (index=0; index<GainSchedule::NUM_STATES; index++) {
+      if (strcasecmp(tok, Reporter::getStateName((State)(GainSchedule::FIRST_STATE+index))) == 0) {
+         break;
+      }
+   }
+   if (index >= GainSchedule::NUM_STATES) {
+      return false;
+   }
+   State state = (State)(GainSchedule::FIRST_STATE+index);
+
+   // Remaining parameters have the same format as PID
+   tok = strtok(nullptr, ",");
+   if (tok == nullptr) {
+      return false;
+   }
+   float kp = strtof(tok, nullptr);
+
+   tok = strtok(nullptr, ",");
+   if (tok == nullptr) {
+      return false;
+   }
+   float ki = strtof(tok, nullptr);
+
+   tok = strtok(nullptr, ";\n\r");
+   if (tok == nullptr) {
+      return false;
+   }
+   float kd = strtof(tok, nullptr);
+
+   return GainSchedule::setGains(state, kp, ki, kd);
+}
+
+/**
+ * Obtain or renew the session lease so that the remote host has ownership of the oven
  *
- * @param response Buffer to use for response if getting MUTEX fails.
+ * @param reply Reply to write failure message to
  *
  * @return true  => success
- * @return false => failed (A fail response has been sent to the remote and response has been consumed)
+ * @return false => failed (A fail response has been written to reply)
  */
-bool RemoteInterface::getInteractiveMutex(RemoteInterface::Response *response) {
-   // Lock interface
-   osStatus status = interactiveMutex.wait(0);
+bool RemoteInterface::acquireSession(USBDM::FormattedIO &reply) {
+   if (!sessionLeaseHeld) {
+      // Lock interface
+      if (interactiveMutex.wait(0) != osOK) {
+         reply.write("Failed - Busy\n\r");
+         return false;
+      }
+      sessionLeaseHeld = true;
+      UiEvents::post(UiEvents::UiEvent_Remote);
+   }
+   sessionLastUsed = osKernelSysTick();
+   return true;
+}
 
-   // Obtained lock
-   if (status == osOK) {
-      return true;
+/**
+ * Give up the session lease returning ownership to the front panel\n
+ * Any bulk profile upload in progress is abandoned
+ */
+void RemoteInterface::releaseSession() {
+   bulkProfiles.active = false;
+   sessionRunActive    = false;
+   if (sessionLeaseHeld) {
+      sessionLeaseHeld = false;
+      interactiveMutex.release();
+      UiEvents::post(UiEvents::UiEvent_Remote);
+   }
+}
+
+/**
+ * Release the session lease if it has been idle for SESSION_LEASE_MS\n
+ * The lease is kept while a profile started remotely is still running
+ */
+void RemoteInterface::checkSessionLease() {
+   if (!sessionLeaseHeld) {
+      return;
+   }
+   if (sessionRunActive) {
+      State state = RunProfile::remoteCheckRunProfile();
+      if ((state != s_complete) && (state != s_fail)) {
+         return;
+      }
+      sessionRunActive = false;
+   }
+   if ((uint32_t)(osKernelSysTick()-sessionLastUsed) >= osKernelSysTickMicroSec(SESSION_LEASE_MS*1000U)) {
+      releaseSession();
    }
-   strcpy(reinterpret_cast<char*>(response->data), "Failed - Busy\n\r");
-   response->size = strlen(reinterpret_cast<char*>(response->data));
-   RemoteInterface::send(response);
-   return false;
 }
 
 /**
@@ -339,15 +1079,28 @@ bool RemoteInterface::getInteractiveMutex(RemoteInterface::Response *response) {
 bool RemoteInterface::doCommand(Command *cmd) {
    using namespace USBDM;
 
-   // Allocate response buffer
-   Response *response = allocResponseBuffer();
-   if (response == nullptr) {
-      // Discard command if we can't respond
-      // This should be impossible
-      return false;
+   TRACE_SCOPE("command");
+
+   if (bulkProfiles.active) {
+      /*
+       * Bulk profile upload in progress - the interactive mutex is held
+       */
+      if (isdigit(cmd->data[0])) {
+         // Profile record - acknowledged so the host doesn't overrun the command queue
+         bool success = bulkProfilesAdd(reinterpret_cast<char*>(cmd->data));
+         sessionLastUsed = osKernelSysTick();
+         Reply sf;
+         sf.write(success?"OK\n\r":"Failed - Data error\n\r");
+         return success;
+      }
+      if (strncasecmp((const char *)(cmd->data), "PROFS ", 6) != 0) {
+         // Any other command aborts the transaction (the session lease is kept)
+         bulkProfiles.active = false;
+      }
    }
-   // Format response
-   StringFormatter sf(reinterpret_cast<char*>(response->data), sizeof(response->data));
+
+   // Format response directly into transmit ring
+   Reply sf;
    sf.setFloatFormat(1);
 
    if (strcasecmp((const char *)(cmd->data), "IDN?\n") == 0) {
@@ -357,8 +1110,6 @@ bool RemoteInterface::doCommand(Command *cmd) {
        *  <- "SMT-Oven 1.0.0.0"
        */
       sf.write(IDN);
-      response->size = sf.length();
-      send(response);
    }
    else if (strncasecmp((const char *)(cmd->data), "THERM ", 6) == 0) {
       /*
@@ -366,18 +1117,16 @@ bool RemoteInterface::doCommand(Command *cmd) {
        * -> "THERM T1Enable,T1Offset,T2Enable,T2Offset,T3Enable,T3Offset,T4Enable,T4Offset"
        * <- "OK"
        */
-      if (!getInteractiveMutex(response)) {
+      if (!acquireSession(sf)) {
          return false;
       }
       if (parseThermocouples(reinterpret_cast<char*>(&cmd->data[6]))) {
+         ConfigCache::refresh();
          sf.write("OK\n\r");
       }
       else {
          sf.write("Failed - Data error\n\r");
       }
-      interactiveMutex.release();
-      response->size = sf.length();
-      send(response);
    }
    else if (strcasecmp((const char *)(cmd->data), "THERM?\n") == 0) {
       /*
@@ -385,10 +1134,18 @@ bool RemoteInterface::doCommand(Command *cmd) {
        *  -> "THERM?"
        *  <- "T1Enable,T1Offset,T2Enable,T2Offset,T3Enable,T3Offset,T4Enable,T5Offset;"
        */
-      response->data[0] = (uint8_t)'\0';
+      bool enabled[4];
+      int  offsets[4];
+      uint32_t sequence;
+      do {
+         sequence = configLock.beginRead();
+         for (int t=0; t<4; t++) {
+            enabled[t] = temperatureSensors.getThermocouple(t).isEnabled();
+            offsets[t] = temperatureSensors.getThermocouple(t).getOffset();
+         }
+      } while (configLock.retryRead(sequence));
       for (int t=0; t<4; t++) {
-         sf.write((int)temperatureSensors.getThermocouple(t).isEnabled()).write(',')
-           .write(temperatureSensors.getThermocouple(t).getOffset());
+         sf.write((int)enabled[t]).write(',').write(offsets[t]);
          if (t != 3) {
             sf.write(',');
          }
@@ -396,8 +1153,37 @@ bool RemoteInterface::doCommand(Command *cmd) {
             sf.write(";\n\r");
          }
       }
-      response->size = sf.length();
-      send(response);
+   }
+   else if (strncasecmp((const char *)(cmd->data), "CAL ", 4) == 0) {
+      /*
+       * Sets the calibration of each thermocouple
+       * -> "CAL T1Gain,T1Offset,T2Gain,T2Offset,T3Gain,T3Offset,T4Gain,T4Offset"
+       * <- "OK"
+       */
+      if (!acquireSession(sf)) {
+         return false;
+      }
+      if (parseCalibration(reinterpret_cast<char*>(&cmd->data[4]))) {
+         ConfigCache::refresh();
+         sf.write("OK\n\r");
+      }
+      else {
+         sf.write("Failed - Data error\n\r");
+      }
+   }
+   else if (strcasecmp((const char *)(cmd->data), "CAL?\n") == 0) {
+      /*
+       *  Get thermocouple calibration
+       *  -> "CAL?"
+       *  <- "T1Gain,T1Offset,T2Gain,T2Offset,T3Gain,T3Offset,T4Gain,T4Offset;"
+       */
+      sf.setFloatFormat(4);
+      for (unsigned t=0; t<Calibration::NUM_CHANNELS; t++) {
+         float gain, offset;
+         Calibration::get(t, gain, offset);
+         sf.write(gain).write(',').write(offset);
+         sf.write((t != Calibration::NUM_CHANNELS-1)?",":";\n\r");
+      }
    }
    else if (strncasecmp((const char *)(cmd->data), "PID ", 4) == 0) {
       /*
@@ -405,19 +1191,16 @@ bool RemoteInterface::doCommand(Command *cmd) {
        *  -> "PID Proportional,Integral,Differential"
        *  <- "OK"
        */
-      // Lock interface
-      if (!getInteractiveMutex(response)) {
+      if (!acquireSession(sf)) {
          return false;
       }
       if (parsePidParameters(reinterpret_cast<char*>(&cmd->data[4]))) {
+         ConfigCache::refresh();
          sf.write("OK\n\r");
       }
       else {
          sf.write("Failed - Data error\n\r");
       }
-      interactiveMutex.release();
-      response->size = sf.length();
-      send(response);
    }
    else if (strcasecmp((const char *)(cmd->data), "PID?\n") == 0) {
       /*
@@ -425,12 +1208,50 @@ bool RemoteInterface::doCommand(Command *cmd) {
        *  -> "PID?"
        *  <- "Proportional,Integral,Differential;"
        */
-      response->data[0] = (uint8_t)'\0';
-      sf.write((float)pidKp).write(',');
-      sf.write((float)pidKi).write(',');
-      sf.write((float)pidKd).write("\n\r");
-      response->size = sf.length();
-      send(response);
+      float kp, ki, kd;
+      uint32_t sequence;
+      do {
+         sequence = configLock.beginRead();
+         kp = pidKp;
+         ki = pidKi;
+         kd = pidKd;
+      } while (configLock.retryRead(sequence));
+      sf.write(kp).write(',');
+      sf.write(ki).write(',');
+      sf.write(kd).write("\n\r");
+   }
+   else if (strncasecmp((const char *)(cmd->data), "GAINS ", 6) == 0) {
+      /*
+       *  Set PID parameters for a phase
+       *  -> "GAINS state,Proportional,Integral,Differential"
+       *  <- "OK"
+       */
+      if (!acquireSession(sf)) {
+         return false;
+      }
+      if (parseGainSchedule(reinterpret_cast<char*>(&cmd->data[6]))) {
+         ConfigCache::refresh();
+         sf.write("OK\n\r");
+      }
+      else {
+         sf.write("Failed - Data error\n\r");
+      }
+   }
+   else if (strcasecmp((const char *)(cmd->data), "GAINS?\n") == 0) {
+      /*
+       *  Get PID parameters for all phases
+       *  -> "GAINS?"
+       *  <- "5;preheat,Proportional,Integral,Differential;...;"
+       */
+      sf.write(GainSchedule::NUM_STATES).write(';');
+      for (unsigned index=0; index<GainSchedule::NUM_STATES; index++) {
+         State state = (State)(GainSchedule::FIRST_STATE+index);
+         float kp, ki, kd;
+         GainSchedule::getGains(state, kp, ki, kd);
+         sf.write(Reporter::getStateName(state)).write(',');
+         sf.write(kp).write(',').write(ki).write(',').write(kd).write(';');
+      }
+      sf.write("\n\r");
    }
    else if (strncasecmp((const char *)(cmd->data), "PROF ", 5) == 0) {
       /*
@@ -438,8 +1259,7 @@ bool RemoteInterface::doCommand(Command *cmd) {
        *  -> "PROF profile-number,description,flags,liquidus,preheatTime,soakTemp1,soakTemp2,soakTime,rampUpSlope,peakTemp,peakDwell,rampDownSlope;
        *  <- "OK"
        */
-      // Lock interface
-      if (!getInteractiveMutex(response)) {
+      if (!acquireSession(sf)) {
          return false;
       }
       if (parseProfile(reinterpret_cast<char*>(&cmd->data[5]))) {
@@ -448,9 +1268,6 @@ bool RemoteInterface::doCommand(Command *cmd) {
       else {
          sf.write("Failed - Data error\n\r");
       }
-      interactiveMutex.release();
-      response->size = sf.length();
-      send(response);
    }
    else if (strcasecmp((const char *)(cmd->data), "PROF?\n") == 0) {
       /*
@@ -458,21 +1275,71 @@ bool RemoteInterface::doCommand(Command *cmd) {
        *  -> "PROF?"
        *  -> "profile-number,description,flags,liquidus,preheatTime,soakTemp1,soakTemp2,soakTime,rampUpSlope,peakTemp,peakDwell,rampDownSlope;
        */
-      const NvSolderProfile &profile = profiles[currentProfileIndex];
-      sf.write((int)          currentProfileIndex).write(',');     /* index         */
-      sf.write((const char *) profile.description).write(',');     /* description   */
-      sf.write((int)          profile.flags).write(',');           /* flags         */
-      sf.write((int)          profile.liquidus).write(',');        /* liquidus      */
-      sf.write((int)          profile.preheatTime).write(',');     /* preheatTime   */
-      sf.write((int)          profile.soakTemp1).write(',');       /* soakTemp1     */
-      sf.write((int)          profile.soakTemp2).write(',');       /* soakTemp2     */
-      sf.write((int)          profile.soakTime).write(',');        /* soakTime      */
-      sf.write((float)        profile.rampUpSlope).write(',');     /* ramp2Slope    */
-      sf.write((int)          profile.peakTemp).write(',');        /* peakTemp      */
-      sf.write((int)          profile.peakDwell).write(',');       /* peakDwell     */
-      sf.write((float)        profile.rampDownSlope).write(',');   /* rampDownSlope */
-      response->size = sf.length();
-      send(response);
+      unsigned      index;
+      SolderProfile profile;
+      uint32_t      sequence;
+      do {
+         sequence = configLock.beginRead();
+         index    = currentProfileIndex;
+         profile  = profiles[index];
+      } while (configLock.retryRead(sequence));
+      writeProfileRecord(sf, index, profile);
+      sf.write("\n\r");
+   }
+   else if (strcasecmp((const char *)(cmd->data), "PROFS?\n") == 0) {
+      /*
+       *  Get all profiles
+       *  -> "PROFS?"
+       *  <- "10;0,description,flags,...;1,description,flags,...;...//...;checksum"
+       */
+      sf.write(MAX_PROFILES).write(';');
+      uint32_t checksum = 0;
+      for (unsigned index=0; index<MAX_PROFILES; index++) {
+         // Format separately to calculate checksum
+         SolderProfile profile;
+         readProfile(index, profile);
+         StringFormatter_T<sizeof(Command::data)> sfProfile;
+         sfProfile.setFloatFormat(1);
+         writeProfileRecord(sfProfile, index, profile);
+         checksum = crc32(sfProfile.toString(), sfProfile.length(), checksum);
+         sf.write(sfProfile.toString());
+      }
+      sf.write((unsigned long)checksum, Radix_16).write("\n\r");
+   }
+   else if (strncasecmp((const char *)(cmd->data), "PROFS END,", 10) == 0) {
+      /*
+       *  Complete bulk profile upload
+       *  -> "PROFS END,checksum"
+       *  <- "OK"
+       */
+      if (!bulkProfiles.active) {
+         sf.write("Failed - No transfer\n\r");
+      }
+      else {
+         if (bulkProfilesCommit(reinterpret_cast<char*>(&cmd->data[10]))) {
+            sf.write("OK\n\r");
+         }
+         else {
+            sf.write("Failed - Data error\n\r");
+         }
+      }
+   }
+   else if (strncasecmp((const char *)(cmd->data), "PROFS ", 6) == 0) {
+      /*
+       *  Start bulk profile upload
+       *  -> "PROFS number_of_profiles"
+       *  <- "OK"
+       */
+      if (!acquireSession(sf)) {
+         return false;
+      }
+      if (bulkProfilesBegin(reinterpret_cast<char*>(&cmd->data[6]))) {
+         sf.write("OK\n\r");
+      }
+      else {
+         bulkProfiles.active = false;
+         sf.write("Failed - Data error\n\r");
+      }
    }
    else if (strcasecmp((const char *)(cmd->data), "PLOT?\n") == 0) {
       /*
@@ -483,15 +1350,10 @@ bool RemoteInterface::doCommand(Command *cmd) {
        */
       int lastValid = Draw::getData().getLastValid();
       sf.write(lastValid+1).write(';');
-      if (lastValid < 0) {
-         // Terminate the response early
-         sf.write("\n\r");
-      }
-      response->size = sf.length();
-      send(response);
       for (int index=0; index<=lastValid; index++) {
-         logThermocoupleStatus(index, index == lastValid);
+         writeThermocoupleStatus(sf, index);
       }
+      sf.write("\n\r");
    }
    else if (strncasecmp((const char *)(cmd->data), "RUN\n\r", 4) == 0) {
       /*
@@ -499,14 +1361,13 @@ bool RemoteInterface::doCommand(Command *cmd) {
        *   <- "RUN"
        *   -> "OK"
        */
-      // Lock interface
-      if (!getInteractiveMutex(response)) {
+      // Lease is kept until the profile finishes and the lease expires
+      if (!acquireSession(sf)) {
          return false;
       }
+      sessionRunActive = true;
       RunProfile::remoteStartRunProfile();
       sf.write("OK\n\r");
-      response->size = sf.length();
-      send(response);
    }
    else if (strncasecmp((const char *)(cmd->data), "ABORT\n\r", 4) == 0) {
       /*
@@ -514,19 +1375,13 @@ bool RemoteInterface::doCommand(Command *cmd) {
        *   <- "ABORT"
        *   -> "OK"
        */
-      // Lock interface
-      if (!getInteractiveMutex(response)) {
+      if (!acquireSession(sf)) {
          return false;
       }
       RunProfile::abortRunProfile();
-      // Unlock interface
-      osStatus mutexStatus;
-      do {
-         mutexStatus = interactiveMutex.release();
-      } while (mutexStatus == osOK);
+      // Return oven to front panel
+      releaseSession();
       sf.write("OK\n\r");
-      response->size = sf.length();
-      send(response);
    }
    else if (strncasecmp((const char *)(cmd->data), "RUN?\n\r", 4) == 0) {
       /*
@@ -534,29 +1389,354 @@ bool RemoteInterface::doCommand(Command *cmd) {
        * <- "RUN?"
        * -> "OK|Failed|Running"
        */
-      // Lock interface
-      if (!getInteractiveMutex(response)) {
+      // Lock-free read so monitoring is never refused
+      State state = RunProfile::remoteCheckRunProfile();
+      if ((state == s_complete) || (state == s_fail)) {
+         if (sessionRunActive) {
+            // Remote run has finished - return oven to front panel
+            releaseSession();
+         }
+         sf.write((state == s_complete)?"OK\n\r":"Failed\n\r");
+      }
+      else {
+         sf.write("Running\n\r");
+      }
+   }
+   else if (strcasecmp((const char *)(cmd->data), "TUNE?\n") == 0) {
+      /*
+       *  Get result of last auto-tune
+       *  <- "TUNE?"
+       *  -> "Kp,Ki,Kd,Ku,Pu,amplitude,K,tau,L;"
+       */
+      RelayTuner::Result result;
+      if (AutoTune::getLastResult(result)) {
+         sf.setFloatFormat(4);
+         sf.write(result.kp).write(',').write(result.ki).write(',').write(result.kd).write(',');
+         sf.write(result.ultimateGain).write(',').write(result.ultimatePeriod).write(',').write(result.amplitude).write(',');
+         sf.write(result.processGain).write(',').write(result.timeConstant).write(',').write(result.deadTime).write(";\n\r");
+      }
+      else {
+         sf.write("Failed - No result\n\r");
+      }
+   }
+   else if (strcasecmp((const char *)(cmd->data), "RECIPES?\n") == 0) {
+      /*
+       *  Get recipes
+       *  <- "RECIPES?"
+       *  -> "3;0,PCB BAKE-OUT 125C 4H,7;1,LOW-TEMP BAKE 90C 8H,7;2,SMT ADHESIVE CURE 150C,9;"
+       *  number_of_recipes;[recipe-number,name,number_of_steps;]*
+       */
+      // Recipes are in ROM or only changed by this thread - no lock needed
+      unsigned count = ProfileProgram::getRecipeCount();
+      sf.write(count).write(';');
+      for (unsigned index=0; index<count; index++) {
+         const ProfileProgram &recipe = ProfileProgram::getRecipe(index);
+         sf.write(index).write(',').write(recipe.name).write(',').write(recipe.count).write(';');
+      }
+      sf.write("\n\r");
+   }
+   else if (strncasecmp((const char *)(cmd->data), "RECIPE? ", 8) == 0) {
+      /*
+       *  Get steps of a recipe
+       *  <- "RECIPE? recipe-number"
+       *  -> "PCB BAKE-OUT 125C 4H;7;fan,preheat,0,30.0;ramp,preheat,125,1.0;...//...;wait,ramp_down,50,0.0;"
+       *  name;number_of_steps;[type,state,temperature,value;]*
+       */
+      const char *number = reinterpret_cast<const char*>(&cmd->data[8]);
+      char *end;
+      unsigned long index = strtoul(number, &end, 10);
+      if ((end == number) || (*end != '\n') || (index >= ProfileProgram::getRecipeCount())) {
+         sf.write("Failed - Data error\n\r");
+      }
+      else {
+         const ProfileProgram &recipe = ProfileProgram::getRecipe(index);
+         sf.setFloatFormat(1);
+         sf.write(recipe.name).write(';').write(recipe.count).write(';');
+         for (unsigned step=0; step<recipe.count; step++) {
+            writeProgramStep(sf, recipe[step]);
+         }
+         sf.write("\n\r");
+      }
+   }
+   else if (strncasecmp((const char *)(cmd->data), "RECIPE ", 7) == 0) {
+      /*
+       *   Start running recipe
+       *   <- "RECIPE recipe-number"
+       *   -> "OK"
+       */
+      // Lease is kept until the recipe finishes and the lease expires
+      if (!acquireSession(sf)) {
          return false;
       }
-      State state = RunProfile::remoteCheckRunProfile();
-      if (state == s_complete) {
-         // Unlock previous lock
-         interactiveMutex.release();
+      const char *number = reinterpret_cast<const char*>(&cmd->data[7]);
+      char *end;
+      unsigned long index = strtoul(number, &end, 10);
+      if ((end == number) || (*end != '\n') || (index >= ProfileProgram::getRecipeCount())) {
+         sf.write("Failed - Data error\n\r");
+      }
+      else {
+         sessionRunActive = true;
+         RunProfile::remoteStartRunRecipe(index);
          sf.write("OK\n\r");
       }
-      else if (state == s_fail) {
-         // Unlock interface
-         interactiveMutex.release();
-         sf.write("Failed\n\r");
+   }
+   else if (strncasecmp((const char *)(cmd->data), "PROG STEP ", 10) == 0) {
+      /*
+       *  Add step to recipe upload
+       *  -> "PROG STEP type,state,temperature,value"
+       *  <- "OK"
+       */
+      if (!acquireSession(sf)) {
+         return false;
+      }
+      ProfileStep step;
+      if (!programUpload.active) {
+         sf.write("Failed - No transfer\n\r");
+      }
+      else if (!parseProgramStep(reinterpret_cast<char*>(&cmd->data[10]), step) || !programUpload.program.add(step)) {
+         // Upload fails at PROG END
+         programUpload.error = true;
+         sf.write("Failed - Data error\n\r");
       }
       else {
-         sf.write("Running\n\r");
+         sf.write("OK\n\r");
       }
-      // Unlock interface
-      interactiveMutex.release();
-      response->size = sf.length();
-      send(response);
    }
+   else if (strcasecmp((const char *)(cmd->data), "PROG END\n") == 0) {
+      /*
+       *  Complete recipe upload
+       *  -> "PROG END"
+       *  <- "OK"
+       */
+      if (!acquireSession(sf)) {
+         return false;
+      }
+      if (!programUpload.active) {
+         sf.write("Failed - No transfer\n\r");
+      }
+      else if (programUpload.error || !programUpload.program.isValid()) {
+         programUpload.active = false;
+         sf.write("Failed - Data error\n\r");
+      }
+      else {
+         programUpload.active = false;
+         ProfileProgram::setUploaded(programUpload.program);
+         sf.write("OK\n\r");
+      }
+   }
+   else if (strncasecmp((const char *)(cmd->data), "PROG ", 5) == 0) {
+      /*
+       *  Start recipe upload
+       *  -> "PROG name"
+       *  <- "OK"
+       */
+      if (!acquireSession(sf)) {
+         return false;
+      }
+      ProfileProgram &program = programUpload.program;
+      const char *name = reinterpret_cast<const char*>(&cmd->data[5]);
+      size_t length = strcspn(name, "\n\r");
+      if ((length == 0) || (length >= sizeof(program.name))) {
+         programUpload.active = false;
+         sf.write("Failed - Data error\n\r");
+      }
+      else {
+         memset(program.name, 0, sizeof(program.name));
+         memcpy(program.name, name, length);
+         program.count        = 0;
+         programUpload.active = true;
+         programUpload.error  = false;
+         sf.write("OK\n\r");
+      }
+   }
+   else if (strcasecmp((const char *)(cmd->data), "LIB?\n") == 0) {
+      /*
+       *  Get index of profile library
+       *  <- "LIB?"
+       *  -> "2;7,3A1F,5C0E2D11,Sn63Pb37 Kester;42,91C4,0B7E4410,SAC305 Large board;"
+       *  number_of_profiles;[id,name_hash,checksum,description;]*
+       */
+      // Library is only changed by this thread - no lock needed
+      sf.write(ProfileLibrary::getCount()).write(';');
+      for (unsigned id=1; id<=ProfileLibrary::MAX_ID; id++) {
+         const ProfileLibrary::Record *record = ProfileLibrary::find(id);
+         if (record == nullptr) {
+            continue;
+         }
+         sf.write(id).write(',');
+         sf.write((unsigned)record->nameHash, Radix_16).write(',');
+         sf.write((unsigned long)record->checksum, Radix_16).write(',');
+         sf.write(record->profile.description).write(';');
+      }
+      sf.write("\n\r");
+   }
+   else if (strncasecmp((const char *)(cmd->data), "LIB? ", 5) == 0) {
+      /*
+       *  Get profile from library
+       *  <- "LIB? id"
+       *  -> "id,description,flags,liquidus,preheatTime,soakTemp1,soakTemp2,soakTime,rampUpSlope,peakTemp,peakDwell,rampDownSlope;
+       */
+      unsigned      id;
+      SolderProfile profile;
+      if (!parseLibraryId(reinterpret_cast<const char*>(&cmd->data[5]), id) ||
+          !ProfileLibrary::load(id, profile)) {
+         sf.write("Failed - Data error\n\r");
+      }
+      else {
+         writeProfileRecord(sf, id, profile);
+         sf.write("\n\r");
+      }
+   }
+   else if (strncasecmp((const char *)(cmd->data), "LIB RUN ", 8) == 0) {
+      /*
+       *   Start running profile from library
+       *   <- "LIB RUN id"
+       *   -> "OK"
+       */
+      // Lease is kept until the profile finishes and the lease expires
+      if (!acquireSession(sf)) {
+         return false;
+      }
+      unsigned id;
+      if (!parseLibraryId(reinterpret_cast<const char*>(&cmd->data[8]), id) ||
+          (ProfileLibrary::find(id) == nullptr)) {
+         sf.write("Failed - Data error\n\r");
+      }
+      else {
+         sessionRunActive = true;
+         RunProfile::remoteStartRunLibrary(id);
+         sf.write("OK\n\r");
+      }
+   }
+   else if (strncasecmp((const char *)(cmd->data), "LIB DEL ", 8) == 0) {
+      /*
+       *   Delete profile from library
+       *   <- "LIB DEL id"
+       *   -> "OK"
+       */
+      if (!acquireSession(sf)) {
+         return false;
+      }
+      unsigned id;
+      if (sessionRunActive) {
+         // Flash operations stall the processor
+         sf.write("Failed - Busy\n\r");
+      }
+      else if (!parseLibraryId(reinterpret_cast<const char*>(&cmd->data[8]), id) ||
+               !ProfileLibrary::remove(id)) {
+         sf.write("Failed - Data error\n\r");
+      }
+      else {
+         sf.write("OK\n\r");
+      }
+   }
+   else if (strncasecmp((const char *)(cmd->data), "LIB ", 4) == 0) {
+      /*
+       *  Add or replace profile in library
+       *  -> "LIB id,description,flags,liquidus,preheatTime,soakTemp1,soakTemp2,soakTime,rampUpSlope,peakTemp,peakDwell,rampDownSlope;
+       *  <- "OK"
+       */
+      if (!acquireSession(sf)) {
+         return false;
+      }
+      if (sessionRunActive) {
+         // Flash operations stall the processor
+         sf.write("Failed - Busy\n\r");
+      }
+      else if (parseLibraryProfile(reinterpret_cast<char*>(&cmd->data[4]))) {
+         sf.write("OK\n\r");
+      }
+      else {
+         sf.write("Failed - Data error\n\r");
+      }
+   }
+   else if (strncasecmp((const char *)(cmd->data), "BENCH? ", 7) == 0) {
+      /*
+       * Get synthetic bulk data for USB throughput measurement
+       * <- "BENCH? size"
+       * -> "0000000,preheat,0,27.8,27.5,0,100,0.0,0.0,27.5,0.0;...
+       */
+      static constexpr unsigned RECORD_SIZE = 64;
+      static const char record[] = ",preheat,0,27.8,27.5,0,100,0.0,0.0,27.5,0.0,000000000000;";
+      static_assert((sizeof(record)-1+7) == RECORD_SIZE, "Record size inconsistent");
+
+      unsigned long size = strtoul(reinterpret_cast<char*>(&cmd->data[7]), nullptr, 10);
+      if (size > 1000000) {
+         size = 1000000;
+      }
+      sf.setPadding(Padding_LeadingZeroes).setWidth(7);
+      for (unsigned long offset=0; offset<size; offset+=RECORD_SIZE) {
+         sf.write(offset).write(record);
+      }
+      sf.setPadding(Padding_None).setWidth(0);
+      sf.write("\n\r");
+   }
+   else if (strcasecmp((const char *)(cmd->data), "HEALTH?\n") == 0) {
+      /*
+       * Get thermocouple health
+       * <- "HEALTH?"
+       * -> "4;[thermocouple,status,readings,faults,held,excluded,consecutive,maximum_consecutive,rejected;]*"
+       */
+      sf.write(TemperatureSensors::NUM_THERMOCOUPLES).write(';');
+      for (unsigned t=0; t<TemperatureSensors::NUM_THERMOCOUPLES; t++) {
+         Max31855 &thermocouple = temperatureSensors.getThermocouple(t);
+         float temperature, coldReference;
+         Max31855::ThermocoupleStatus status = thermocouple.getLastReading(temperature, coldReference);
+         Max31855::Health health = thermocouple.getHealth();
+         sf.write(t+1).write(',').write(status).write(',');
+         sf.write(health.readings).write(',').write(health.faults).write(',');
+         sf.write(health.held).write(',').write(health.excluded).write(',');
+         sf.write(health.consecutiveFaults).write(',').write(health.maxConsecutiveFaults).write(',');
+         sf.write(temperatureSensors.isRejected(t)?1:0).write(';');
+      }
+      sf.write("\n\r");
+   }
+   else if (strcasecmp((const char *)(cmd->data), "HEALTH CLEAR\n") == 0) {
+      /*
+       * Clear thermocouple health counters
+       * <- "HEALTH CLEAR"
+       * -> "OK"
+       */
+      temperatureSensors.clearHealth();
+      sf.write("OK\n\r");
+   }
+   else if (strcasecmp((const char *)(cmd->data), "STATS?\n") == 0) {
+      /*
+       * Get run-time statistics
+       * <- "STATS?"
+       * -> "name,type,values...;...;"
+       */
+      Statistics::reportAll(sf);
+      sf.write("\n\r");
+   }
+   else if (strcasecmp((const char *)(cmd->data), "STATS CLEAR\n") == 0) {
+      /*
+       * Clear run-time statistics
+       * <- "STATS CLEAR"
+       * -> "OK"
+       */
+      Statistics::resetAll();
+      sf.write("OK\n\r");
+   }
+#if TRACE_ENABLED
+   else if (strcasecmp((const char *)(cmd->data), "TRACE?\n") == 0) {
+      /*
+       * Get event trace
+       * <- "TRACE?"
+       * -> "frequency,number_of_threads,number_of_events;[context,name;]*[timestamp,phase,context,name;]*"
+       */
+      sendTrace(sf);
+   }
+   else if (strcasecmp((const char *)(cmd->data), "TRACE CLEAR\n") == 0) {
+      /*
+       * Clear event trace
+       * <- "TRACE CLEAR"
+       * -> "OK"
+       */
+      Trace::clear();
+      sf.write("OK\n\r");
+   }
+#endif
    else {
       /*
        * Unknown command
@@ -564,18 +1744,50 @@ bool RemoteInterface::doCommand(Command *cmd) {
        * -> "Failed - unrecognized command"
        */
       sf.write("Failed - unrecognized command\n\r");
-      response->size = sf.length();
-      send(response);
    }
    return true;
 }
 
+#if TRACE_ENABLED
+/**
+ * Send contents of trace buffer to remote
+ *
+ * @param[in] reply Reply to write trace to
+ */
+void RemoteInterface::sendTrace(USBDM::FormattedIO &reply) {
+   using namespace USBDM;
+
+   Trace::pause(true);
+
+   unsigned numThreads;
+   const Trace::ThreadName *threadNames = Trace::getThreadNames(numThreads);
+   const unsigned numEvents = Trace::getCount();
+
+   reply.write((unsigned long)Trace::getFrequency()).write(',').write(numThreads).write(',').write(numEvents).write(';');
+   for (unsigned index=0; index<numThreads; index++) {
+      reply.write((unsigned long)threadNames[index].context, Radix_16).write(',').write(threadNames[index].name).write(';');
+   }
+   for (unsigned index=0; index<numEvents; index++) {
+      const Trace::Event &event = Trace::getEvent(index);
+      reply.write((unsigned long)event.timestamp, Radix_16).write(',')
+           .write((char)event.phase).write(',')
+           .write((unsigned long)event.context, Radix_16).write(',')
+           .write(event.name).write(';');
+   }
+   reply.write("\n\r");
+
+   Trace::pause(false);
+}
+#endif
+
 /**
  * Thread handling CDC traffic
  */
 void RemoteInterface::commandThread(const void *) {
+   TRACE_THREAD("Remote");
    for(;;) {
-      osEvent event = commandQueue.get();
+      // Poll while holding the session lease so it can expire
+      osEvent event = commandQueue.get(sessionLeaseHeld?SESSION_POLL_MS:osWaitForever);
       if (event.status == osEventMail) {
          // Get command
          Command *cmd = (Command *)event.value.p;
@@ -583,7 +1795,9 @@ void RemoteInterface::commandThread(const void *) {
          doCommand(cmd);
          // Release command storage
          commandQueue.free(cmd);
+         Statistics::commandQueueUsed.add(-1);
       }
+      checkSessionLease();
    }
 }
 
@@ -594,10 +1808,13 @@ void RemoteInterface::commandThread(const void *) {
  */
 void RemoteInterface::initialise() {
    command  = nullptr;
-   response = nullptr;
+   txHead   = 0;
+   txTail   = 0;
+
+   sessionLeaseHeld = false;
+   sessionRunActive = false;
 
    commandQueue.create();
-   responseQueue.create();
 
    handlerThread.run();
 }
@@ -612,25 +1829,18 @@ void RemoteInterface::initialise() {
  * @param buff Buffer for data
  *
  * @note the Data is volatile and is processed or saved immediately.
+ * @note A command that arrives while the command queue is full is discarded in its entirety.
  */
 void RemoteInterface::putData(int size, volatile const uint8_t *buff) {
-   for (int i=0; i<size; i++) {
-      if (command == nullptr) {
-         // Allocate new command buffer
-         command = commandQueue.allocISR();
-         if (command == nullptr) {
-            // Can't allocate buffer - discard data & return
-            return;
-         }
-         command->size = 0;
-      }
-      // Check for command too large
-      usbdm_assert(command->size<((sizeof(command->data)/sizeof(command->data[0]))-2), "Command size too large");
+   // Discarding the rest of an over-long or unqueued command
+   static bool discarding = false;
 
+   for (int i=0; i<size; i++) {
       // Check for command termination
       if ((buff[i] == '\r') || (buff[i] == '\n')) {
+         discarding = false;
          // Discard empty commands (discards '\r', '\n')
-         if (command->size>0) {
+         if ((command != nullptr) && (command->size>0)) {
             // Terminate command
             command->data[command->size++] = '\n';
             command->data[command->size++] = '\0';
@@ -643,6 +1853,29 @@ void RemoteInterface::putData(int size, volatile const uint8_t *buff) {
          }
          continue;
       }
+      if (discarding) {
+         continue;
+      }
+      if (command == nullptr) {
+         // Allocate new command buffer
+         command = commandQueue.allocISR();
+         if (command == nullptr) {
+            // Can't allocate buffer - discard rest of command rather than queue a fragment
+            Statistics::commandQueueAllocFail.increment();
+            discarding = true;
+            continue;
+         }
+         Statistics::commandQueueUsed.add(1);
+         command->size = 0;
+      }
+      // Check for command too large (leave room for terminator)
+      if (command->size >= ((sizeof(command->data)/sizeof(command->data[0]))-2)) {
+         // Discard the entire command
+         Statistics::commandTooLong.increment();
+         command->size = 0;
+         discarding    = true;
+         continue;
+      }
       // Save data to buffer
       command->data[command->size++] = buff[i];
    }
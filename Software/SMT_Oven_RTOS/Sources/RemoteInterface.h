@@ -14,12 +14,15 @@
 #include "configure.h"
 #include "plotting.h"
 #include "reporter.h"
+#include "statistics.h"
+#include "trace.h"
 
 /**
  *    USB CDC receive ISR ----> Command Queue -----> Remote thread
  *                                                     ...
  *                                                     ...
- *    USB CDC send ISR <------- Response Queue <---- Remote thread
+ *    USB CDC send ISR <------- Transmit Ring <----- Remote thread (Reply)
+ *                                            <----- Profile thread (log points)
  */
 class RemoteInterface: public USBDM::CDC_Interface {
 
@@ -30,11 +33,13 @@ public:
       unsigned size;
    };
 
-   /** Structure holding (part of) a response */
-   struct Response{
-      uint8_t  data[1000];
-      unsigned size;
-   };
+   /** Size of transmit ring buffer (must be a power of 2) */
+   static constexpr unsigned TX_BUFFER_SIZE = 1024;
+
+   /** Time a blocking reply waits for space in the transmit ring before it is discarded (ms) */
+   static constexpr unsigned TX_TIMEOUT_MS = 1000;
+
+   class Reply;
 
 protected:
    RemoteInterface() {}
@@ -43,21 +48,42 @@ protected:
    /** Queue of received commands */
    static CMSIS::MailQueue<Command, 4>  commandQueue;
 
-   /** Queue of sent responses */
-   static CMSIS::MailQueue<Response, 4> responseQueue;
+   /** Transmit ring buffer - written by Reply, read by USB send ISR */
+   static uint8_t txBuffer[TX_BUFFER_SIZE];
+
+   /** Index of next byte to be sent by USB */
+   static volatile unsigned txTail;
+
+   /** Index after last byte committed for sending */
+   static volatile unsigned txHead;
+
+   /** Serialises writers to the transmit ring so replies are not interleaved */
+   static CMSIS::Mutex txMutex;
 
    /** Current command being assembled by USB receive ISR */
    static Command  *command;
 
-   /** Current response being assembled by Remote thread */
-   static Response *response;
-
    /** Thread to handle CDC commands */
    static CMSIS::Thread handlerThread;
 
    /** Identification string */
    static const char *IDN;
 
+   /** Time without a changing command after which the session lease is released (ms) */
+   static constexpr uint32_t SESSION_LEASE_MS = 3000;
+
+   /** Interval at which the command thread checks the session lease (ms) */
+   static constexpr uint32_t SESSION_POLL_MS = 500;
+
+   /** Remote host holds interactiveMutex as a session lease */
+   static bool sessionLeaseHeld;
+
+   /** Time the session lease was last used (kernel ticks) */
+   static uint32_t sessionLastUsed;
+
+   /** A profile started remotely has not yet been seen to finish */
+   static bool sessionRunActive;
+
    /**
     * Writes thermocouple status to log
     *
@@ -67,14 +93,32 @@ protected:
    static void logThermocoupleStatus(int time, bool lastEntry=false);
 
    /**
-    * Try to lock the Interactive mutex so that the remote session has ownership
+    * Writes a thermocouple status log entry
     *
-    * @param[out] response Buffer to use for response if needed.
+    * @param[in] sf    Formatter to write to
+    * @param[in] time  Time of log entry to write
+    */
+   static void writeThermocoupleStatus(USBDM::FormattedIO &sf, int time);
+
+   /**
+    * Obtain or renew the session lease so that the remote host has ownership of the oven
+    *
+    * @param[in] reply Reply to write failure message to
     *
     * @return true  => success
-    * @return false => failed (A fail response has been sent to the remote and response has been consumed)
+    * @return false => failed (A fail response has been written to reply)
+    */
+   static bool acquireSession(USBDM::FormattedIO &reply);
+
+   /**
+    * Give up the session lease returning ownership to the front panel
+    */
+   static void releaseSession();
+
+   /**
+    * Release the session lease if it has expired
     */
-   static bool getInteractiveMutex(RemoteInterface::Response *response);
+   static void checkSessionLease();
 
    /**
     * Execute remote command
@@ -86,6 +130,15 @@ protected:
     */
    static bool doCommand(Command *command);
 
+#if TRACE_ENABLED
+   /**
+    * Send contents of trace buffer to remote
+    *
+    * @param[in] reply Reply to write trace to
+    */
+   static void sendTrace(USBDM::FormattedIO &reply);
+#endif
+
    /**
     * Thread handling CDC traffic
     */
@@ -93,47 +146,140 @@ protected:
 
 public:
    /**
-    * Get response
+    * Formatter that writes a reply directly into the transmit ring.\n
+    * The ring is locked for the lifetime of the object so replies from different
+    * threads are not interleaved. The data is committed for sending when the object
+    * is destroyed (or earlier if a blocking reply fills the ring).\n
+    * A blocking reply that cannot get space within TX_TIMEOUT_MS (host not reading) discards
+    * the rest of the reply and releases the ring.
     *
-    * @return Response or nullptr if none available
+    * Example:
+    * @code
+    *   {
+    *      Reply reply;
+    *      reply.write("OK\n\r");
+    *   }
+    * @endcode
     */
-   static RemoteInterface::Response *getResponse() {
-      osEvent status = RemoteInterface::responseQueue.getISR();
-      if (status.status != osEventMail) {
-         // No messages waiting
-         return nullptr;
+   class Reply : public USBDM::FormattedIO {
+
+   private:
+      /** Wait for space in ring if full (up to TX_TIMEOUT_MS), otherwise discard the entire reply */
+      const bool blocking;
+
+      /** Reply has been discarded */
+      bool discarded;
+
+      /** Index for next byte written (not yet committed) */
+      unsigned writeIndex;
+
+   public:
+      /**
+       * Create reply
+       *
+       * @param[in] blocking  true  => Wait for the ring lock and for space in the ring as needed.\n
+       *                               The rest of the reply is discarded if no space is freed within TX_TIMEOUT_MS.\n
+       *                      false => Discard the entire reply if the ring is locked or full.
+       */
+      Reply(bool blocking=true);
+
+      /**
+       * Destructor - commits reply for sending and releases ring
+       */
+      virtual ~Reply();
+
+      /**
+       * Indicates if the reply was discarded (ring full or timed out)
+       *
+       * @return true => Reply discarded
+       */
+      bool isDiscarded() const {
+         return discarded;
+      }
+
+      /**
+       * Commit data written so far for sending (blocking reply only)
+       */
+      virtual void flushOutput() override;
+
+      /**
+       * Flush input data - not applicable
+       */
+      virtual void flushInput() override {
       }
-      // Set up new message
-      return (RemoteInterface::Response*)status.value.p;
-   }
+
+   protected:
+      /**
+       * Check if character is available - not applicable
+       *
+       * @return false
+       */
+      virtual bool _isCharAvailable() override {
+         return false;
+      }
+
+      /**
+       * Receives a single character - not applicable
+       *
+       * @return -1
+       */
+      virtual int _readChar() override {
+         return -1;
+      }
+
+      /**
+       * Writes a character into the transmit ring
+       *
+       * @param[in]  ch - character to send
+       */
+      virtual void _writeChar(char ch) override;
+
+   private:
+      /**
+       * Make data written so far available to USB
+       */
+      void commit();
+   };
 
    /**
-    * Used to free response buffer
+    * Get contiguous block of data waiting to be sent\n
+    * Called from USB send ISR. The data remains in the ring until released by txDataSent().
+    *
+    * @param[out] data     Set to start of data
+    * @param[in]  maxSize  Maximum size of block
+    * @param[out] isLast   Set true if this block empties the ring
     *
-    * @param[in] response Response buffer to free
+    * @return Size of block (0 if none waiting)
     */
-   static void freeResponseBuffer(RemoteInterface::Response *response) {
-      RemoteInterface::responseQueue.free(response);
+   static unsigned getTxData(volatile const uint8_t *&data, unsigned maxSize, bool &isLast) {
+      unsigned head = txHead;
+      unsigned tail = txTail;
+      unsigned size = (head >= tail)?(head-tail):(TX_BUFFER_SIZE-tail);
+      if (size > maxSize) {
+         size = maxSize;
+      }
+      isLast = (((tail+size)%TX_BUFFER_SIZE) == head);
+      data   = &txBuffer[tail];
+      return size;
    }
 
    /**
-    * Allocate response (send) buffer
+    * Release data that has been sent\n
+    * Called from USB send ISR
     *
-    * @return Pointer to allocated buffer
-    * @return nullptr Failed allocation
+    * @param[in] size Size of block obtained from getTxData()
     */
-   static Response *allocResponseBuffer() {
-      return responseQueue.alloc();
+   static void txDataSent(unsigned size) {
+      txTail = (txTail+size)%TX_BUFFER_SIZE;
    }
 
    /**
-    * Set response over CDC
-    *
-    * @param[in] response Response text to send
-    *
-    * @return true Success
+    * Discard all data waiting to be sent\n
+    * Called from USB ISR on USB reset
     */
-   static bool send(Response *response);
+   static void txDataClear() {
+      txTail = txHead;
+   }
 
    /**
     * Initialise
@@ -40,6 +40,7 @@ void SolderProfile::operator=(const SolderProfile &other ) {
       description[i]   = other.description[i];
    }
    flags         = other.flags;
+   liquidus      = other.liquidus;
    preheatTime   = other.preheatTime;
    soakTemp1     = other.soakTemp1;
    soakTemp2     = other.soakTemp2;
@@ -53,11 +54,12 @@ void SolderProfile::operator=(const SolderProfile &other ) {
 /**
  * Assignment from SolderProfile
  *
- * This adds a wait for the Flash to be updated after each element is assigned
+ * The profile is written as a single transaction (see FlexRamTransaction)
  *
  * @param other Profile to copy from
  */
 void NvSolderProfile::operator=(const SolderProfile &other ) {
+   USBDM::FlexRamTransaction::Scope transaction;
    flags         = other.flags;
    description   = other.description;
    liquidus      = other.liquidus;
@@ -74,11 +76,12 @@ void NvSolderProfile::operator=(const SolderProfile &other ) {
 /**
  * Assignment from NvSolderProfile
  *
- * This adds a wait for the Flash to be updated after each element is assigned
+ * The profile is written as a single transaction (see FlexRamTransaction)
  *
  * @param other Profile to copy from
  */
 void NvSolderProfile::operator=(const NvSolderProfile &other ) {
+   USBDM::FlexRamTransaction::Scope transaction;
    flags         = other.flags;
    description   = other.description;
    liquidus      = other.liquidus;
@@ -56,6 +56,10 @@ public:
    void operator=(const NvSolderProfile &other );
 
    bool isValid() {
+      // Times and ramp up slope are divisors when the profile is converted to a program
+      if ((this->preheatTime == 0) || (this->soakTime == 0) || !(this->rampUpSlope > 0)) {
+         return false;
+      }
       if (this->soakTemp2<this->soakTemp1) {
          return false;
       }
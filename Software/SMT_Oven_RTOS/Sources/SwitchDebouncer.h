@@ -11,6 +11,9 @@
 
 #include "cmsis.h"
 #include "pit.h"
+#include "statistics.h"
+#include "trace.h"
+#include "uiEvents.h"
 
 /**
  * Return values from switch
@@ -96,6 +99,9 @@ public:
  * Switch debouncer\n
  * It regularly polls the 5 switches ands adds switch-presses to a queue
  *
+ * Polling stops once the switches have been released for a while so the processor
+ * can sleep (see lowPower.h). A pin interrupt on any pressed switch restarts polling.
+ *
  * @tparam f1           F1 switch GPIO
  * @tparam f2           F2 switch GPIO
  * @tparam f3           F3 switch GPIO
@@ -126,6 +132,9 @@ private:
    /* Auto-repeat period (in TICK_INTERVAL) */
    static constexpr int REPEAT_PERIOD      = 200/TICK_INTERVAL;
 
+   /* Time switches are released before polling stops (in TICK_INTERVAL) */
+   static constexpr int IDLE_THRESHOLD     = 200/TICK_INTERVAL;
+
    /** Last pressed switch */
    volatile SwitchValue switchNum;
 
@@ -137,6 +146,10 @@ private:
 
    unsigned debounceCount = 0;
    unsigned lastSnapshot  = 0;
+   unsigned idleCount     = 0;
+
+   /** PIT channel used for polling */
+   USBDM::PitChannelNum pitNum;
 
    /**
     * Get Key from queue
@@ -171,28 +184,84 @@ private:
          debounceCount++;
          if (debounceCount == DEBOUNCE_THRESHOLD) {
             // Consider de-bounced
-            keyQueue.put(SwitchValue(snapshot), 0);
+            TRACE_INSTANT("key");
+            if (keyQueue.put(SwitchValue(snapshot), 0) != osOK) {
+               Statistics::keyQueueOverflow.increment();
+            }
+            UiEvents::post(UiEvents::UiEvent_Key);
          }
          if ((debounceCount >= REPEAT_THRESHOLD) &&
                ((debounceCount % REPEAT_PERIOD) == 0) &&
                ((snapshot&SwitchValue::SW_S) == 0)) {
             // Pressed and held - auto-repeat
             // Note - S Key does not repeat
-            keyQueue.put(SwitchValue(snapshot).setRepeating(), 0);
+            if (keyQueue.put(SwitchValue(snapshot).setRepeating(), 0) != osOK) {
+               Statistics::keyQueueOverflow.increment();
+            }
+            UiEvents::post(UiEvents::UiEvent_Key);
          }
       }
       else {
          // Restart debounce time
          debounceCount = 0;
       }
+      if ((snapshot == 0) && (lastSnapshot == 0)) {
+         idleCount++;
+         if (idleCount >= IDLE_THRESHOLD) {
+            stopPolling();
+         }
+      }
+      else {
+         idleCount = 0;
+      }
       lastSnapshot  = snapshot;
    }
+
+   /**
+    * Stop polling and wait for a switch to be pressed\n
+    * Level interrupts are used so a switch pressed while this is done is not missed
+    */
+   void stopPolling() {
+      using namespace USBDM;
+      Pit::disableChannel(pitNum);
+      f1::setPinAction(PinAction_IrqLow);
+      f2::setPinAction(PinAction_IrqLow);
+      f3::setPinAction(PinAction_IrqLow);
+      f4::setPinAction(PinAction_IrqLow);
+      sel::setPinAction(PinAction_IrqLow);
+   }
+
+   /**
+    * Called from pin interrupt when a switch is pressed while polling is stopped
+    */
+   void startPolling() {
+      using namespace USBDM;
+      f1::setPinAction(PinAction_None);
+      f2::setPinAction(PinAction_None);
+      f3::setPinAction(PinAction_None);
+      f4::setPinAction(PinAction_None);
+      sel::setPinAction(PinAction_None);
+      f1::clearInterruptFlag();
+      f2::clearInterruptFlag();
+      f3::clearInterruptFlag();
+      f4::clearInterruptFlag();
+      sel::clearInterruptFlag();
+      idleCount     = 0;
+      debounceCount = 0;
+      lastSnapshot  = 0;
+      Pit::enableChannel(pitNum);
+   }
+
    static SwitchDebouncer *This;
 
    static void shim() {
       This->callback();
    }
 
+   static void pinShim(uint32_t) {
+      This->startPolling();
+   }
+
 public:
    /**
     * Create the switch monitor
@@ -208,11 +277,23 @@ public:
       keyQueue.create();
       using Pit = USBDM::Pit;
       Pit::configure(PitDebugMode_Stop);
-      PitChannelNum pitNum = Pit::allocateChannel();
+      pitNum = Pit::allocateChannel();
       This = this;
       Pit::setCallback(pitNum, shim);
       Pit::configureChannel(pitNum, TICK_INTERVAL*ms, PitChannelIrq_Enabled);
       Pit::enableNvicInterrupts(pitNum, NvicPriority_Normal);
+
+      // Pin interrupts restart polling (same priority as PIT so they don't interrupt each other)
+      f1::setCallback(pinShim);
+      f2::setCallback(pinShim);
+      f3::setCallback(pinShim);
+      f4::setCallback(pinShim);
+      sel::setCallback(pinShim);
+      f1::enableNvicInterrupts(NvicPriority_Normal);
+      f2::enableNvicInterrupts(NvicPriority_Normal);
+      f3::enableNvicInterrupts(NvicPriority_Normal);
+      f4::enableNvicInterrupts(NvicPriority_Normal);
+      sel::enableNvicInterrupts(NvicPriority_Normal);
 //      start(TICK_INTERVAL);
    }
 
@@ -16,6 +16,8 @@
  *
  * The switching waveform will be synchronised to the mains zero crossing
  *
+ * The zero-crossing interrupts are disabled while the heater and fan are off
+ *
  * @tparam Heater     USBDM::Gpio controlling the oven heater SSD
  * @tparam HeaterLed  USBDM::Gpio controlling the oven heater LED
  * @tparam OvenFan    USBDM::Gpio controlling the oven fan SSD
@@ -90,6 +92,17 @@ private:
          FanLed::write(wholePart>0);
       }
 #endif
+      if ((heaterDutycycle == 0) && (fanDutycycle == 0) && (fanKick == 0)) {
+         // Outputs are now off - no need to wake on each zero-crossing
+         Vmains::enableInterrupts(USBDM::CmpInterrupt_None);
+      }
+   }
+
+   /**
+    * Restart zero-crossing interrupts if stopped by callbackFunction()
+    */
+   static void enableZeroCrossingInterrupts() {
+      Vmains::enableInterrupts(USBDM::CmpInterrupt_Both);
    }
 
 public:
@@ -146,6 +159,9 @@ public:
          fanKick = fanKickTime;
       }
       fanDutycycle = dutycycle;
+      if (dutycycle != 0) {
+         enableZeroCrossingInterrupts();
+      }
    }
 
    /**
@@ -155,6 +171,9 @@ public:
     */
    static void setHeaterDutycycle(int dutycycle) {
       heaterDutycycle = dutycycle;
+      if (dutycycle != 0) {
+         enableZeroCrossingInterrupts();
+      }
    }
    /**
     * Get duty cycle of fan
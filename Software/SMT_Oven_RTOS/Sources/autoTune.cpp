@@ -0,0 +1,180 @@
+/**
+ * @file    autoTune.cpp
+ * @brief   Automatic tuning of the PID controller (relay feedback)
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <math.h>
+#include "autoTune.h"
+#include "configCache.h"
+#include "configure.h"
+#include "messageBox.h"
+#include "reporter.h"
+#include "settings.h"
+#include "uiEvents.h"
+
+using namespace USBDM;
+
+namespace AutoTune {
+
+/** Result of last successful tuning (protected by configLock) */
+static RelayTuner::Result lastResult;
+
+/** Indicates lastResult is valid */
+static bool lastResultValid = false;
+
+/** Tuner being run (for display) */
+static RelayTuner *tuner = nullptr;
+
+/**
+ * Get result of last successful tuning\n
+ * Lock-free - may be called from any thread
+ *
+ * @param[out] result Result
+ *
+ * @return true  Result available
+ * @return false No tuning has completed since reset
+ */
+bool getLastResult(RelayTuner::Result &result) {
+   bool valid;
+   uint32_t sequence;
+   do {
+      sequence = configLock.beginRead();
+      valid    = lastResultValid;
+      result   = lastResult;
+   } while (configLock.retryRead(sequence));
+   return valid;
+}
+
+/**
+ * Write result to console
+ *
+ * @param[in] result Result to write
+ */
+static void report(const RelayTuner::Result &result) {
+   console.write("Auto-tune: Ku=").write(result.ultimateGain).write(", Pu=").write(result.ultimatePeriod)
+          .write("s, a=").writeln(result.amplitude);
+   console.write("Auto-tune: Kp=").write(result.kp).write(", Ki=").write(result.ki)
+          .write(", Kd=").writeln(result.kd);
+   console.write("Auto-tune: K=").write(result.processGain).write(", tau=").write(result.timeConstant)
+          .write("s, L=").write(result.deadTime).writeln("s");
+}
+
+/**
+ * Save result as PID and feed-forward settings\n
+ * Values are limited to the ranges allowed by the settings menu.
+ *
+ * @param[in] result Result to save
+ */
+static void save(const RelayTuner::Result &result) {
+   SeqLock::WriteScope ws(configLock);
+   FlexRamTransaction::Scope transaction;
+
+   pidKpSetting.set(result.kp);
+   pidKiSetting.set(result.ki);
+   pidKdSetting.set(result.kd);
+   ovenGainSetting.set(result.processGain);
+   ovenTauSetting.set((int)roundf(result.timeConstant));
+   ffLeadSetting.set((int)roundf(result.deadTime));
+}
+
+/**
+ * Run auto-tuning interactively\n
+ * Doesn't return until complete
+ */
+void run() {
+
+   if (!checkThermocouples()) {
+      return;
+   }
+   MessageBoxResult rc = messageBox("Auto-tune PID",
+         "Cycles oven around\n"
+         "150\x7F for 10-30 min\n\n"
+         "Start tuning?", MSG_YES_NO);
+   if (rc != MSG_IS_YES) {
+      return;
+   }
+   float ambient = getTemperature();
+   RelayTuner relayTuner(TUNE_SETPOINT, ambient, TUNE_HIGH, TUNE_LOW, TUNE_HYSTERESIS, TUNE_TIMEOUT);
+   tuner = &relayTuner;
+
+   static auto textPrompt = []() {
+      lcd.gotoXY(lcd.LCD_WIDTH-lcd.FONT_WIDTH*4-3, lcd.LCD_HEIGHT-lcd.FONT_HEIGHT);
+      lcd.setInversion(true); lcd.putSpace(3); lcd.write("Stop");  lcd.putSpace(3); lcd.setInversion(false);
+
+      lcd.gotoXY(0, 12+4*lcd.FONT_HEIGHT+2);
+      lcd.write("Cycle ").write(tuner->getCycles()).write("/").write(RelayTuner::NUM_CYCLES).write(" ");
+      lcd.write("T=").write(temperatureSensors.getLastTemperature()).write("\x7F ");
+
+      lcd.gotoXY(0, lcd.LCD_HEIGHT-lcd.FONT_HEIGHT);
+      lcd.write("Tuning");
+   };
+
+   Reporter::reset();
+   Reporter::setTextPrompt(textPrompt);
+   Reporter::setDisplayFormat(Reporter::DisplayTable);
+
+   // Target shown in log
+   pid.enable(false);
+   pid.setSetpoint(TUNE_SETPOINT);
+   ovenControl.setFanDutycycle(minimumFanSpeed);
+
+   // Sample and switch heater every second
+   int      time    = 0;
+   bool     aborted = false;
+   ovenControl.setHeaterDutycycle(relayTuner.update(0, getTemperature()));
+   Reporter::displayProfileProgress();
+   while (relayTuner.getStatus() == RelayTuner::Tune_Running) {
+      // Several keys may be queued for one event
+      UiEvents::UiEvent event = (buttons.peekButton() != SwitchValue::SW_NONE)?UiEvents::UiEvent_Key:UiEvents::wait();
+      if (event == UiEvents::UiEvent_Tick) {
+         time++;
+         ovenControl.setHeaterDutycycle(relayTuner.update(time, getTemperature()));
+         Reporter::addLogPoint(time, s_manual);
+         Reporter::displayProfileProgress();
+      }
+      else if ((event == UiEvents::UiEvent_Key) && (buttons.getButton(0) == SwitchValue::SW_S)) {
+         aborted = true;
+         break;
+      }
+   }
+   tuner = nullptr;
+
+   // Cool oven
+   ovenControl.setHeaterDutycycle(0);
+   ovenControl.setFanDutycycle(100);
+   pid.setSetpoint(0);
+
+   Buzzer::play();
+
+   if (aborted || (relayTuner.getStatus() != RelayTuner::Tune_Complete)) {
+      messageBox("Auto-tune PID", aborted?"Tuning aborted":"Tuning failed\n\nOven did not\noscillate in time");
+   }
+   else {
+      const RelayTuner::Result &result = relayTuner.getResult();
+      {
+         SeqLock::WriteScope ws(configLock);
+         lastResult      = result;
+         lastResultValid = true;
+      }
+      report(result);
+
+      StringFormatter_T<100> sf;
+      sf.setFloatFormat(2);
+      sf.write("Kp=").write(result.kp).write(" Kd=").write(result.kd).write('\n');
+      sf.setFloatFormat(4);
+      sf.write("Ki=").write(result.ki).write('\n');
+      sf.setFloatFormat(2);
+      sf.write("K=").write(result.processGain).write(" T=").write((int)roundf(result.timeConstant))
+        .write(" L=").write((int)roundf(result.deadTime)).write('\n');
+      sf.write("Save PID & model?");
+      if (messageBox("Auto-tune result", sf.toString(), MSG_YES_NO) == MSG_IS_YES) {
+         save(result);
+         ConfigCache::refresh();
+      }
+   }
+   ovenControl.setFanDutycycle(0);
+}
+
+}; // namespace AutoTune
@@ -0,0 +1,55 @@
+/**
+ * @file    autoTune.h
+ * @brief   Automatic tuning of the PID controller (relay feedback)
+ *
+ *  The oven is cycled around TUNE_SETPOINT by switching the heater (see RelayTuner).
+ *  The identified model and PID gains are shown on the LCD and may be saved to
+ *  pidKp/pidKi/pidKd and the feed-forward model (ovenGain, ovenTimeConstant, feedForwardLead).
+ *  The last result is available remotely (TUNE?).
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+
+#ifndef SOURCES_AUTOTUNE_H_
+#define SOURCES_AUTOTUNE_H_
+
+#include "relayTuner.h"
+
+namespace AutoTune {
+
+/** Temperature the oven is cycled around (Celsius) */
+constexpr float TUNE_SETPOINT   = 150;
+
+/** Heater while below set-point (%) */
+constexpr float TUNE_HIGH       = 100;
+
+/** Heater while above set-point (%) */
+constexpr float TUNE_LOW        = 0;
+
+/** Relay hysteresis (Celsius) */
+constexpr float TUNE_HYSTERESIS = 1;
+
+/** Maximum time for tuning (s) */
+constexpr float TUNE_TIMEOUT    = 3600;
+
+/**
+ * Run auto-tuning interactively\n
+ * Doesn't return until complete
+ */
+extern void run();
+
+/**
+ * Get result of last successful tuning\n
+ * Lock-free - may be called from any thread
+ *
+ * @param[out] result Result
+ *
+ * @return true  Result available
+ * @return false No tuning has completed since reset
+ */
+extern bool getLastResult(RelayTuner::Result &result);
+
+}; // namespace AutoTune
+
+#endif /* SOURCES_AUTOTUNE_H_ */
@@ -0,0 +1,374 @@
+/**
+ * @file    calibration.cpp
+ * @brief   Two-point gain/offset calibration of the thermocouples
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <math.h>
+#include "calibration.h"
+#include "configCache.h"
+#include "configure.h"
+#include "messageBox.h"
+
+using namespace USBDM;
+
+/** Calibration of each thermocouple in nonvolatile memory */
+__attribute__ ((section(".flexRAM_v1")))
+static NvCalibration calibrations[Calibration::NUM_CHANNELS];
+
+namespace Calibration {
+
+/** Number of measurements averaged at each calibration point */
+static constexpr unsigned MEASUREMENTS = 20;
+
+/** Fan is left running until the oven is below this temperature or the user acknowledges */
+static constexpr float COOL_TEMPERATURE = 50.0f;
+
+/**
+ * Get calibration of a thermocouple in nonvolatile memory
+ *
+ * @param[in] channel Index of thermocouple
+ *
+ * @return Calibration
+ */
+NvCalibration &getCalibration(unsigned channel) {
+   usbdm_assert(channel<NUM_CHANNELS, "Illegal thermocouple");
+   return calibrations[channel];
+}
+
+/**
+ * Get calibration of a thermocouple as a consistent snapshot (see configLock)
+ *
+ * @param[in]  channel Index of thermocouple
+ * @param[out] gain    Gain
+ * @param[out] offset  Offset (Celsius)
+ */
+void get(unsigned channel, float &gain, float &offset) {
+   const NvCalibration &calibration = getCalibration(channel);
+   int32_t rawGain, rawOffset;
+   uint32_t sequence;
+   do {
+      sequence  = configLock.beginRead();
+      rawGain   = calibration.gain;
+      rawOffset = calibration.offset;
+   } while (configLock.retryRead(sequence));
+   gain   = (float)rawGain/NvCalibration::GAIN_SCALE;
+   offset = (float)rawOffset/NvCalibration::OFFSET_SCALE;
+}
+
+/**
+ * Set calibration of a thermocouple\n
+ * The caller must hold interactiveMutex.
+ *
+ * @param[in] channel Index of thermocouple
+ * @param[in] gain    Gain (MIN_GAIN..MAX_GAIN)
+ * @param[in] offset  Offset (Celsius, +/-MAX_OFFSET)
+ *
+ * @return true  Calibration changed
+ * @return false Illegal channel, gain or offset
+ */
+bool set(unsigned channel, float gain, float offset) {
+   if ((channel >= NUM_CHANNELS) ||
+       !(gain >= MIN_GAIN) || !(gain <= MAX_GAIN) || !(fabsf(offset) <= MAX_OFFSET)) {
+      return false;
+   }
+   NvCalibration &calibration = getCalibration(channel);
+   SeqLock::WriteScope ws(configLock);
+   FlexRamTransaction::Scope transaction;
+   calibration.gain   = (int32_t)roundf(gain*NvCalibration::GAIN_SCALE);
+   calibration.offset = (int32_t)roundf(offset*NvCalibration::OFFSET_SCALE);
+   return true;
+}
+
+/**
+ * Calculate calibration from two points
+ *
+ * @param[in]  measured1   Linearised reading at first point (Celsius)
+ * @param[in]  reference1  True temperature at first point (Celsius)
+ * @param[in]  measured2   Linearised reading at second point (Celsius)
+ * @param[in]  reference2  True temperature at second point (Celsius)
+ * @param[out] gain        Gain
+ * @param[out] offset      Offset (Celsius)
+ *
+ * @return true  Calibration is within the allowed range
+ * @return false Points are too close or calibration is out of range
+ */
+bool calculate(float measured1, float reference1, float measured2, float reference2, float &gain, float &offset) {
+   if (!(fabsf(measured2-measured1) >= MIN_SPAN)) {
+      // Too close (or NAN)
+      return false;
+   }
+   gain   = (reference2-reference1)/(measured2-measured1);
+   offset = reference1 - gain*measured1;
+   return (gain >= MIN_GAIN) && (gain <= MAX_GAIN) && (fabsf(offset) <= MAX_OFFSET);
+}
+
+/**
+ * Reset all thermocouples to unity gain and zero offset\n
+ * The caller must hold a write scope on configLock (see Settings::initialiseSettings()).
+ */
+void reset() {
+   for (NvCalibration &calibration:calibrations) {
+      calibration.gain   = NvCalibration::GAIN_SCALE;
+      calibration.offset = 0;
+   }
+}
+
+/**
+ * Display current readings of the thermocouples
+ *
+ * @param[in] y Vertical position of first line
+ */
+static void displayReadings(int y) {
+   for (unsigned t=0; t<NUM_CHANNELS; t++) {
+      lcd.gotoXY((t&1)?(lcd.LCD_WIDTH/2):0, y+(t/2)*lcd.FONT_HEIGHT);
+      Max31855 &thermocouple = temperatureSensors.getThermocouple(t);
+      lcd.write("T").write(t+1).write("=");
+      if (thermocouple.isEnabled()) {
+         lcd.write(thermocouple.getLastUncalibrated()).write("\x7F");
+      }
+      else {
+         lcd.write("----");
+      }
+   }
+}
+
+/**
+ * Get temperature from user
+ *
+ * @param[in]     title   Title for screen
+ * @param[in]     prompt  Prompt (may be several lines)
+ * @param[in,out] value   Value to adjust (Celsius)
+ */
+static void enterTemperature(const char *title, const char *prompt, float &value) {
+   bool changed = true;
+   for(;;) {
+      if (changed) {
+         lcd.setInversion(false); lcd.clearFrameBuffer();
+         lcd.setInversion(true);  lcd.write(" ").write(title).write(" \n"); lcd.setInversion(false);
+         lcd.write(prompt).write("\n\n");
+         lcd.write("  ").write(value).write("\x7F");
+
+         lcd.gotoXY(0, lcd.LCD_HEIGHT-lcd.FONT_HEIGHT);
+         lcd.setInversion(true);  lcd.write("+1");  lcd.setInversion(false); lcd.putSpace(5);
+         lcd.setInversion(true);  lcd.write("-1");  lcd.setInversion(false); lcd.putSpace(5);
+         lcd.setInversion(true);  lcd.write("+.1"); lcd.setInversion(false); lcd.putSpace(5);
+         lcd.setInversion(true);  lcd.write("-.1"); lcd.setInversion(false); lcd.putSpace(5);
+         lcd.setInversion(true);  lcd.write(" OK "); lcd.setInversion(false);
+         lcd.refreshImage();
+         lcd.setGraphicMode();
+         changed = false;
+      }
+      switch(buttons.getButton()) {
+      case SwitchValue::SW_F1: value += 1.0f;  changed = true; break;
+      case SwitchValue::SW_F2: value -= 1.0f;  changed = true; break;
+      case SwitchValue::SW_F3: value += 0.1f;  changed = true; break;
+      case SwitchValue::SW_F4: value -= 0.1f;  changed = true; break;
+      case SwitchValue::SW_S:  return;
+      default: break;
+      }
+   }
+}
+
+/**
+ * Measure linearised readings of all enabled thermocouples\n
+ * Readings are averaged over MEASUREMENTS measurements.
+ *
+ * @param[out] readings Average readings (NAN for unusable thermocouples)
+ */
+static void measure(float readings[NUM_CHANNELS]) {
+   unsigned counts[NUM_CHANNELS] = {};
+   for (unsigned t=0; t<NUM_CHANNELS; t++) {
+      readings[t] = 0;
+   }
+   for (unsigned measurement=0; measurement<MEASUREMENTS; measurement++) {
+      lcd.setInversion(false); lcd.clearFrameBuffer();
+      lcd.setInversion(true);  lcd.write(" Calibration \n"); lcd.setInversion(false);
+      lcd.write("Measuring ").write(measurement+1).write("/").write(MEASUREMENTS);
+      temperatureSensors.updateMeasurements();
+      displayReadings(3*lcd.FONT_HEIGHT);
+      lcd.refreshImage();
+      lcd.setGraphicMode();
+      for (unsigned t=0; t<NUM_CHANNELS; t++) {
+         Max31855 &thermocouple = temperatureSensors.getThermocouple(t);
+         float reading = thermocouple.getLastUncalibrated();
+         if (thermocouple.isEnabled() && !std::isnan(reading)) {
+            readings[t] += reading;
+            counts[t]++;
+         }
+      }
+      osDelay(250);
+   }
+   for (unsigned t=0; t<NUM_CHANNELS; t++) {
+      // All measurements must be good
+      readings[t] = (counts[t] == MEASUREMENTS)?(readings[t]/MEASUREMENTS):NAN;
+   }
+}
+
+/**
+ * Heat oven to HIGH_POINT and hold until the user indicates the reference is steady\n
+ * The heater is turned off if the thermocouples fail or after maxHeaterTime as in manual mode.
+ *
+ * @return true  User accepted
+ * @return false User cancelled, thermocouples failed or heater time exceeded
+ */
+static bool heatToHighPoint() {
+   pid.setSetpoint(HIGH_POINT);
+   pid.enable(true);
+   for(;;) {
+      /**
+       * Safety check
+       * Turn off if no usable thermocouples or after maxHeaterTime of operation
+       */
+      if (std::isnan(temperatureSensors.getLastTemperature()) || (pid.getElapsedTime()>=maxHeaterTime)) {
+         pid.enable(false);
+         ovenControl.setHeaterDutycycle(0);
+         return false;
+      }
+      lcd.setInversion(false); lcd.clearFrameBuffer();
+      lcd.setInversion(true);  lcd.write(" Calibration \n"); lcd.setInversion(false);
+      lcd.write("Heating to ").write(HIGH_POINT).write("\x7F\n");
+      lcd.write("Oven ").write(temperatureSensors.getLastTemperature()).write("\x7F");
+      displayReadings(3*lcd.FONT_HEIGHT);
+
+      lcd.gotoXY(0, lcd.LCD_HEIGHT-lcd.FONT_HEIGHT);
+      lcd.write("Steady?");
+      lcd.gotoXY(lcd.LCD_WIDTH-lcd.FONT_WIDTH*11-6, lcd.LCD_HEIGHT-lcd.FONT_HEIGHT);
+      lcd.setInversion(true); lcd.write("Stop");  lcd.setInversion(false); lcd.putSpace(6);
+      lcd.setInversion(true); lcd.write(" OK "); lcd.setInversion(false);
+      lcd.refreshImage();
+      lcd.setGraphicMode();
+
+      switch(buttons.getButton(500)) {
+      case SwitchValue::SW_F4: return false;
+      case SwitchValue::SW_S:  return true;
+      default: break;
+      }
+   }
+}
+
+/**
+ * Run fan until the oven is below COOL_TEMPERATURE or the user acknowledges\n
+ * The heater must already be off with the fan running.
+ */
+static void coolDown() {
+   for(;;) {
+      temperatureSensors.updateMeasurements();
+      if (temperatureSensors.getLastTemperature() < COOL_TEMPERATURE) {
+         break;
+      }
+      lcd.setInversion(false); lcd.clearFrameBuffer();
+      lcd.setInversion(true);  lcd.write(" Calibration \n"); lcd.setInversion(false);
+      lcd.write("Cooling\n");
+      lcd.write("Oven ").write(temperatureSensors.getLastTemperature()).write("\x7F");
+      displayReadings(3*lcd.FONT_HEIGHT);
+
+      lcd.gotoXY(lcd.LCD_WIDTH-lcd.FONT_WIDTH*4-1, lcd.LCD_HEIGHT-lcd.FONT_HEIGHT);
+      lcd.setInversion(true); lcd.write(" OK "); lcd.setInversion(false);
+      lcd.refreshImage();
+      lcd.setGraphicMode();
+
+      if (buttons.getButton(500) == SwitchValue::SW_S) {
+         break;
+      }
+   }
+   ovenControl.setFanDutycycle(0);
+}
+
+/**
+ * Run two-point calibration interactively\n
+ * Doesn't return until complete
+ */
+void run() {
+   if (!checkThermocouples()) {
+      return;
+   }
+   if (messageBox("Calibration",
+         "1: Probes in\n"
+         "   boiling water\n"
+         "2: Probes in oven\n"
+         "   with reference",
+         MSG_OK_CANCEL) != MSG_IS_OK) {
+      return;
+   }
+   // Low point - boiling water
+   if (messageBox("Calibration",
+         "Place probes in\n"
+         "boiling water\n\n"
+         "OK when steady",
+         MSG_OK_CANCEL) != MSG_IS_OK) {
+      return;
+   }
+   float measured1[NUM_CHANNELS];
+   measure(measured1);
+   float reference1 = LOW_POINT;
+   enterTemperature("Low point", "Water temperature\n(100 at sea level)", reference1);
+
+   // High point - oven with reference thermometer
+   if (messageBox("Calibration",
+         "Place probes and\n"
+         "reference probe\n"
+         "together in oven",
+         MSG_OK_CANCEL) != MSG_IS_OK) {
+      return;
+   }
+   float measured2[NUM_CHANNELS];
+   bool accepted = heatToHighPoint();
+   if (accepted) {
+      measure(measured2);
+   }
+   // Cool oven
+   pid.enable(false);
+   pid.setSetpoint(0);
+   ovenControl.setHeaterDutycycle(0);
+   ovenControl.setFanDutycycle(100);
+   Buzzer::play();
+
+   if (!accepted) {
+      coolDown();
+      return;
+   }
+   float reference2 = HIGH_POINT;
+   enterTemperature("High point", "Reference reading", reference2);
+
+   // Calculate and show results
+   float gain[NUM_CHANNELS];
+   float offset[NUM_CHANNELS];
+   bool  valid[NUM_CHANNELS];
+   bool  anyValid = false;
+   StringFormatter_T<100> sf;
+   sf.setFloatFormat(3);
+   for (unsigned t=0; t<NUM_CHANNELS; t++) {
+      if (std::isnan(measured1[t]) || std::isnan(measured2[t])) {
+         valid[t] = false;
+         continue;
+      }
+      valid[t] = calculate(measured1[t], reference1, measured2[t], reference2, gain[t], offset[t]);
+      sf.write("T").write(t+1);
+      if (valid[t]) {
+         sf.write(" G=").write(gain[t]).write(" O=").write(offset[t]).write('\n');
+         anyValid = true;
+      }
+      else {
+         sf.write(" out of range\n");
+      }
+   }
+   if (!anyValid) {
+      messageBox("Calibration", "Calibration failed\n\nProbes not usable\nor out of range");
+   }
+   else if (messageBox("Save calibration?", sf.toString(), MSG_YES_NO) == MSG_IS_YES) {
+      for (unsigned t=0; t<NUM_CHANNELS; t++) {
+         if (valid[t]) {
+            set(t, gain[t], offset[t]);
+            // Manual offset is replaced by calibration
+            SeqLock::WriteScope ws(configLock);
+            temperatureSensors.getThermocouple(t).setOffset(0);
+         }
+      }
+      ConfigCache::refresh();
+   }
+   coolDown();
+}
+
+}; // namespace Calibration
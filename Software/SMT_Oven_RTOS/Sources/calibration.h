@@ -0,0 +1,133 @@
+/**
+ * @file    calibration.h
+ * @brief   Two-point gain/offset calibration of the thermocouples
+ *
+ *  Each thermocouple has a gain and offset held in fixed-point in nonvolatile memory:
+ *
+ *   T = gain * Tlinearised + offset
+ *
+ *  where Tlinearised is the ITS-90 corrected MAX31855 reading. The manual offset setting
+ *  (Thermo n Offset) is still added after calibration.
+ *
+ *  The guided procedure (run()) measures the probes at two known temperatures
+ *  (boiling water and a reference thermometer in the oven near reflow temperature)
+ *  and calculates the gain and offset from the two points.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+
+#ifndef SOURCES_CALIBRATION_H_
+#define SOURCES_CALIBRATION_H_
+
+#include <stdint.h>
+#include "flash.h"
+
+/**
+ * Calibration of a thermocouple in nonvolatile memory
+ */
+class NvCalibration {
+public:
+   /** Scale of gain (Q16.16) */
+   static constexpr int32_t GAIN_SCALE   = 1<<16;
+
+   /** Scale of offset (0.01 Celsius) */
+   static constexpr int32_t OFFSET_SCALE = 100;
+
+   USBDM::Nonvolatile<int32_t> gain;     // Gain scaled by GAIN_SCALE
+   USBDM::Nonvolatile<int32_t> offset;   // Offset scaled by OFFSET_SCALE
+
+   /**
+    * Apply calibration to a temperature
+    *
+    * @param[in] temperature Linearised temperature (Celsius)
+    *
+    * @return Calibrated temperature (Celsius)
+    */
+   float apply(float temperature) const {
+      return temperature*((int32_t)gain*(1.0f/GAIN_SCALE)) + (int32_t)offset*(1.0f/OFFSET_SCALE);
+   }
+};
+
+namespace Calibration {
+
+/** Number of thermocouples calibrated */
+constexpr unsigned NUM_CHANNELS = 4;
+
+/** Range allowed for gain */
+constexpr float MIN_GAIN   = 0.8f;
+constexpr float MAX_GAIN   = 1.2f;
+
+/** Range allowed for offset (Celsius) */
+constexpr float MAX_OFFSET = 50.0f;
+
+/** Minimum separation of calibration points (Celsius) */
+constexpr float MIN_SPAN   = 50.0f;
+
+/** Default temperature of low point - boiling water at sea level (Celsius) */
+constexpr float LOW_POINT  = 100.0f;
+
+/** Oven temperature for high point (Celsius) */
+constexpr float HIGH_POINT = 230.0f;
+
+/**
+ * Get calibration of a thermocouple in nonvolatile memory
+ *
+ * @param[in] channel Index of thermocouple
+ *
+ * @return Calibration
+ */
+NvCalibration &getCalibration(unsigned channel);
+
+/**
+ * Get calibration of a thermocouple as a consistent snapshot (see configLock)
+ *
+ * @param[in]  channel Index of thermocouple
+ * @param[out] gain    Gain
+ * @param[out] offset  Offset (Celsius)
+ */
+void get(unsigned channel, float &gain, float &offset);
+
+/**
+ * Set calibration of a thermocouple\n
+ * The caller must hold interactiveMutex.
+ *
+ * @param[in] channel Index of thermocouple
+ * @param[in] gain    Gain (MIN_GAIN..MAX_GAIN)
+ * @param[in] offset  Offset (Celsius, +/-MAX_OFFSET)
+ *
+ * @return true  Calibration changed
+ * @return false Illegal channel, gain or offset
+ */
+bool set(unsigned channel, float gain, float offset);
+
+/**
+ * Calculate calibration from two points
+ *
+ * @param[in]  measured1   Linearised reading at first point (Celsius)
+ * @param[in]  reference1  True temperature at first point (Celsius)
+ * @param[in]  measured2   Linearised reading at second point (Celsius)
+ * @param[in]  reference2  True temperature at second point (Celsius)
+ * @param[out] gain        Gain
+ * @param[out] offset      Offset (Celsius)
+ *
+ * @return true  Calibration is within the allowed range
+ * @return false Points are too close or calibration is out of range
+ */
+bool calculate(float measured1, float reference1, float measured2, float reference2, float &gain, float &offset);
+
+/**
+ * Reset all thermocouples to unity gain and zero offset\n
+ * The caller must hold a write scope on configLock (see Settings::initialiseSettings()).
+ */
+void reset();
+
+/**
+ * Run two-point calibration interactively\n
+ * Doesn't return until complete
+ */
+void run();
+
+}; // namespace Calibration
+
+#endif /* SOURCES_CALIBRATION_H_ */
@@ -0,0 +1,71 @@
+/**
+ * @file    configCache.cpp
+ * @brief   RAM snapshot of the settings used by the control loop
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include "configCache.h"
+#include "configure.h"
+#include "settings.h"
+
+namespace ConfigCache {
+
+/** Snapshots - one is current, the other is built by refresh() */
+static Snapshot snapshots[2];
+
+/** Current snapshot */
+static const Snapshot *volatile current = &snapshots[0];
+
+/**
+ * Get current snapshot\n
+ * Lock-free and does not access nonvolatile memory - may be called from any thread
+ *
+ * @return Snapshot
+ */
+const Snapshot &get() {
+   return *current;
+}
+
+/**
+ * Take a new snapshot of the settings\n
+ * Call after changing any setting in the snapshot.
+ * The caller must hold interactiveMutex and must not hold a write scope on configLock.
+ */
+void refresh() {
+   const Snapshot *previous = current;
+   Snapshot &next = (previous == &snapshots[0])?snapshots[1]:snapshots[0];
+
+   uint32_t sequence;
+   do {
+      sequence = configLock.beginRead();
+
+      next.minimumFanSpeed  = minimumFanSpeed;
+      next.pid.kp           = pidKp;
+      next.pid.ki           = pidKi;
+      next.pid.kd           = pidKd;
+      for (unsigned index=0; index<GainSchedule::NUM_STATES; index++) {
+         Gains &gains = next.gains[index];
+         GainSchedule::getGains((State)(GainSchedule::FIRST_STATE+index), gains.kp, gains.ki, gains.kd);
+      }
+      next.ovenGain         = ovenGain;
+      next.ovenTimeConstant = ovenTimeConstant;
+      next.feedForwardLead  = feedForwardLead;
+      next.faultHoldSamples = faultHoldSamples;
+      next.weights[0]       = t1Weight;
+      next.weights[1]       = t2Weight;
+      next.weights[2]       = t3Weight;
+      next.weights[3]       = t4Weight;
+      for (unsigned index=0; index<NUM_PROBES; index++) {
+         next.probes[index] = temperatureSensors.getThermocouple(index).getSettings();
+      }
+   } while (configLock.retryRead(sequence));
+
+   next.version = previous->version+1;
+
+   // Snapshot must be complete before it is published
+   __DMB();
+   current = &next;
+}
+
+}; // namespace ConfigCache
@@ -0,0 +1,75 @@
+/**
+ * @file    configCache.h
+ * @brief   RAM snapshot of the settings used by the control loop
+ *
+ *  Reading a Nonvolatile variable waits for any EEPROM update in progress so reading
+ *  settings directly from the PID and profile timers makes their timing depend on
+ *  background writes.
+ *
+ *  Instead the settings used by these paths are copied to an immutable snapshot in RAM.
+ *  A new snapshot is taken when a run starts and after settings are changed (refresh()).
+ *  It is built in a spare buffer and then published by changing a pointer so readers
+ *  always see a complete snapshot without locking.
+ *
+ *  Readers should get the snapshot once per operation and not keep it across blocking calls.
+ *  A snapshot is only re-used by the refresh after the one that replaced it.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+
+#ifndef SOURCES_CONFIGCACHE_H_
+#define SOURCES_CONFIGCACHE_H_
+
+#include <stdint.h>
+#include "gainSchedule.h"
+#include "max31855.h"
+
+namespace ConfigCache {
+
+/** Number of thermocouples in snapshot */
+constexpr unsigned NUM_PROBES = 4;
+
+/**
+ * PID gains for a phase (global gains substituted for unscheduled phases)
+ */
+struct Gains {
+   float kp;   // Proportional gain
+   float ki;   // Integral gain
+   float kd;   // Differential gain
+};
+
+/**
+ * Settings used by the control loop
+ */
+struct Snapshot {
+   uint32_t                version;            // Incremented each time a snapshot is taken
+   int                     minimumFanSpeed;    // Minimum fan speed (%)
+   Gains                   pid;                // Global PID gains
+   Gains                   gains[GainSchedule::NUM_STATES]; // Gains for s_preheat..s_ramp_down
+   float                   ovenGain;           // Thermal model gain (Celsius/%, 0 => no feed-forward)
+   float                   ovenTimeConstant;   // Thermal model time constant (s)
+   float                   feedForwardLead;    // Feed-forward look-ahead (s)
+   unsigned                faultHoldSamples;   // Faulty measurements to hold last good temperature
+   float                   weights[NUM_PROBES];// Relative weight of each thermocouple (%)
+   Max31855::ProbeSettings probes[NUM_PROBES]; // Enable and calibration of each thermocouple
+};
+
+/**
+ * Get current snapshot\n
+ * Lock-free and does not access nonvolatile memory - may be called from any thread
+ *
+ * @return Snapshot
+ */
+const Snapshot &get();
+
+/**
+ * Take a new snapshot of the settings\n
+ * Call after changing any setting in the snapshot.
+ * The caller must hold interactiveMutex and must not hold a write scope on configLock.
+ */
+void refresh();
+
+}; // namespace ConfigCache
+
+#endif /* SOURCES_CONFIGCACHE_H_ */
@@ -6,6 +6,7 @@
  *      Author: podonoghue
  */
 
+#include "configCache.h"
 #include "configure.h"
 #include "settings.h"
 
@@ -14,6 +15,9 @@
 /** Mutex to protect Interactive and Remote control */
 CMSIS::Mutex interactiveMutex;
 
+/** Sequence lock for snapshot reads of settings */
+SeqLock configLock;
+
 /** SPI used for LCD and Thermocouples */
 USBDM::Spi0 spi;
 
@@ -26,6 +30,9 @@ ZeroCrossingPwm <Heater, HeaterLed, OvenFan, OvenFanLed, Vmains> ovenControl{fan
 /** Switch debouncer for front panel buttons */
 SwitchDebouncer<F1Button, F2Button, F3Button, F4Button, SButton> buttons{};
 
+/** Minimum fan speed requested by the program being run (Fan step, percent) */
+volatile int programFanSpeed = 0;
+
 /**
  * Set output controlling oven
  *
@@ -36,15 +43,19 @@ void outPutControl(float dutyCycle) {
    int heaterDutycycle;
    int fanDutycycle;
 
+   int minimumFan = ConfigCache::get().minimumFanSpeed;
+   if (programFanSpeed>minimumFan) {
+      minimumFan = programFanSpeed;
+   }
    if (dutyCycle>=0) {
       heaterDutycycle = dutyCycle;
-      fanDutycycle    = minimumFanSpeed;
+      fanDutycycle    = minimumFan;
    }
    else {
       heaterDutycycle = 0;
       fanDutycycle    = -dutyCycle;
-      if (fanDutycycle<minimumFanSpeed) {
-         fanDutycycle = minimumFanSpeed;
+      if (fanDutycycle<minimumFan) {
+         fanDutycycle = minimumFan;
          heaterDutycycle = 10;
       }
    }
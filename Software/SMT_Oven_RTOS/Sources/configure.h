@@ -51,6 +51,7 @@ public:
 #include "pid.h"
 #include "settings.h"
 #include "runProfile.h"
+#include "seqLock.h"
 
 /** SPI_PCSx signals for SPI connected to LCD and Thermocouples */
 static constexpr USBDM::SpiPeripheralSelect lcd_cs = USBDM::SpiPeripheralSelect_4;
@@ -184,6 +185,12 @@ extern CaseTemperatureMonitor<CaseFan> caseTemperatureMonitor;
  */
 extern float getTemperature();
 
+/**
+ * Minimum fan speed requested by the program being run (Fan step, percent)\n
+ * The fan runs at the larger of this and minimumFanSpeed.
+ */
+extern volatile int programFanSpeed;
+
 /**
  * Set heater drive level (for PID)
  */
@@ -199,4 +206,11 @@ extern Pid_T<getTemperature, outPutControl> pid;
  */
 extern CMSIS::Mutex interactiveMutex;
 
+/**
+ * Sequence lock allowing remote queries to take consistent snapshots of the
+ * profiles, thermocouple and PID settings.\n
+ * Writers hold interactiveMutex and bracket each change with configLock.
+ */
+extern SeqLock configLock;
+
 #endif /* SOURCES_CONFIGURE_H_ */
@@ -70,6 +70,8 @@ bool copyProfile(unsigned sourceIndex, unsigned destinationIndex) {
    rc = messageBox("Overwrite Profile", sf.toString(), MSG_YES_NO);
    if (rc == MSG_IS_YES) {
       // Update profile in NV ram
+      SeqLock::WriteScope ws(configLock);
+      FlexRamTransaction::Scope transaction;
       profiles[destinationIndex] = profiles[sourceIndex];
       profiles[destinationIndex].flags = profiles[destinationIndex].flags | P_UNLOCKED;
       return true;
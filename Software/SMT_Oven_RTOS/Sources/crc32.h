@@ -0,0 +1,42 @@
+/**
+ * @file    crc32.h
+ * @brief   CRC-32 (IEEE 802.3) calculation
+ *
+ *  Uses a 16 entry (nibble) table to keep ROM use small.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+
+#ifndef SOURCES_CRC32_H_
+#define SOURCES_CRC32_H_
+
+#include <stdint.h>
+
+/**
+ * Calculate CRC-32 of a block of memory\n
+ * A CRC may be calculated in parts by passing the CRC of the earlier parts.
+ *
+ * @param[in] data Data to include (may be FlexRAM or Flash)
+ * @param[in] size Number of bytes
+ * @param[in] crc  CRC of preceding data
+ *
+ * @return CRC
+ */
+inline uint32_t crc32(const volatile void *data, unsigned size, uint32_t crc=0) {
+   // CRC of each nibble value
+   static const uint32_t table[16] = {
+         0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+         0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+   };
+   const volatile uint8_t *p = static_cast<const volatile uint8_t *>(data);
+   crc = ~crc;
+   while (size-- > 0) {
+      crc ^= *p++;
+      crc  = (crc>>4)^table[crc&0xF];
+      crc  = (crc>>4)^table[crc&0xF];
+   }
+   return ~crc;
+}
+
+#endif /* SOURCES_CRC32_H_ */
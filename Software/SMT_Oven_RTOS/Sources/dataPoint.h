@@ -11,6 +11,7 @@
 #include <math.h>
 #include <stdint.h>
 #include "Max31855.h"
+#include "sensorFusion.h"
 
 /**
  * Mode of operation within profile
@@ -127,23 +128,19 @@ public:
    }
 
    /**
-    * Calculates the average oven temperature from active recorded thermocouples
+    * Calculates the average oven temperature from active recorded thermocouples\n
+    * A robust average is used so one bad thermocouple has little effect (see SensorFusion)
     *
     * @return Average value as float or NAN if no thermocouples active
     */
    float getAverageTemperature() const {
-      float average   = 0;
-      int   numTemps = 0;
+      float temperatures[NUM_THERMOCOUPLES];
+      float weights[NUM_THERMOCOUPLES];
       for (unsigned index=0; index<NUM_THERMOCOUPLES; index++) {
-         if (getStatus(index) == Max31855::TH_ENABLED) {
-            average += fThermocouples[index];
-            numTemps++;
-         }
-      }
-      if (numTemps == 0) {
-         return NAN;
+         temperatures[index] = fThermocouples[index]/FIXED_POINT_SCALE;
+         weights[index]      = (getStatus(index) == Max31855::TH_ENABLED)?1.0f:0.0f;
       }
-      return (average/FIXED_POINT_SCALE)/numTemps;
+      return SensorFusion::robustMean(temperatures, weights, NUM_THERMOCOUPLES);
    }
 
    /**
@@ -196,7 +196,6 @@ bool EditProfile::doit() {
       default:
          break;
       }
-      __WFI();
    }
    return needsUpdate;
 }
@@ -237,6 +236,7 @@ void EditProfile::run(NvSolderProfile &nvProfile) {
             rc = messageBox("Profile changed", sf.toString(), MSG_YES_NO_CANCEL);
             if (rc == MSG_IS_YES) {
                // Update profile in NV ram
+               SeqLock::WriteScope ws(configLock);
                nvProfile = tempProfile;
             }
          }
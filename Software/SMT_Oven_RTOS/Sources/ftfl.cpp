@@ -276,4 +276,46 @@ void Flash::eraseAll() {
    }
 }
 
+/** Shadowed words */
+FlexRamTransaction::Entry FlexRamTransaction::entries[FlexRamTransaction::MAX_WORDS];
+
+/** Number of entries used */
+volatile unsigned FlexRamTransaction::count = 0;
+
+/** Nesting depth of transactions */
+volatile unsigned FlexRamTransaction::depth = 0;
+
+/** Thread that opened the outermost transaction */
+volatile osThreadId FlexRamTransaction::owner = nullptr;
+
+/** Called before changes are written */
+FlexRamTransaction::CommitCallback FlexRamTransaction::startCallback = nullptr;
+
+/** Called after changes are written */
+FlexRamTransaction::CommitCallback FlexRamTransaction::commitCallback = nullptr;
+
+/**
+ * Write shadowed words that have changed to FlexRAM and empty the shadow\n
+ * Each changed word is written as a single 32-bit record.
+ * The EEPROM emulation ignores writes while busy so each write waits for completion.
+ * The start and commit callbacks are called before and after if any word is written.
+ */
+void FlexRamTransaction::flush() {
+   bool changed = false;
+   for (unsigned index=0; index<count; index++) {
+      if (*entries[index].address != entries[index].value) {
+         if (!changed && (startCallback != nullptr)) {
+            startCallback();
+         }
+         *entries[index].address = entries[index].value;
+         Flash::waitUntilFlexIdle();
+         changed = true;
+      }
+   }
+   count = 0;
+   if (changed && (commitCallback != nullptr)) {
+      commitCallback();
+   }
+}
+
 }
@@ -0,0 +1,87 @@
+/**
+ * @file    gainSchedule.cpp
+ * @brief   PID gains scheduled by phase of the profile (State)
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <math.h>
+#include "configure.h"
+#include "gainSchedule.h"
+#include "settings.h"
+
+/** Gains for each scheduled state in nonvolatile memory */
+__attribute__ ((section(".flexRAM_v1")))
+static NvPidGains gainTable[GainSchedule::NUM_STATES];
+
+namespace GainSchedule {
+
+/**
+ * Get gains to use for a state\n
+ * The table is read as a consistent snapshot (see configLock).
+ *
+ * @param[in]  state State (s_preheat..s_ramp_down, other states get global gains)
+ * @param[out] kp    Proportional gain
+ * @param[out] ki    Integral gain
+ * @param[out] kd    Differential gain
+ */
+void getGains(State state, float &kp, float &ki, float &kd) {
+   uint32_t sequence;
+   do {
+      sequence = configLock.beginRead();
+      kp = 0;
+      if (isScheduled(state)) {
+         const NvPidGains &gains = gainTable[state-FIRST_STATE];
+         kp = gains.kp;
+         ki = gains.ki;
+         kd = gains.kd;
+      }
+      if (!(kp > 0)) {
+         // Use global gains
+         kp = pidKp;
+         ki = pidKi;
+         kd = pidKd;
+      }
+   } while (configLock.retryRead(sequence));
+}
+
+/**
+ * Set gains for a state\n
+ * The caller must hold interactiveMutex.
+ *
+ * @param[in] state State (s_preheat..s_ramp_down)
+ * @param[in] kp    Proportional gain (0 => use global gains)
+ * @param[in] ki    Integral gain
+ * @param[in] kd    Differential gain
+ *
+ * @return true  Gains changed
+ * @return false Illegal state or gains
+ */
+bool setGains(State state, float kp, float ki, float kd) {
+   if (!isScheduled(state) ||
+       !isfinite(kp) || !isfinite(ki) || !isfinite(kd) ||
+       (kp < 0) || (ki < 0) || (kd < 0)) {
+      return false;
+   }
+   SeqLock::WriteScope ws(configLock);
+   USBDM::FlexRamTransaction::Scope transaction;
+   NvPidGains &gains = gainTable[state-FIRST_STATE];
+   gains.kp = kp;
+   gains.ki = ki;
+   gains.kd = kd;
+   return true;
+}
+
+/**
+ * Reset all states to use the global gains\n
+ * The caller must hold a write scope on configLock (see Settings::initialiseSettings()).
+ */
+void reset() {
+   for (NvPidGains &gains:gainTable) {
+      gains.kp = 0.0f;
+      gains.ki = 0.0f;
+      gains.kd = 0.0f;
+   }
+}
+
+}; // namespace GainSchedule
@@ -0,0 +1,84 @@
+/**
+ * @file    gainSchedule.h
+ * @brief   PID gains scheduled by phase of the profile (State)
+ *
+ *  Each phase from s_preheat to s_ramp_down may have its own PID gains.
+ *  A phase with Kp = 0 uses the global gains (pidKp, pidKi, pidKd) so the
+ *  factory table behaves exactly as a single set of gains.
+ *
+ *  RunProfile changes gains bumplessly (Pid_T::setTuningsBumpless()) whenever the
+ *  reported State changes.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+
+#ifndef SOURCES_GAINSCHEDULE_H_
+#define SOURCES_GAINSCHEDULE_H_
+
+#include "flash.h"
+#include "dataPoint.h"
+
+/**
+ * PID gains for a phase in nonvolatile memory
+ */
+class NvPidGains {
+public:
+   USBDM::Nonvolatile<float> kp;   // Proportional gain (0 => use global gains)
+   USBDM::Nonvolatile<float> ki;   // Integral gain
+   USBDM::Nonvolatile<float> kd;   // Differential gain
+};
+
+namespace GainSchedule {
+
+/** First state that has scheduled gains */
+constexpr State FIRST_STATE = s_preheat;
+
+/** Number of states with scheduled gains (s_preheat..s_ramp_down) */
+constexpr unsigned NUM_STATES = s_ramp_down-s_preheat+1;
+
+/**
+ * Check if a state has scheduled gains
+ *
+ * @param[in] state State to check
+ *
+ * @return true if state is s_preheat..s_ramp_down
+ */
+constexpr bool isScheduled(State state) {
+   return (state >= FIRST_STATE) && ((unsigned)(state-FIRST_STATE) < NUM_STATES);
+}
+
+/**
+ * Get gains to use for a state\n
+ * The table is read as a consistent snapshot (see configLock).
+ *
+ * @param[in]  state State (s_preheat..s_ramp_down, other states get global gains)
+ * @param[out] kp    Proportional gain
+ * @param[out] ki    Integral gain
+ * @param[out] kd    Differential gain
+ */
+void getGains(State state, float &kp, float &ki, float &kd);
+
+/**
+ * Set gains for a state\n
+ * The caller must hold interactiveMutex.
+ *
+ * @param[in] state State (s_preheat..s_ramp_down)
+ * @param[in] kp    Proportional gain (0 => use global gains)
+ * @param[in] ki    Integral gain
+ * @param[in] kd    Differential gain
+ *
+ * @return true  Gains changed
+ * @return false Illegal state or gains
+ */
+bool setGains(State state, float kp, float ki, float kd);
+
+/**
+ * Reset all states to use the global gains\n
+ * The caller must hold a write scope on configLock (see Settings::initialiseSettings()).
+ */
+void reset();
+
+}; // namespace GainSchedule
+
+#endif /* SOURCES_GAINSCHEDULE_H_ */
@@ -6,6 +6,8 @@
  */
 #include "lcd_st7920.h"
 #include "string.h"
+#include "statistics.h"
+#include "trace.h"
 
 /**
  * Write command to LCD
@@ -21,6 +23,7 @@ void LCD_ST7920::writeCommand(uint8_t value) {
    spi.startTransaction(spiConfig);
    spi.txRx(sizeof(data), data);
    spi.endTransaction();
+   Statistics::spiBytes.add(sizeof(data));
    USBDM::waitUS(EXECUTE_TIME_US);
 }
 
@@ -38,6 +41,7 @@ void LCD_ST7920::writeData(uint8_t value) {
    spi.startTransaction(spiConfig);
    spi.txRx(sizeof(data), data);
    spi.endTransaction();
+   Statistics::spiBytes.add(sizeof(data));
    USBDM::waitUS(EXECUTE_TIME_US);
 }
 
@@ -148,6 +152,9 @@ LCD_ST7920 &LCD_ST7920::clearFrameBuffer() {
  * Refreshes LCD from frame buffer
  */
 LCD_ST7920 &LCD_ST7920::refreshImage() {
+   TRACE_SCOPE("lcd");
+
+   uint32_t startTime = Statistics::timeStamp();
 
    // Set Extended instructions
    writeCommand(0b110110);
@@ -172,6 +179,8 @@ LCD_ST7920 &LCD_ST7920::refreshImage() {
    }
    // Set Basic instructions
    writeCommand(0b110000);
+
+   Statistics::lcdRefreshTime.add(Statistics::ticksToMicroseconds(Statistics::timeStamp()-startTime));
    return *this;
 }
 
@@ -0,0 +1,98 @@
+/**
+ * @file    lowPower.cpp
+ * @brief   Tickless idle using the LPTMR
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include "lptmr.h"
+#include "smc.h"
+#include "lowPower.h"
+
+using namespace USBDM;
+
+namespace LowPower {
+
+/** LPTMR count rate - OSCERCLK (8 MHz crystal) / 128 = 62.5 kHz */
+static constexpr LptmrPrescale PRESCALE = LptmrPrescale_128;
+
+/** LPTMR counts in 2 ms */
+static constexpr uint32_t COUNTS_PER_2MS = 125;
+
+/** Longest sleep in ms - limited by the 16-bit counter */
+static constexpr uint32_t MAX_SLEEP = 1000;
+
+static_assert(((MAX_SLEEP*COUNTS_PER_2MS)/2) <= 65536, "Sleep too long for LPTMR");
+
+/** Time slept but not yet added to RTX time (in half counts) */
+static uint32_t partialCounts = 0;
+
+/** Indicates the LPTMR has been configured */
+static volatile bool ready = false;
+
+/**
+ * Call-back from LPTMR\n
+ * The flag is normally cleared by lowPowerSleep() before the interrupt is taken
+ */
+static void wakeup() {
+}
+
+/**
+ * Configure the LPTMR used to time sleeps\n
+ * The idle demon only sleeps with the tick suspended after this is called.
+ */
+void initialise() {
+   Lptmr0::enable();
+
+   // Timer is left disabled until used
+   Lptmr0::setClock(LptmrClockSel_Oscerclk, PRESCALE);
+   Lptmr0::setCallback(wakeup);
+   Lptmr0::enableNvicInterrupts(NvicPriority_Normal);
+   ready = true;
+}
+
+}; // namespace LowPower
+
+/**
+ * Sleep until the LPTMR expires or an interrupt occurs\n
+ * Called from the idle demon with interrupts masked and the RTX tick suspended
+ *
+ * @param[in] ticks Maximum time to sleep in RTX ticks (ms)
+ *
+ * @return Time slept in RTX ticks - 0 if unable to sleep
+ */
+uint32_t lowPowerSleep(uint32_t ticks) {
+   using namespace LowPower;
+
+   if (!ready) {
+      return 0;
+   }
+   if (ticks > MAX_SLEEP) {
+      ticks = MAX_SLEEP;
+   }
+   volatile LPTMR_Type &lptmr = Lptmr0Info::lptmr();
+
+   // Counter is cleared while disabled
+   lptmr.CMR = ((ticks*COUNTS_PER_2MS)/2)-1;
+   lptmr.CSR = LptmrMode_Time|LptmrResetOn_Compare|LptmrInterrupt_Enabled|LPTMR_CSR_TEN_MASK|LPTMR_CSR_TCF_MASK;
+
+   // Interrupts are masked but a pending interrupt still ends the wait
+   Smc::enterWaitMode();
+
+   // Counter must be written to latch the value for reading
+   lptmr.CNR = 0;
+   uint32_t counts = lptmr.CNR;
+   if (lptmr.CSR&LPTMR_CSR_TCF_MASK) {
+      // Expired - counter restarted from zero
+      counts += lptmr.CMR+1;
+   }
+   // Disabling clears the flag - the interrupt is no longer needed
+   lptmr.CSR = 0;
+   NVIC_ClearPendingIRQ(Lptmr0Info::irqNums[0]);
+
+   // Part of a tick is carried to the next sleep so RTX time doesn't drift
+   partialCounts += 2*counts;
+   ticks          = partialCounts/COUNTS_PER_2MS;
+   partialCounts -= ticks*COUNTS_PER_2MS;
+   return ticks;
+}
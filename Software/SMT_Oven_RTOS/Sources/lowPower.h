@@ -0,0 +1,49 @@
+/**
+ * @file    lowPower.h
+ * @brief   Tickless idle using the LPTMR
+ *
+ *  When no thread is ready the idle demon (RTX_Conf_CM.c) suspends the RTX tick and sleeps
+ *  until the next delay or timer is due rather than waking for every 1 ms SysTick.
+ *  The LPTMR times the sleep and measures how long it lasted so the RTX time can be advanced.
+ *
+ *  The processor is put in WAIT mode rather than a STOP mode so USB, the PIT, the comparator
+ *  and FTMs keep running. Any interrupt (key press, USB, mains zero-crossing) ends the sleep early.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+
+#ifndef SOURCES_LOWPOWER_H_
+#define SOURCES_LOWPOWER_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+namespace LowPower {
+
+/**
+ * Configure the LPTMR used to time sleeps\n
+ * The idle demon only sleeps with the tick suspended after this is called.
+ */
+void initialise();
+
+}; // namespace LowPower
+
+extern "C" {
+#endif
+
+/**
+ * Sleep until the LPTMR expires or an interrupt occurs\n
+ * Called from the idle demon with interrupts masked and the RTX tick suspended
+ *
+ * @param[in] ticks Maximum time to sleep in RTX ticks (ms)
+ *
+ * @return Time slept in RTX ticks - 0 if unable to sleep
+ */
+uint32_t lowPowerSleep(uint32_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SOURCES_LOWPOWER_H_ */
@@ -10,6 +10,7 @@
 #include <string.h>
 #include <math.h>
 #include "cmsis.h"
+#include "configCache.h"
 #include "usb_cdc_interface.h"
 #include "system.h"
 #include "derivative.h"
@@ -21,11 +22,16 @@
 #include "pid.h"
 #include "settings.h"
 #include "messageBox.h"
+#include "lowPower.h"
 #include "mainMenu.h"
+#include "nvLayout.h"
+#include "profileLibrary.h"
+#include "uiEvents.h"
 #include "usb.h"
 #include "utilities.h"
 #include "EditProfile.h"
 #include "i2c.h"
+#include "trace.h"
 
 class profilesMenu {
 
@@ -64,7 +70,6 @@ public:
          default:
             break;
          }
-         __WFI();
       };
    }
 };
@@ -94,6 +99,21 @@ int main() {
 
    initialise();
 
+   // Settings used by control loop
+   ConfigCache::refresh();
+
+   // Index of profiles held in program flash
+   ProfileLibrary::initialise();
+
+   // Events and one second tick for the front panel
+   UiEvents::initialise();
+
+   // Tickless idle
+   LowPower::initialise();
+
+   TRACE_INITIALISE();
+   TRACE_THREAD("UI");
+
    Usb0::initialise();
 
    mapAllPins();
@@ -105,6 +125,20 @@ int main() {
       console.write(buff);
    }
 
+   switch(NvLayout::getStatus()) {
+   case NvLayout::NvLayout_Migrated:
+      console.writeln("Settings converted from earlier firmware");
+      break;
+   case NvLayout::NvLayout_Recovered:
+      console.writeln("Settings recovered after interrupted save");
+      break;
+   case NvLayout::NvLayout_Invalid:
+      messageBox("Settings", "Saved settings are\nnot valid for this\nfirmware\n\nFactory defaults\nrestored");
+      break;
+   default:
+      break;
+   }
+
    MainMenu::run();
 
    // Should not reach here
@@ -6,6 +6,9 @@
  *      Author: podonoghue
  */
 
+#include "autoTune.h"
+#include "calibration.h"
+#include "configCache.h"
 #include "manageProfiles.h"
 #include "SolderProfile.h"
 #include "configure.h"
@@ -13,6 +16,7 @@
 #include "editProfile.h"
 #include "settings.h"
 #include "messageBox.h"
+#include "uiEvents.h"
 
 namespace MainMenu {
 
@@ -33,6 +37,7 @@ static void factoryDefaults() {
    if (rc == MSG_IS_YES) {
       // Reset all to factory defaults
       Settings::initialiseSettings();
+      ConfigCache::refresh();
    }
 }
 
@@ -42,6 +47,8 @@ static const MenuItem menu[] {
       {"Manage Profiles",      ManageProfiles::profileMenu,   },
       {"Thermocouples",        Monitor::monitor,              },
       {"Settings",             [](){settings.runMenu();},     },
+      {"Auto-tune PID",        AutoTune::run,                 },
+      {"Calibrate probes",     Calibration::run,              },
       {"Factory defaults",     factoryDefaults,               },
 };
 
@@ -102,7 +109,23 @@ void run() {
          drawScreen();
          changed = false;
       }
-      SwitchValue button = buttons.getButton(100);
+      // Several keys may be queued for one event
+      UiEvents::UiEvent event = (buttons.peekButton() != SwitchValue::SW_NONE)?UiEvents::UiEvent_Key:UiEvents::wait();
+      if (event == UiEvents::UiEvent_Remote) {
+         // Show lock-out as soon as the remote host takes control
+         if (interactiveMutex.wait(0) != osOK) {
+            displayBusy();
+            // Wait until the session ends
+            changed = true;
+            interactiveMutex.wait();
+         }
+         interactiveMutex.release();
+         continue;
+      }
+      if (event != UiEvents::UiEvent_Key) {
+         continue;
+      }
+      SwitchValue button = buttons.getButton(0);
       if (button != SwitchValue::SW_NONE) {
          // Try to get mutex - no wait so we can update display if busy
          status = interactiveMutex.wait(0);
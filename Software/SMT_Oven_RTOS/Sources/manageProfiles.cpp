@@ -85,7 +85,6 @@ void profileMenu() {
       default:
          break;
       }
-      __WFI();
    };
 }
 
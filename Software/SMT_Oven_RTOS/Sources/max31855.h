@@ -9,8 +9,13 @@
 #ifndef SOURCES_MAX31855_H_
 #define SOURCES_MAX31855_H_
 
+#include <math.h>
+#include "calibration.h"
 #include "flash.h"
 #include "spi.h"
+#include "statistics.h"
+#include "thermocoupleK.h"
+#include "trace.h"
 
 /**
  * Class representing an MAX31855 connected over SPI
@@ -27,6 +32,28 @@ public:
       TH_DISABLED=0b111,   //!< Available but disabled (Temperature reading will still be valid)
    };
 
+   /**
+    * Health of the thermocouple (only counted while enabled)
+    */
+   struct Health {
+      uint32_t           readings;               // Readings taken
+      uint32_t           faults;                 // Readings with a fault status
+      uint32_t           held;                   // Measurements where the last good temperature was used
+      uint32_t           excluded;               // Measurements where the thermocouple was treated as failed
+      uint16_t           consecutiveFaults;      // Current run of measurements without a good reading
+      uint16_t           maxConsecutiveFaults;   // Longest run of measurements without a good reading
+      ThermocoupleStatus lastFault;              // Status of most recent fault
+   };
+
+   /**
+    * Nonvolatile settings of the thermocouple copied to RAM for use while measuring (see ConfigCache)
+    */
+   struct ProbeSettings {
+      bool  enabled;    // Thermocouple enabled
+      float gain;       // Calibration gain
+      float offset;     // Calibration offset plus manual offset (Celsius)
+   };
+
 protected:
 
    /** SPI configuration value */
@@ -41,29 +68,44 @@ protected:
    /** Offset to add to reading from probe */
    USBDM::Nonvolatile<int> &offset;
 
+   /** Gain and offset calibration of probe */
+   const NvCalibration &calibration;
+
    /** Used to disable sensor */
    USBDM::Nonvolatile<bool> &enabled;
 
    /** The result of last Temperature measurements */
    float                lastTemperature;
 
+   /** The result of last Temperature measurements before calibration and offset */
+   float                lastUncalibrated;
+
    /** The result of last Cold Reference Temperature measurements */
    float                lastColdReference;
 
    /** The status of last Temperature measurements */
    ThermocoupleStatus   lastStatus;
 
+   /** Last good temperature from measure() */
+   float                lastGoodTemperature = NAN;
+
+   /** Health counters */
+   Health               health = {};
+
 public:
    /**
     * Constructor
     *
     * @param[in] spi     The SPI to use to communicate with MAX31855
     * @param[in] pinNum  PCS to use
-    * @param[in] offset  Offset to add to reading from probe
-    * @param[in] enabled Reference to non-volatile variable enabling thermocouple
+    * @param[in] offset      Offset to add to reading from probe
+    * @param[in] enabled     Reference to non-volatile variable enabling thermocouple
+    * @param[in] calibration Gain and offset calibration of probe
     */
-   Max31855(USBDM::Spi &spi, USBDM::SpiPeripheralSelect pinNum, USBDM::Nonvolatile<int> &offset, USBDM::Nonvolatile<bool> &enabled) :
-      spi(spi), pinNum(pinNum), offset(offset), enabled(enabled), lastTemperature(0), lastColdReference(0), lastStatus(TH_MISSING) {
+   Max31855(USBDM::Spi &spi, USBDM::SpiPeripheralSelect pinNum, USBDM::Nonvolatile<int> &offset, USBDM::Nonvolatile<bool> &enabled,
+         const NvCalibration &calibration) :
+      spi(spi), pinNum(pinNum), offset(offset), calibration(calibration), enabled(enabled),
+      lastTemperature(0), lastUncalibrated(0), lastColdReference(0), lastStatus(TH_MISSING) {
       using namespace USBDM;
 
       spi.startTransaction();
@@ -129,18 +171,34 @@ public:
       return enabled;
    }
 
+   /**
+    * Get nonvolatile settings of the sensor for use by measure()
+    *
+    * @return Copy of settings
+    */
+   ProbeSettings getSettings() const {
+      return ProbeSettings {
+         enabled,
+         (int32_t)calibration.gain*(1.0f/NvCalibration::GAIN_SCALE),
+         (int32_t)calibration.offset*(1.0f/NvCalibration::OFFSET_SCALE) + (int)offset,
+      };
+   }
+
    /**
     * Read the thermocouple.
     * This initiates an measure of the thermocouple and updates internal state as well as returning the new values.
     *
-    * @param[out] temperature   Temperature reading of external probe (.25 degree resolution)
+    * @param[out] temperature   Temperature reading of external probe (.25 degree resolution, ITS-90 corrected)
     * @param[out] coldReference Temperature reading of internal cold-junction reference (.0625 degree resolution)
+    * @param[in]  settings      Settings of sensor (see getSettings())
     *
     * @return status flag
     *
     * @note Temperature and cold-junction may be valid even if the thermocouple is disabled (TH_DISABLED).
     */
-   ThermocoupleStatus getNewReading(float &temperature, float &coldReference) {
+   ThermocoupleStatus getNewReading(float &temperature, float &coldReference, const ProbeSettings &settings) {
+      TRACE_SCOPE("sensor");
+
       uint8_t data[] = {
             0xFF, 0xFF, 0xFF, 0xFF,
       };
@@ -153,15 +211,19 @@ public:
          spi.txRx(sizeof(data), (uint8_t*)nullptr, data);
       }
       spi.endTransaction();
+      Statistics::spiBytes.add(sizeof(data));
       }
-      // Temperature = sign-extended 14-bit value
+      // Cold junction = sign-extended 12-bit value
+      lastColdReference = (((int16_t)((data[2]<<8)|data[3]))>>4)/16.0;
+
+      // Temperature = sign-extended 14-bit value (linear approximation by MAX31855)
       lastTemperature = (((int16_t)((data[0]<<8)|data[1]))>>2)/4.0;
 
-      // Add manual offset
-      lastTemperature += offset;
+      // Correct for non-linearity of type-K thermocouple
+      lastUncalibrated = ThermocoupleK::linearise(lastTemperature, lastColdReference);
 
-      // Cold junction = sign-extended 12-bit value
-      lastColdReference = (((int16_t)((data[2]<<8)|data[3]))>>4)/16.0;
+      // Apply calibration and add manual offset
+      lastTemperature = settings.gain*lastUncalibrated + settings.offset;
 
       /*  Raw status
        *    0x000 => OK
@@ -174,9 +236,10 @@ public:
       lastStatus = TH_ENABLED;
       if (rawStatus != 0) {
          // Invalid lastTemperature measurement
-         lastTemperature = NAN;
+         lastTemperature  = NAN;
+         lastUncalibrated = NAN;
       }
-      if (rawStatus == 0x111) {
+      if (rawStatus == 0b111) {
          // No device so no Cold reference
          lastColdReference = NAN;
          lastStatus = TH_MISSING;
@@ -193,10 +256,17 @@ public:
          // Vcc short
          lastStatus = TH_SHORT_VCC;
       }
-      else if (!enabled) {
+      else if (!settings.enabled) {
          // Available but not enabled
          lastStatus = TH_DISABLED;
       }
+      if (lastStatus != TH_DISABLED) {
+         health.readings++;
+         if (lastStatus != TH_ENABLED) {
+            health.faults++;
+            health.lastFault = lastStatus;
+         }
+      }
       // Return results
       temperature   = lastTemperature;
       coldReference = lastColdReference;
@@ -205,6 +275,95 @@ public:
       return lastStatus;
    }
 
+   /**
+    * Make a measurement from several readings of the thermocouple.\n
+    * Faulty readings are discarded. If none of the readings are good the last good
+    * temperature is held for up to holdLimit measurements before the fault is reported.
+    * This prevents a transient open-circuit or SPI glitch from failing the oven.
+    *
+    * @param[out] temperature   Average of good readings or held temperature
+    * @param[out] coldReference Average of cold-junction readings
+    * @param[in]  oversamples   Number of readings to take
+    * @param[in]  holdLimit     Number of faulty measurements to hold the last good temperature for
+    * @param[in]  settings      Settings of sensor (see getSettings())
+    *
+    * @return TH_ENABLED if temperature is usable (measured or held), otherwise the fault
+    */
+   ThermocoupleStatus measure(float &temperature, float &coldReference, unsigned oversamples, unsigned holdLimit,
+         const ProbeSettings &settings) {
+      ThermocoupleStatus status = TH_MISSING;
+      unsigned goodCount = 0;
+      float    sum       = 0;
+      float    coldSum   = 0;
+      for (unsigned overSample=0; overSample<oversamples; overSample++) {
+         float reading, coldReading;
+         ThermocoupleStatus readingStatus = getNewReading(reading, coldReading, settings);
+         coldSum += coldReading;
+         if ((readingStatus == TH_ENABLED) || (readingStatus == TH_DISABLED)) {
+            sum += reading;
+            goodCount++;
+            status = readingStatus;
+         }
+         else if (goodCount == 0) {
+            status = readingStatus;
+         }
+      }
+      coldReference = coldSum/oversamples;
+      if (goodCount > 0) {
+         temperature = sum/goodCount;
+         if (status == TH_ENABLED) {
+            USBDM::CriticalSection cs;
+            lastGoodTemperature      = temperature;
+            health.consecutiveFaults = 0;
+         }
+         return status;
+      }
+      if (!settings.enabled) {
+         // Faults don't matter while disabled
+         temperature = NAN;
+         return status;
+      }
+      USBDM::CriticalSection cs;
+      if (health.consecutiveFaults < UINT16_MAX) {
+         health.consecutiveFaults++;
+      }
+      if (health.consecutiveFaults > health.maxConsecutiveFaults) {
+         health.maxConsecutiveFaults = health.consecutiveFaults;
+      }
+      if ((health.consecutiveFaults <= holdLimit) && !std::isnan(lastGoodTemperature)) {
+         // Hold last good temperature
+         health.held++;
+         temperature = lastGoodTemperature;
+         return TH_ENABLED;
+      }
+      // Treat as failed
+      health.excluded++;
+      lastGoodTemperature = NAN;
+      temperature         = NAN;
+      return status;
+   }
+
+   /**
+    * Get health counters
+    *
+    * @return Copy of counters
+    */
+   Health getHealth() const {
+      USBDM::CriticalSection cs;
+      return health;
+   }
+
+   /**
+    * Clear health counters (the current run of faults is retained)
+    */
+   void clearHealth() {
+      USBDM::CriticalSection cs;
+      uint16_t consecutiveFaults = health.consecutiveFaults;
+      health = {};
+      health.consecutiveFaults    = consecutiveFaults;
+      health.maxConsecutiveFaults = consecutiveFaults;
+   }
+
    /**
     * Get thermocouple reading.
     * This does not initiate a new measurement - it just return the last measurement taken.
@@ -246,6 +405,17 @@ public:
       return lastStatus;
    }
 
+   /**
+    * Get thermocouple reading before calibration and manual offset are applied.
+    * This does not initiate a new measurement - it just return the last measurement taken.
+    *
+    * @return ITS-90 corrected temperature (NAN if the last reading was faulty)
+    */
+   float getLastUncalibrated() {
+      USBDM::CriticalSection cs;
+      return lastUncalibrated;
+   }
+
    /**
     * Set offset added to temperature reading
     *
@@ -0,0 +1,231 @@
+/**
+ * @file    nvLayout.cpp
+ * @brief   Version and checksum of the non-volatile (FlexRAM) layout
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include "crc32.h"
+#include "flash.h"
+#include "configure.h"
+#include "nvLayout.h"
+#include "settings.h"
+
+using namespace USBDM;
+
+/** Limits of the non-volatile variables (from linker script) */
+extern uint8_t __flexRAM_start__[];
+extern uint8_t __flexRAM_end__[];
+
+namespace NvLayout {
+
+/**
+ * Header describing the non-volatile variables\n
+ * Each field is a word so it is written as a single EEPROM record
+ */
+struct Header {
+   uint32_t magic;     // MAGIC
+   uint32_t layout;    // Version (bits 15-0) and size in bytes (bits 31-16)
+   uint32_t crc;       // CRC-32 of the non-volatile variables
+   uint32_t updating;  // UPDATING while changes are being written
+};
+
+/** Header in FlexRAM */
+__attribute__ ((section(".flexRAMHeader")))
+static volatile Header header;
+
+/** Value of an unwritten FlexRAM word */
+static constexpr uint32_t ERASED = 0xFFFFFFFF;
+
+/** Marks the variables as being changed and the CRC not yet updated ("UPDT") */
+static constexpr uint32_t UPDATING = 0x54445055;
+
+/** Marks the CRC as matching the variables */
+static constexpr uint32_t IDLE     = 0;
+
+/**
+ * Convert the non-volatile variables from one layout version to the next
+ */
+struct Migration {
+   uint16_t from;          // Version converted from (converted to from+1)
+   bool   (*convert)();    // Does conversion - returns false if the contents are not usable
+};
+
+/**
+ * Version 0 - firmware before the header was added\n
+ * The version 0 variables (section .flexRAM) are unchanged but there was no CRC so
+ * check that some values are plausible. Variables added in version 1 (section .flexRAM_v1)
+ * follow them and are set to factory defaults.
+ *
+ * @return true if contents are usable
+ */
+static bool fromUnversioned() {
+   if (((unsigned)(int)currentProfileIndex >= MAX_PROFILES) ||
+       ((unsigned)(int)minimumFanSpeed > 100)) {
+      return false;
+   }
+   SeqLock::WriteScope ws(configLock);
+   Settings::initialiseVersion1Settings();
+   return true;
+}
+
+/** Conversions between layout versions - in order */
+static const Migration migrations[] = {
+      {0, fromUnversioned},
+};
+
+/** Result of check() */
+static Status status = NvLayout_Valid;
+
+/** Indicates the header is known to match the contents */
+static bool headerCurrent = false;
+
+/**
+ * Get size of non-volatile variables
+ *
+ * @return Size in bytes
+ */
+static unsigned getSize() {
+   return __flexRAM_end__ - __flexRAM_start__;
+}
+
+/**
+ * Get value of layout word for a version
+ *
+ * @param[in] version Layout version
+ * @param[in] size    Size of non-volatile variables in bytes
+ *
+ * @return Layout word
+ */
+static constexpr uint32_t makeLayout(uint16_t version, unsigned size) {
+   return version|(size<<16);
+}
+
+/**
+ * Calculate CRC-32 of the non-volatile variables
+ *
+ * @param[in] size Number of bytes to include
+ *
+ * @return CRC
+ */
+static uint32_t calculateCrc(unsigned size) {
+   return crc32(__flexRAM_start__, size);
+}
+
+/**
+ * Write a header word if changed
+ *
+ * @param[in] address Word in FlexRAM
+ * @param[in] value   Value to write
+ */
+static void writeWord(volatile uint32_t &address, uint32_t value) {
+   if (address != value) {
+      address = value;
+      Flash::waitUntilFlexIdle();
+   }
+}
+
+/**
+ * Mark the header as out of date\n
+ * Called before a change is written to FlexRAM.
+ */
+static void startUpdate() {
+   writeWord(header.updating, UPDATING);
+}
+
+/**
+ * Update header to match the current contents\n
+ * Called after each change is committed to FlexRAM.
+ * The update marker is cleared last so it remains set until the CRC is correct.
+ */
+static void updateHeader() {
+   unsigned size = getSize();
+   writeWord(header.crc,      calculateCrc(size));
+   writeWord(header.layout,   makeLayout(VERSION, size));
+   writeWord(header.magic,    MAGIC);
+   writeWord(header.updating, IDLE);
+}
+
+/**
+ * Check the non-volatile layout and migrate from an earlier version if necessary\n
+ * Must be called once at start-up after the EEPROM is initialised.
+ *
+ * @return Status
+ */
+Status check() {
+   Flash::waitUntilFlexIdle();
+
+   unsigned size   = getSize();
+   uint32_t layout = header.layout;
+   unsigned version;
+
+   if (header.magic == MAGIC) {
+      if (layout == makeLayout(VERSION, size)) {
+         // Fast path - current layout
+         if (header.crc != calculateCrc(size)) {
+            // Interrupted while writing a change - each word is written atomically so
+            // the variables are usable (a mix of old and new values) and are resealed
+            status = (header.updating == UPDATING)?NvLayout_Recovered:NvLayout_Invalid;
+            return status;
+         }
+         headerCurrent = (header.updating == IDLE);
+         status        = NvLayout_Valid;
+         return status;
+      }
+      version = (uint16_t)layout;
+      if ((version >= VERSION) || ((layout>>16) > size) || (header.crc != calculateCrc(layout>>16))) {
+         // Newer firmware, changed layout without a new version or corrupt
+         status = NvLayout_Invalid;
+         return status;
+      }
+   }
+   else if ((header.magic == ERASED) && (layout == ERASED) && (header.crc == ERASED)) {
+      // Never written - firmware before header was added
+      version = 0;
+   }
+   else {
+      // Corrupt
+      status = NvLayout_Invalid;
+      return status;
+   }
+   // Convert one version at a time
+   while (version < VERSION) {
+      const Migration *migration = nullptr;
+      for (const Migration &m:migrations) {
+         if (m.from == version) {
+            migration = &m;
+            break;
+         }
+      }
+      if ((migration == nullptr) || !migration->convert()) {
+         status = NvLayout_Invalid;
+         return status;
+      }
+      version++;
+   }
+   status = NvLayout_Migrated;
+   return status;
+}
+
+/**
+ * Write header for the current contents and keep it updated after each change\n
+ * Called after check() (and after restoring factory defaults if required).
+ */
+void seal() {
+   if (!headerCurrent) {
+      updateHeader();
+      headerCurrent = true;
+   }
+   FlexRamTransaction::setCommitCallbacks(startUpdate, updateHeader);
+}
+
+/**
+ * Get result of check() at start-up
+ *
+ * @return Status
+ */
+Status getStatus() {
+   return status;
+}
+
+}; // namespace NvLayout
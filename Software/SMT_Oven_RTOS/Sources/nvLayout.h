@@ -0,0 +1,76 @@
+/**
+ * @file    nvLayout.h
+ * @brief   Version and checksum of the non-volatile (FlexRAM) layout
+ *
+ *  The address of each Nonvolatile variable is decided by the linker from the declaration
+ *  and link order so a firmware change can move settings without any error.
+ *
+ *  A header in the last 16 bytes of FlexRAM (section .flexRAMHeader, fixed by the linker script)
+ *  records the layout version and size and a CRC-32 of the non-volatile variables.
+ *  The CRC is updated after each change is committed (see FlexRamTransaction).
+ *  An update marker in the header is set before a change is written and cleared after the CRC
+ *  is updated so a CRC mismatch caused by a power failure part way through a save can be told
+ *  apart from corruption.
+ *
+ *  On start-up:
+ *  - Header matches this firmware and CRC is correct => used as is (fast path)
+ *  - Header matches, CRC wrong but update marker set => used as is and resealed
+ *  - Header is from an earlier version                => migrated one version at a time
+ *  - Otherwise (corrupt, unknown or newer version)    => factory defaults
+ *
+ *  <b>Any change to the non-volatile variables must increment VERSION and add a migration.</b>
+ *  Variables are never moved. New variables go in a new section for the version (e.g. .flexRAM_v1)
+ *  that the linker script places after those of earlier versions. A migration then only needs
+ *  to initialise the new variables.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+
+#ifndef SOURCES_NVLAYOUT_H_
+#define SOURCES_NVLAYOUT_H_
+
+#include <stdint.h>
+
+namespace NvLayout {
+
+/** Identifies a valid header ("OVEN") */
+constexpr uint32_t MAGIC   = 0x4E45564F;
+
+/** Version of the layout used by this firmware */
+constexpr uint16_t VERSION = 1;
+
+/**
+ * Result of checking the layout at start-up
+ */
+enum Status {
+   NvLayout_Valid,     //!< Layout matched and CRC correct
+   NvLayout_Migrated,  //!< Layout converted from an earlier version
+   NvLayout_Recovered, //!< Save was interrupted - contents used and CRC updated
+   NvLayout_Invalid,   //!< Contents unusable - factory defaults required
+};
+
+/**
+ * Check the non-volatile layout and migrate from an earlier version if necessary\n
+ * Must be called once at start-up after the EEPROM is initialised.
+ *
+ * @return Status
+ */
+Status check();
+
+/**
+ * Write header for the current contents and keep it updated after each change\n
+ * Called after check() (and after restoring factory defaults if required).
+ */
+void seal();
+
+/**
+ * Get result of check() at start-up
+ *
+ * @return Status
+ */
+Status getStatus();
+
+}; // namespace NvLayout
+
+#endif /* SOURCES_NVLAYOUT_H_ */
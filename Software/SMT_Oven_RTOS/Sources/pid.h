@@ -11,6 +11,8 @@
 #include <time.h>
 #include "cmsis.h"
 #include "pid.h"
+#include "statistics.h"
+#include "trace.h"
 
 class Pid {
 public:
@@ -47,9 +49,12 @@ private:
    double currentOutput;      //!< Current output
    double setpoint;           //!< Set-point for controller
    double currentError;       //!< Current error calculation
+   double feedForward = 0;    //!< Output applied ahead of error (from model of controlled system)
 
    unsigned tickCount = 0;    //!< Time in ticks since last enabled
 
+   uint32_t lastCallbackTime = 0; //!< Time-stamp of last callback (for statistics)
+
 public:
    /**
     * Constructor
@@ -84,6 +89,7 @@ public:
             // Just enabled
             currentInput = inputFn();
             integral     = 0; //currentOutput;
+            feedForward  = 0;
             tickCount    = 0;
             start(interval);
          }
@@ -137,6 +143,32 @@ public:
       kd = Kd / interval;
    }
 
+   /**
+    * Change controller tuning without a step in the output\n
+    * The integral term absorbs the change in the proportional and differential terms
+    * at the last sample so the output is continuous across the change.
+    *
+    * @param[in] Kp Proportional constant
+    * @param[in] Ki Integral constant
+    * @param[in] Kd Differential constant
+    */
+   void setTuningsBumpless(double Kp, double Ki, double Kd) {
+      double oldKp = kp;
+      double oldKd = kd;
+      setTunings(Kp, Ki, Kd);
+      if (!enabled || (tickCount == 0)) {
+         // No output yet
+         return;
+      }
+      integral += (oldKp-kp)*currentError - (oldKd-kd)*(currentInput-lastInput);
+      if(integral > (outMax-feedForward)) {
+         integral = outMax-feedForward;
+      }
+      else if(integral < (outMin-feedForward)) {
+         integral = outMin-feedForward;
+      }
+   }
+
    /**
     * Change set-point of controller
     *
@@ -155,6 +187,27 @@ public:
       return setpoint;
    }
 
+   /**
+    * Change feed-forward term of controller\n
+    * This is added to the PID output so the controller only has to correct
+    * the error in the feed-forward (e.g. from a thermal model of the set-point trajectory).\n
+    * Cleared when the controller is enabled.
+    *
+    * @param[in] value Value to add to output (in output units)
+    */
+   void setFeedForward(double value) {
+      feedForward = value;
+   }
+
+   /**
+    * Get feed-forward term of controller
+    *
+    * @return Current feed-forward
+    */
+   double getFeedForward() {
+      return feedForward;
+   }
+
    /**
     * Get input of controller
     *
@@ -219,6 +272,21 @@ private:
       if(!enabled) {
          return;
       }
+      if (tickCount == 0) {
+         // First call after enable() - name the timer thread once rather than searching the names on every call
+         TRACE_THREAD("Timer");
+      }
+      TRACE_SCOPE("pid");
+
+      // Record callback period and deviation from nominal interval
+      uint32_t now = Statistics::timeStamp();
+      if (tickCount > 0) {
+         uint32_t period  = Statistics::ticksToMicroseconds(now - lastCallbackTime);
+         uint32_t nominal = (uint32_t)(interval*1000000);
+         Statistics::pidPeriod.add(period);
+         Statistics::pidJitter.add((period>nominal)?(period-nominal):(nominal-period));
+      }
+      lastCallbackTime = now;
 
       tickCount++;
 //      USBDM::console.writeln(tickCount);
@@ -228,16 +296,18 @@ private:
       currentInput = inputFn();
       currentError = setpoint - currentInput;
 
+      // Integral is limited to the range left by the feed-forward (anti-windup)
+      double ff = feedForward;
       integral += (ki * currentError);
-      if(integral > outMax) {
-         integral = outMax;
+      if(integral > (outMax-ff)) {
+         integral = outMax-ff;
       }
-      else if(integral < outMin) {
-         integral = outMin;
+      else if(integral < (outMin-ff)) {
+         integral = outMin-ff;
       }
       double deltaInput = (currentInput - lastInput);
 
-      currentOutput = kp * currentError + integral - kd * deltaInput;
+      currentOutput = ff + kp * currentError + integral - kd * deltaInput;
       if(currentOutput > outMax) {
          currentOutput = outMax;
       }
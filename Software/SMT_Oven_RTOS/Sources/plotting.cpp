@@ -156,116 +156,19 @@ static void drawAxis(int profileIndex) {
 }
 
 /**
- * Class used to plot a Profile
- */
-class ProfilePlotter {
-
-protected:
-   /** Current state of profile */
-   State state;
-
-   /** Current time in profile */
-   int   time;
-
-   /** Current set-point  */
-   float setpoint;
-
-   /*
-    * Calculates one step of the profile
-    *
-    * @param profile Profile to use
-    */
-   void calculate(const NvSolderProfile &profile) {
-      static int  startOfSoakTime;
-      static int  startOfDwellTime;
-      static constexpr float ambient = 25.0f;
-
-      // Advance time
-      time++;
-
-      // Handle state
-      switch (state) {
-      case s_off:
-      case s_manual:
-      case s_fail:
-      case s_complete:
-         return;
-      case s_init:
-         state = s_preheat;
-         /* Fall through - no break */
-      case s_preheat:
-         // Heat from ambient to start of soak temperature
-         // A -> soakTemp1 over preheatTime
-         if (setpoint<profile.soakTemp1) {
-            setpoint = ambient + (time/(float)profile.preheatTime)*(profile.soakTemp1-ambient);
-         }
-         else {
-            state = s_soak;
-            startOfSoakTime = time;
-         }
-         break;
-      case s_soak:
-         // Heat from soak start temperature to soak end temperature over soak time
-         // soakTemp1 -> soakTemp2 over soakTime time
-         if (setpoint<profile.soakTemp2) {
-            setpoint = profile.soakTemp1 + (time-startOfSoakTime)*(profile.soakTemp2-profile.soakTemp1)/(float)profile.soakTime;
-         }
-         if (time >= (startOfSoakTime+profile.soakTime)) {
-            state = s_ramp_up;
-         }
-         break;
-      case s_ramp_up:
-         // Heat from soak end temperature to peak at rampUp rate
-         // soakTemp2 -> peakTemp @ ramp2Slope
-         if (setpoint < profile.peakTemp) {
-            setpoint += profile.rampUpSlope;
-         }
-         else {
-            state = s_dwell;
-            startOfDwellTime = time;
-         }
-         break;
-      case s_dwell:
-         // Remain at peak temperature for dwell time
-         // peakTemp for peakDwell
-         if (time>(startOfDwellTime+profile.peakDwell)) {
-            state = s_ramp_down;
-         }
-         break;
-      case s_ramp_down:
-         // Ramp down at rampDown rate
-         // peakDwell 50 @ rampDown
-         if (setpoint > 50) {
-            setpoint += profile.rampDownSlope;
-         }
-         else {
-            state = s_off;
-         }
-         break;
-      }
-   };
-
-public:
-   /**
-    * Plot the entire profile to the current plot
-    *
-    * @param[in] profile Profile to use
-    */
-   ProfilePlotter(const NvSolderProfile &profile) : state(s_preheat), time(0), setpoint(25.0) {
-      while (state != s_off) {
-         calculate(profile);
-         temperaturePlot.addProfilePoint(time, setpoint);
-      }
-   }
-};
-
-/**
- * Plot the entire profile to the current plot
+ * Plot a profile trajectory to the current plot
  *
- * @param[in] profileIndex Index of profile to use
+ * @param[in] trajectory Compiled profile to plot
  */
-static void plotProfile(int profileIndex) {
-   ProfilePlotter plotter(profiles[profileIndex]);
+static void plotProfile(const ProfileTrajectory &trajectory) {
+   int duration = (int)ceil(trajectory.getDuration());
+   if (duration > TemperaturePlot::MAX_PROFILE_TIME) {
+      // Long programs (e.g. bake-out) are clipped to the plot
+      duration = TemperaturePlot::MAX_PROFILE_TIME;
+   }
+   for (int time=0; time<=duration; time++) {
+      temperaturePlot.addProfilePoint(time, trajectory.evaluate((float)time));
+   }
 }
 
 /**
@@ -284,9 +187,20 @@ static int profileIndex = 0;
  * @param[in] index Index of profile to draw to plot
  */
 void drawProfile(int index) {
+   drawProfile(index, ProfileTrajectory::getNominal(index));
+}
+
+/**
+ * Draw a compiled profile to current plot data\n
+ * This clears the plot data and then plots the given trajectory.
+ *
+ * @param[in] index      Index of profile (for name)
+ * @param[in] trajectory Compiled profile to draw
+ */
+void drawProfile(int index, const ProfileTrajectory &trajectory) {
    profileIndex = index;
    Draw::reset();
-   Draw::plotProfile(index);
+   Draw::plotProfile(trajectory);
 }
 
 /**
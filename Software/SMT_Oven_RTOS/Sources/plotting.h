@@ -11,6 +11,7 @@
 #define SOURCES_PLOTTING_H_
 
 #include <TemperaturePlot.h>
+#include "profileTrajectory.h"
 
 /**
  * Functions associated with drawing profiles and related
@@ -30,6 +31,15 @@ void reset();
  */
 void drawProfile(int index);
 
+/**
+ * Draw a compiled profile to current plot data\n
+ * This clears the plot data and then plots the given trajectory.
+ *
+ * @param[in] index      Index of profile (for name)
+ * @param[in] trajectory Compiled profile to draw
+ */
+void drawProfile(int index, const ProfileTrajectory &trajectory);
+
 /**
  * Update the LCD from plot data
  */
@@ -0,0 +1,380 @@
+/**
+ * @file    profileLibrary.cpp
+ * @brief   Library of solder profiles in program flash
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <stddef.h>
+#include <string.h>
+#include "crc32.h"
+#include "flash.h"
+#include "profileLibrary.h"
+
+using namespace USBDM;
+
+/** Start of library (from linker script) */
+extern uint8_t __profileLibrary_start__[];
+
+namespace ProfileLibrary {
+
+static_assert(SECTOR_SIZE == Flash::programFlashSectorSize, "Library sector size doesn't match flash");
+
+/** Value of an erased flash word */
+static constexpr uint32_t ERASED = 0xFFFFFFFF;
+
+/** Number of bytes programmed when a record is written (unused and deleted are left erased) */
+static constexpr unsigned PROGRAMMED_SIZE = offsetof(Record, unused);
+
+/** Indicates id is not in library */
+static constexpr uint8_t NO_SLOT = 0xFF;
+
+/** State of each slot */
+enum SlotState : uint8_t {
+   Slot_Free,  //!< Erased
+   Slot_Live,  //!< Holds the current record for an id
+   Slot_Dead,  //!< Deleted, replaced or corrupt - free after sector is erased
+};
+
+/** Slot holding each id */
+static uint8_t slotOfId[MAX_ID+1];
+
+/** State of each slot */
+static SlotState slotStates[NUM_SLOTS];
+
+/** Number of free slots */
+static unsigned freeSlots = 0;
+
+/** Number of profiles */
+static unsigned count = 0;
+
+/** Record being written - kept off the (small) thread stack */
+static Record newRecord;
+
+/**
+ * Get record in slot
+ *
+ * @param[in] slot Slot number
+ *
+ * @return Record in flash
+ */
+static inline const Record *getRecord(unsigned slot) {
+   return reinterpret_cast<const Record *>(__profileLibrary_start__+slot*SLOT_SIZE);
+}
+
+/**
+ * Calculate checksum of record
+ *
+ * @param[in] record Record to check
+ *
+ * @return CRC-32 of id, generation, nameHash and profile
+ */
+static uint32_t calculateChecksum(const Record &record) {
+   uint32_t crc = crc32(&record, offsetof(Record, checksum));
+   return crc32(&record.profile, sizeof(record.profile), crc);
+}
+
+/**
+ * Check if slot is completely erased
+ *
+ * @param[in] slot Slot number
+ *
+ * @return true if erased
+ */
+static bool isErased(unsigned slot) {
+   const uint32_t *p = reinterpret_cast<const uint32_t *>(getRecord(slot));
+   for (unsigned index=0; index<SLOT_SIZE/sizeof(uint32_t); index++) {
+      if (p[index] != ERASED) {
+         return false;
+      }
+   }
+   return true;
+}
+
+/**
+ * Mark record in slot as deleted
+ *
+ * @param[in] slot Slot number
+ *
+ * @return true if successful
+ */
+static bool markDeleted(unsigned slot) {
+   static const uint32_t deleted = 0;
+
+   slotStates[slot] = Slot_Dead;
+   if (!Flash::waitForFlashReady()) {
+      return false;
+   }
+   const Record *record = getRecord(slot);
+   return Flash::programRange(
+         reinterpret_cast<const uint8_t *>(&deleted),
+         (uint8_t *)&record->deleted,
+         sizeof(deleted)) == FLASH_ERR_OK;
+}
+
+/**
+ * Program record into a free slot
+ *
+ * @param[in] slot   Slot number
+ * @param[in] record Record to program
+ *
+ * @return true if programmed and verified
+ */
+static bool programRecord(unsigned slot, const Record &record) {
+   // Slot can't be reused until erased even if programming fails
+   slotStates[slot] = Slot_Dead;
+   freeSlots--;
+   if (!Flash::waitForFlashReady()) {
+      return false;
+   }
+   const Record *destination = getRecord(slot);
+   if ((Flash::programRange(
+         reinterpret_cast<const uint8_t *>(&record),
+         (uint8_t *)destination,
+         PROGRAMMED_SIZE) != FLASH_ERR_OK) ||
+       (memcmp(destination, &record, PROGRAMMED_SIZE) != 0)) {
+      return false;
+   }
+   slotStates[slot] = Slot_Live;
+   return true;
+}
+
+/**
+ * Find a free slot
+ *
+ * @param[in] excludeSector Sector to ignore
+ *
+ * @return Slot number or NO_SLOT if none
+ */
+static unsigned findFreeSlot(unsigned excludeSector=NUM_SECTORS) {
+   for (unsigned slot=0; slot<NUM_SLOTS; slot++) {
+      if ((slotStates[slot] == Slot_Free) && ((slot/SLOTS_PER_SECTOR) != excludeSector)) {
+         return slot;
+      }
+   }
+   return NO_SLOT;
+}
+
+/**
+ * Count slots in a sector with a given state
+ *
+ * @param[in] sector Sector number
+ * @param[in] state  State to count
+ *
+ * @return Number of slots
+ */
+static unsigned countSlots(unsigned sector, SlotState state) {
+   unsigned total = 0;
+   for (unsigned slot=sector*SLOTS_PER_SECTOR; slot<(sector+1)*SLOTS_PER_SECTOR; slot++) {
+      if (slotStates[slot] == state) {
+         total++;
+      }
+   }
+   return total;
+}
+
+/**
+ * Recover the dead slots in the sector with the most dead slots.\n
+ * Live records are copied to free slots in other sectors and the sector is erased.
+ *
+ * @return true if some slots were recovered
+ */
+static bool compact() {
+   unsigned victim   = NUM_SECTORS;
+   unsigned mostDead = 0;
+   for (unsigned sector=0; sector<NUM_SECTORS; sector++) {
+      unsigned dead = countSlots(sector, Slot_Dead);
+      if (dead > mostDead) {
+         mostDead = dead;
+         victim   = sector;
+      }
+   }
+   if (victim == NUM_SECTORS) {
+      // Nothing to recover
+      return false;
+   }
+   unsigned freeInVictim = countSlots(victim, Slot_Free);
+   if ((freeSlots-freeInVictim) < countSlots(victim, Slot_Live)) {
+      // Not enough space to move live records
+      return false;
+   }
+   // Move live records (same generation so a copy left by a power failure is discarded at start-up)
+   for (unsigned slot=victim*SLOTS_PER_SECTOR; slot<(victim+1)*SLOTS_PER_SECTOR; slot++) {
+      if (slotStates[slot] != Slot_Live) {
+         continue;
+      }
+      const Record *record = getRecord(slot);
+      unsigned newSlot = findFreeSlot(victim);
+      memcpy(static_cast<void *>(&newRecord), record, PROGRAMMED_SIZE);
+      if (!programRecord(newSlot, newRecord)) {
+         return false;
+      }
+      slotOfId[record->id] = newSlot;
+   }
+   if (!Flash::waitForFlashReady() ||
+       (Flash::eraseRange(__profileLibrary_start__+victim*SECTOR_SIZE, SECTOR_SIZE) != FLASH_ERR_OK)) {
+      return false;
+   }
+   for (unsigned slot=victim*SLOTS_PER_SECTOR; slot<(victim+1)*SLOTS_PER_SECTOR; slot++) {
+      slotStates[slot] = Slot_Free;
+   }
+   freeSlots += SLOTS_PER_SECTOR-freeInVictim;
+   return true;
+}
+
+/**
+ * Build the index from flash\n
+ * Must be called once at start-up before the library is used.
+ */
+void initialise() {
+   memset(slotOfId, NO_SLOT, sizeof(slotOfId));
+   freeSlots = 0;
+   count     = 0;
+
+   for (unsigned slot=0; slot<NUM_SLOTS; slot++) {
+      const Record *record = getRecord(slot);
+      if (isErased(slot)) {
+         slotStates[slot] = Slot_Free;
+         freeSlots++;
+         continue;
+      }
+      if ((record->deleted != ERASED) || (record->id == 0) || (record->id > MAX_ID) ||
+          (record->checksum != calculateChecksum(*record))) {
+         // Deleted, replaced or incomplete
+         slotStates[slot] = Slot_Dead;
+         continue;
+      }
+      unsigned other = slotOfId[record->id];
+      if (other == NO_SLOT) {
+         slotStates[slot] = Slot_Live;
+         slotOfId[record->id] = slot;
+         count++;
+         continue;
+      }
+      // Duplicate left by a power failure - keep the newer record (or the first if a copy)
+      if ((int8_t)(record->generation-getRecord(other)->generation) > 0) {
+         markDeleted(other);
+         slotStates[slot] = Slot_Live;
+         slotOfId[record->id] = slot;
+      }
+      else {
+         markDeleted(slot);
+      }
+   }
+}
+
+/**
+ * Get number of profiles in library
+ *
+ * @return Number of profiles
+ */
+unsigned getCount() {
+   return count;
+}
+
+/**
+ * Find profile in library - O(1)
+ *
+ * @param[in] id Profile id
+ *
+ * @return Record in flash or nullptr if not present
+ */
+const Record *find(unsigned id) {
+   if ((id == 0) || (id > MAX_ID) || (slotOfId[id] == NO_SLOT)) {
+      return nullptr;
+   }
+   return getRecord(slotOfId[id]);
+}
+
+/**
+ * Copy profile to RAM working copy
+ *
+ * @param[in]  id      Profile id
+ * @param[out] profile Profile copied to
+ *
+ * @return true  Profile copied
+ * @return false Profile not present
+ */
+bool load(unsigned id, SolderProfile &profile) {
+   const Record *record = find(id);
+   if ((record == nullptr) || (record->checksum != calculateChecksum(*record))) {
+      return false;
+   }
+   memcpy(static_cast<void *>(&profile), &record->profile, sizeof(profile));
+   return true;
+}
+
+/**
+ * Add profile to library replacing any existing profile with the same id
+ *
+ * @param[in] id      Profile id (1..MAX_ID)
+ * @param[in] profile Profile to add
+ *
+ * @return true  Profile added
+ * @return false Illegal id, library full or flash failure
+ */
+bool store(unsigned id, const SolderProfile &profile) {
+   if ((id == 0) || (id > MAX_ID)) {
+      return false;
+   }
+   // Keep a sector of free slots for compaction
+   while (freeSlots <= SLOTS_PER_SECTOR) {
+      if (!compact()) {
+         return false;
+      }
+   }
+   const Record *oldRecord = find(id);
+
+   memset(static_cast<void *>(&newRecord), 0xFF, sizeof(newRecord));
+   newRecord.id         = id;
+   newRecord.generation = (oldRecord == nullptr)?0:oldRecord->generation+1;
+   memcpy(static_cast<void *>(&newRecord.profile), &profile, sizeof(newRecord.profile));
+   newRecord.nameHash   = hashName(newRecord.profile.description);
+   newRecord.checksum   = calculateChecksum(newRecord);
+
+   unsigned slot = findFreeSlot();
+   if (!programRecord(slot, newRecord)) {
+      return false;
+   }
+   // New record is complete - old one may be discarded
+   if (oldRecord == nullptr) {
+      count++;
+   }
+   else {
+      markDeleted(slotOfId[id]);
+   }
+   slotOfId[id] = slot;
+   return true;
+}
+
+/**
+ * Delete profile from library
+ *
+ * @param[in] id Profile id
+ *
+ * @return true  Profile deleted
+ * @return false Profile not present or flash failure
+ */
+bool remove(unsigned id) {
+   if (find(id) == nullptr) {
+      return false;
+   }
+   unsigned slot = slotOfId[id];
+   slotOfId[id] = NO_SLOT;
+   count--;
+   return markDeleted(slot);
+}
+
+/**
+ * Calculate hash of a profile description
+ *
+ * @param[in] name Description (need not be terminated if full length)
+ *
+ * @return Hash
+ */
+uint16_t hashName(const char (&name)[sizeof(SolderProfile::description)]) {
+   uint32_t crc = crc32(name, strnlen(name, sizeof(name)));
+   return (uint16_t)(crc^(crc>>16));
+}
+
+}; // namespace ProfileLibrary
@@ -0,0 +1,142 @@
+/**
+ * @file    profileLibrary.h
+ * @brief   Library of solder profiles in program flash
+ *
+ *  The 10 profiles in FlexRAM are the ones available from the front panel. The library holds
+ *  many more (e.g. the recipes for every board and paste) in the top of program flash.
+ *
+ *  Each profile is a fixed-size record in a slot. Records are identified by an id (1..MAX_ID)
+ *  and hold a hash of the description and a CRC-32 so a host can tell which profiles
+ *  need to be uploaded.
+ *
+ *  Flash can only be erased by sector so records are never changed in place:
+ *  - Adding or replacing a profile programs a new record in a free slot
+ *    (a replaced record is then marked as deleted)
+ *  - Deleting a profile programs the deleted word of its record
+ *  - When free slots run low, the live records of the sector with the most deleted records are
+ *    moved and the sector erased. One sector of free slots is kept for this.
+ *
+ *  The slot of each id is held in RAM so lookup is O(1). It is rebuilt from flash at start-up
+ *  when partial changes (from a power failure) are also tidied up.
+ *
+ *  Flash operations stop the processor for up to ~100 ms (sector erase) so the library must not
+ *  be changed while a profile is running. The library is only used by the remote thread.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+
+#ifndef SOURCES_PROFILELIBRARY_H_
+#define SOURCES_PROFILELIBRARY_H_
+
+#include <stdint.h>
+#include "SolderProfile.h"
+
+namespace ProfileLibrary {
+
+/** Size of library (see profileLibrary memory region in the linker script) */
+constexpr unsigned LIBRARY_SIZE    = 0x4000;
+
+/** Size of a flash sector */
+constexpr unsigned SECTOR_SIZE     = 2048;
+
+/** Size of slot holding a record */
+constexpr unsigned SLOT_SIZE       = 128;
+
+/** Number of sectors */
+constexpr unsigned NUM_SECTORS     = LIBRARY_SIZE/SECTOR_SIZE;
+
+/** Number of slots in a sector */
+constexpr unsigned SLOTS_PER_SECTOR = SECTOR_SIZE/SLOT_SIZE;
+
+/** Number of slots */
+constexpr unsigned NUM_SLOTS       = LIBRARY_SIZE/SLOT_SIZE;
+
+/** Largest profile id (ids are 1..MAX_ID) */
+constexpr unsigned MAX_ID          = 100;
+
+static_assert((MAX_ID+SLOTS_PER_SECTOR) < NUM_SLOTS, "Library too small for MAX_ID profiles");
+static_assert(NUM_SLOTS < 255, "Slot numbers must fit in uint8_t");
+
+/**
+ * Profile record as held in flash
+ */
+struct Record {
+   uint8_t       id;            // Profile id (1..MAX_ID) - 0xFF if slot is unused
+   uint8_t       generation;    // Incremented when a profile is replaced (newer record wins after a power failure)
+   uint16_t      nameHash;      // Hash of the description (see hashName())
+   uint32_t      checksum;      // CRC-32 of the record up to unused (excluding checksum)
+   SolderProfile profile;       // The profile
+   uint8_t       unused[SLOT_SIZE-8-sizeof(SolderProfile)-4]; // Left erased
+   uint32_t      deleted;       // Erased (0xFFFFFFFF) while the record is in use
+};
+
+static_assert(sizeof(Record) == SLOT_SIZE, "Record doesn't fill slot");
+static_assert((sizeof(SolderProfile)%4) == 0, "Record must be a multiple of flash phrase size");
+
+/**
+ * Build the index from flash\n
+ * Must be called once at start-up before the library is used.
+ */
+void initialise();
+
+/**
+ * Get number of profiles in library
+ *
+ * @return Number of profiles
+ */
+unsigned getCount();
+
+/**
+ * Find profile in library - O(1)
+ *
+ * @param[in] id Profile id
+ *
+ * @return Record in flash or nullptr if not present
+ */
+const Record *find(unsigned id);
+
+/**
+ * Copy profile to RAM working copy
+ *
+ * @param[in]  id      Profile id
+ * @param[out] profile Profile copied to
+ *
+ * @return true  Profile copied
+ * @return false Profile not present
+ */
+bool load(unsigned id, SolderProfile &profile);
+
+/**
+ * Add profile to library replacing any existing profile with the same id
+ *
+ * @param[in] id      Profile id (1..MAX_ID)
+ * @param[in] profile Profile to add
+ *
+ * @return true  Profile added
+ * @return false Illegal id, library full or flash failure
+ */
+bool store(unsigned id, const SolderProfile &profile);
+
+/**
+ * Delete profile from library
+ *
+ * @param[in] id Profile id
+ *
+ * @return true  Profile deleted
+ * @return false Profile not present or flash failure
+ */
+bool remove(unsigned id);
+
+/**
+ * Calculate hash of a profile description
+ *
+ * @param[in] name Description (need not be terminated if full length)
+ *
+ * @return Hash
+ */
+uint16_t hashName(const char (&name)[sizeof(SolderProfile::description)]);
+
+}; // namespace ProfileLibrary
+
+#endif /* SOURCES_PROFILELIBRARY_H_ */
@@ -0,0 +1,216 @@
+/**
+ * @file    profileProgram.cpp
+ * @brief   Segment-based oven program (sequence of steps)
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <math.h>
+#include "configure.h"
+#include "dataPoint.h"
+#include "profileProgram.h"
+
+/**
+ * Get slope needed to change temperature in a time
+ *
+ * @param[in] change Temperature change (Celsius)
+ * @param[in] time   Time for change (s)
+ *
+ * @return Slope (Celsius/s) - 0 (step change) if time is not positive
+ */
+static float slopeFor(float change, float time) {
+   return (time > 0)?fabsf(change)/time:0;
+}
+
+/**
+ * Set program to the equivalent of a solder profile\n
+ * preheat, soak, ramp up, dwell and ramp down each become a Ramp (or Hold) step followed by
+ * a Wait step with the timeout used by the original state machine.
+ * A stored profile that fails SolderProfile::isValid() (zero time or slope) is converted
+ * with step changes and no timeouts rather than dividing by zero.
+ *
+ * @param[in] profile Profile to convert
+ * @param[in] ambient Starting temperature of oven (Celsius)
+ */
+void ProfileProgram::convert(const SolderProfile &profile, float ambient) {
+   strncpy(name, profile.description, sizeof(name)-1);
+   name[sizeof(name)-1] = '\0';
+   count = 0;
+
+   // Ambient -> soakTemp1 over preheatTime, wait up to 10% longer to reach it
+   add(ProfileStep{Step_Ramp, s_preheat, (int16_t)profile.soakTemp1,
+      slopeFor(profile.soakTemp1-ambient, profile.preheatTime)});
+   add(ProfileStep{Step_Wait, s_preheat, (int16_t)profile.soakTemp1, 0.1f*profile.preheatTime});
+
+   // soakTemp1 -> soakTemp2 over soakTime, wait up to 20% longer to reach it
+   add(ProfileStep{Step_Ramp, s_soak, (int16_t)profile.soakTemp2,
+      slopeFor(profile.soakTemp2-profile.soakTemp1, profile.soakTime)});
+   add(ProfileStep{Step_Wait, s_soak, (int16_t)profile.soakTemp2, 0.2f*profile.soakTime});
+
+   // soakTemp2 -> peakTemp @ rampUpSlope, wait up to 100% longer (the oven really can't cope with the ramp)
+   bool rampValid = (profile.rampUpSlope > 0);
+   add(ProfileStep{Step_Ramp, s_ramp_up, (int16_t)profile.peakTemp, rampValid?profile.rampUpSlope:0});
+   add(ProfileStep{Step_Wait, s_ramp_up, (int16_t)profile.peakTemp,
+      rampValid?(profile.peakTemp-profile.soakTemp2)/profile.rampUpSlope:0});
+
+   // peakTemp for peakDwell
+   add(ProfileStep{Step_Hold, s_dwell, 0, (float)profile.peakDwell});
+
+   // peakTemp -> ambient @ rampDownSlope, complete when cooled to near ambient
+   add(ProfileStep{Step_Ramp, s_ramp_down, (int16_t)roundf(ambient), fabsf(profile.rampDownSlope)});
+   add(ProfileStep{Step_Wait, s_ramp_down, (int16_t)(roundf(ambient)+COOL_MARGIN-WAIT_TOLERANCE), 0});
+}
+
+/**
+ * Check if the program may be run\n
+ * Used to check uploaded programs
+ *
+ * @return true if program has at least one step and all steps have legal values
+ */
+bool ProfileProgram::isValid() const {
+   if ((count == 0) || (count > MAX_STEPS)) {
+      return false;
+   }
+   for (unsigned index=0; index<count; index++) {
+      const ProfileStep &step = steps[index];
+      if ((step.state < s_preheat) || (step.state > s_ramp_down) || !isfinite(step.value) || (step.value < 0)) {
+         return false;
+      }
+      switch(step.type) {
+         case Step_Ramp:
+         case Step_Wait:
+            if ((step.temperature < 0) || (step.temperature > MAX_TEMPERATURE)) {
+               return false;
+            }
+            break;
+         case Step_Hold:
+            break;
+         case Step_Fan:
+            if (step.value > 100) {
+               return false;
+            }
+            break;
+         default:
+            return false;
+      }
+   }
+   return true;
+}
+
+/**
+ * Set program to the equivalent of a solder profile in nonvolatile memory\n
+ * The profile is read as a consistent snapshot (see configLock)
+ *
+ * @param[in] profile Profile to convert
+ * @param[in] ambient Starting temperature of oven (Celsius)
+ */
+void ProfileProgram::convert(const NvSolderProfile &profile, float ambient) {
+   SolderProfile snapshot;
+   uint32_t sequence;
+   do {
+      sequence = configLock.beginRead();
+      snapshot = profile;
+   } while (configLock.retryRead(sequence));
+   convert(snapshot, ambient);
+}
+
+/**
+ * PCB moisture bake-out - 125C for 4 hours (J-STD-033 style)
+ */
+static const ProfileProgram bakeOutRecipe {
+   /* name  */ "PCB BAKE-OUT 125C 4H",
+   /* count */ 7,
+   /* steps */ {
+      {Step_Fan,  s_preheat,   0,      30},
+      {Step_Ramp, s_preheat,   125,    1.0f},
+      {Step_Wait, s_preheat,   125,    300},
+      {Step_Hold, s_soak,      0,      4*60*60},
+      {Step_Fan,  s_ramp_down, 0,      100},
+      {Step_Ramp, s_ramp_down, 50,     1.0f},
+      {Step_Wait, s_ramp_down, 50,     0},
+   },
+};
+
+/**
+ * Component bake-out at low temperature - 90C for 8 hours
+ */
+static const ProfileProgram lowBakeRecipe {
+   /* name  */ "LOW-TEMP BAKE 90C 8H",
+   /* count */ 7,
+   /* steps */ {
+      {Step_Fan,  s_preheat,   0,      30},
+      {Step_Ramp, s_preheat,   90,     1.0f},
+      {Step_Wait, s_preheat,   90,     300},
+      {Step_Hold, s_soak,      0,      8*60*60},
+      {Step_Fan,  s_ramp_down, 0,      100},
+      {Step_Ramp, s_ramp_down, 50,     1.0f},
+      {Step_Wait, s_ramp_down, 50,     0},
+   },
+};
+
+/**
+ * SMT adhesive cure - staged heating to 150C, held for 120 s
+ */
+static const ProfileProgram adhesiveCureRecipe {
+   /* name  */ "SMT ADHESIVE CURE 150C",
+   /* count */ 9,
+   /* steps */ {
+      {Step_Ramp, s_preheat,   100,    1.5f},
+      {Step_Wait, s_preheat,   100,    60},
+      {Step_Hold, s_soak,      0,      60},
+      {Step_Ramp, s_ramp_up,   150,    1.0f},
+      {Step_Wait, s_ramp_up,   150,    60},
+      {Step_Hold, s_dwell,     0,      120},
+      {Step_Fan,  s_ramp_down, 0,      100},
+      {Step_Ramp, s_ramp_down, 60,     2.0f},
+      {Step_Wait, s_ramp_down, 60,     0},
+   },
+};
+
+/** Built-in recipes */
+static const ProfileProgram *const builtinRecipes[] = {
+      &bakeOutRecipe,
+      &lowBakeRecipe,
+      &adhesiveCureRecipe,
+};
+
+/** Number of built-in recipes */
+static constexpr unsigned BUILTIN_COUNT = sizeof(builtinRecipes)/sizeof(builtinRecipes[0]);
+
+/** Recipe uploaded by remote interface (count is 0 if none) */
+static ProfileProgram uploadedRecipe;
+
+/**
+ * Get number of recipes (built-in recipes followed by the uploaded recipe if any)
+ *
+ * @return Number of recipes
+ */
+unsigned ProfileProgram::getRecipeCount() {
+   return BUILTIN_COUNT+((uploadedRecipe.count>0)?1:0);
+}
+
+/**
+ * Get recipe
+ *
+ * @param[in] index Index of recipe
+ *
+ * @return Recipe
+ */
+const ProfileProgram &ProfileProgram::getRecipe(unsigned index) {
+   usbdm_assert(index<getRecipeCount(), "Illegal recipe index");
+   if (index >= BUILTIN_COUNT) {
+      return uploadedRecipe;
+   }
+   return *builtinRecipes[index];
+}
+
+/**
+ * Set uploaded recipe\n
+ * This replaces any earlier uploaded recipe. A run already started is not affected.
+ *
+ * @param[in] program Program to use (must be valid)
+ */
+void ProfileProgram::setUploaded(const ProfileProgram &program) {
+   usbdm_assert(program.isValid(), "Invalid program");
+   uploadedRecipe = program;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file    profileProgram.h
+ * @brief   Segment-based oven program (sequence of steps)
+ *
+ *  A program is a list of steps executed in order by RunProfile:
+ *  - Ramp  Move the set-point to a temperature limited to a slope
+ *  - Hold  Keep the set-point for a time
+ *  - Wait  Wait until the oven reaches a temperature (fails on timeout)
+ *  - Fan   Set the minimum fan speed for the rest of the program
+ *
+ *  A SolderProfile is converted to the equivalent program when it is run so existing
+ *  profiles behave as before. Built-in recipes (e.g. bake-out, cure) are held in ROM.
+ *  One further recipe may be uploaded by the remote interface (PROG command). It follows
+ *  the built-in recipes and is held in RAM until reset.
+ *
+ *  Each step records the State reported while it runs so logging, plotting and
+ *  the remote interface are unchanged.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+
+#ifndef SOURCES_PROFILEPROGRAM_H_
+#define SOURCES_PROFILEPROGRAM_H_
+
+#include <stdint.h>
+#include "SolderProfile.h"
+
+/**
+ * Type of program step
+ */
+enum StepType : uint8_t {
+   Step_Ramp,  //!< Ramp set-point to temperature with slope limit of value (Celsius/s, 0 => step change)
+   Step_Hold,  //!< Hold set-point for value seconds
+   Step_Wait,  //!< Wait until oven reaches temperature with timeout of value seconds (0 => none)
+   Step_Fan,   //!< Set minimum fan speed to value percent
+};
+
+/**
+ * Step in a program
+ */
+struct ProfileStep {
+   StepType type;           // Type of step
+   uint8_t  state;          // State reported while step is running (s_preheat..s_ramp_down)
+   int16_t  temperature;    // Target temperature for Ramp and Wait steps (Celsius)
+   float    value;          // Slope, duration, timeout or fan speed (see StepType)
+};
+
+/**
+ * Program of steps
+ */
+class ProfileProgram {
+
+public:
+   /** Maximum number of steps in a program */
+   static constexpr unsigned MAX_STEPS = 24;
+
+   /** Tolerance used by Wait steps (Celsius) */
+   static constexpr int WAIT_TOLERANCE = 2;
+
+   /** Program is complete when a converted profile has cooled to this much above ambient (Celsius) */
+   static constexpr int COOL_MARGIN = 20;
+
+   /** Highest temperature an uploaded program may use (Celsius) */
+   static constexpr int MAX_TEMPERATURE = 300;
+
+   char         name[sizeof(SolderProfile::description)];  // Description of the program
+   unsigned     count;                                     // Number of steps used
+   ProfileStep  steps[MAX_STEPS];                          // Steps in execution order
+
+   /**
+    * Get step
+    *
+    * @param[in] index Index of step
+    *
+    * @return Step
+    */
+   const ProfileStep &operator[](unsigned index) const {
+      usbdm_assert(index<count, "Illegal step index");
+      return steps[index];
+   }
+
+   /**
+    * Add step to end of program
+    *
+    * @param[in] step Step to add
+    *
+    * @return true  Step added
+    * @return false Program is full
+    */
+   bool add(const ProfileStep &step) {
+      if (count >= MAX_STEPS) {
+         return false;
+      }
+      steps[count++] = step;
+      return true;
+   }
+
+   /**
+    * Check if the program may be run\n
+    * Used to check uploaded programs
+    *
+    * @return true if program has at least one step and all steps have legal values
+    */
+   bool isValid() const;
+
+   /**
+    * Set program to the equivalent of a solder profile\n
+    * preheat, soak, ramp up, dwell and ramp down each become a Ramp (or Hold) step followed by
+    * a Wait step with the timeout used by the original state machine.
+    *
+    * @param[in] profile Profile to convert
+    * @param[in] ambient Starting temperature of oven (Celsius)
+    */
+   void convert(const SolderProfile &profile, float ambient);
+
+   /**
+    * Set program to the equivalent of a solder profile in nonvolatile memory\n
+    * The profile is read as a consistent snapshot (see configLock)
+    *
+    * @param[in] profile Profile to convert
+    * @param[in] ambient Starting temperature of oven (Celsius)
+    */
+   void convert(const NvSolderProfile &profile, float ambient);
+
+   /**
+    * Get number of recipes (built-in recipes followed by the uploaded recipe if any)
+    *
+    * @return Number of recipes
+    */
+   static unsigned getRecipeCount();
+
+   /**
+    * Get recipe
+    *
+    * @param[in] index Index of recipe
+    *
+    * @return Recipe
+    */
+   static const ProfileProgram &getRecipe(unsigned index);
+
+   /**
+    * Set uploaded recipe\n
+    * This replaces any earlier uploaded recipe. A run already started is not affected.
+    *
+    * @param[in] program Program to use (must be valid)
+    */
+   static void setUploaded(const ProfileProgram &program);
+};
+
+#endif /* SOURCES_PROFILEPROGRAM_H_ */
@@ -0,0 +1,153 @@
+/**
+ * @file    profileTrajectory.cpp
+ * @brief   Set-point trajectory compiled from a profile program
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <math.h>
+#include "configure.h"
+#include "profileTrajectory.h"
+
+/**
+ * Set segment to move between temperatures over a time
+ *
+ * @param[out] segment          Segment to set
+ * @param[in]  startTime        Time of start of segment (s)
+ * @param[in]  startTemperature Starting temperature (Celsius)
+ * @param[in]  endTemperature   Final temperature (Celsius)
+ * @param[in]  duration         Length of segment (s)
+ *
+ * @return Time of end of segment (s)
+ */
+static float setSegment(ProfileTrajectory::Segment &segment, float startTime,
+      float startTemperature, float endTemperature, float duration) {
+   if (!(duration > 0) || !isfinite(duration)) {
+      // Step change (or invalid slope)
+      duration = 0;
+   }
+   segment.startTime        = startTime;
+   segment.duration         = duration;
+   segment.startTemperature = startTemperature;
+   segment.endTemperature   = endTemperature;
+   segment.slope            = (duration > 0)?(endTemperature-startTemperature)/duration:0;
+   return startTime+duration;
+}
+
+/**
+ * Compile program into trajectory
+ *
+ * @param[in] program Program to compile
+ * @param[in] ambient Starting temperature of oven (Celsius)
+ */
+void ProfileTrajectory::compile(const ProfileProgram &program, float ambient) {
+   this->ambient = ambient;
+   cursor        = 0;
+   count         = program.count;
+
+   float time        = 0;
+   float temperature = ambient;
+
+   for (unsigned index=0; index<count; index++) {
+      const ProfileStep &step = program[index];
+      switch(step.type) {
+         case Step_Ramp:
+            // temperature -> step.temperature @ step.value
+            time = setSegment(segments[index], time, temperature, step.temperature,
+                  fabsf(step.temperature-temperature)/step.value);
+            temperature = step.temperature;
+            break;
+         case Step_Hold:
+            // temperature for step.value
+            time = setSegment(segments[index], time, temperature, temperature, step.value);
+            break;
+         case Step_Wait:
+         case Step_Fan:
+            // No change of set-point and nominally no time
+            time = setSegment(segments[index], time, temperature, temperature, 0);
+            break;
+      }
+   }
+}
+
+/**
+ * Evaluate set-point at a time from the start of the profile\n
+ * This assumes each step takes its nominal time
+ *
+ * @param[in] time Time from start of profile (s)
+ *
+ * @return Set-point (Celsius)
+ */
+float ProfileTrajectory::evaluate(float time) const {
+   // Start from segment found last time - usually this or the next segment
+   if (count == 0) {
+      return ambient;
+   }
+   unsigned index = cursor;
+   if (time < segments[index].startTime) {
+      index = 0;
+   }
+   while (((index+1) < count) && (time >= segments[index+1].startTime)) {
+      index++;
+   }
+   cursor = index;
+   return segments[index].evaluate(time-segments[index].startTime);
+}
+
+/**
+ * Predict set-point a time ahead of a position in the program\n
+ * Later steps are assumed to take their nominal time (Wait steps are already satisfied)
+ *
+ * @param[in]  index   Index of current step
+ * @param[in]  elapsed Time since the start of the current step plus time ahead (s)
+ * @param[out] slope   Rate of change of set-point at that time (Celsius/s)
+ *
+ * @return Set-point (Celsius)
+ */
+float ProfileTrajectory::predict(unsigned index, float elapsed, float &slope) const {
+   if (index >= count) {
+      slope = 0;
+      return (count == 0)?ambient:segments[count-1].endTemperature;
+   }
+   // Move forward while past the end of the segment
+   while (((index+1) < count) && (elapsed >= segments[index].duration)) {
+      elapsed -= segments[index].duration;
+      index++;
+   }
+   slope = segments[index].slopeAt(elapsed);
+   return segments[index].evaluate(elapsed);
+}
+
+/**
+ * Get trajectory of a profile at NOMINAL_AMBIENT (for preview)\n
+ * The compiled trajectory is cached and recompiled only if the profile
+ * selected changes or any profile is edited.
+ *
+ * @param[in] profileIndex Index of profile
+ *
+ * @return Compiled trajectory
+ */
+const ProfileTrajectory &ProfileTrajectory::getNominal(unsigned profileIndex) {
+   /** Cached trajectory */
+   static ProfileTrajectory trajectory;
+
+   /** Program converted from profile (static as it is large) */
+   static ProfileProgram program;
+
+   /** Profile the cached trajectory was compiled from (MAX_PROFILES => none) */
+   static unsigned cachedIndex = MAX_PROFILES;
+
+   /** Value of configLock when trajectory was compiled - any edit changes this */
+   static uint32_t cachedSequence;
+
+   usbdm_assert(profileIndex<MAX_PROFILES, "Illegal profile index");
+
+   uint32_t sequence = configLock.beginRead();
+   if ((profileIndex != cachedIndex) || (sequence != cachedSequence)) {
+      program.convert(profiles[profileIndex], NOMINAL_AMBIENT);
+      trajectory.compile(program, NOMINAL_AMBIENT);
+      cachedIndex    = profileIndex;
+      cachedSequence = sequence;
+   }
+   return trajectory;
+}
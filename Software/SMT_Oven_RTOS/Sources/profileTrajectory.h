@@ -0,0 +1,162 @@
+/**
+ * @file    profileTrajectory.h
+ * @brief   Set-point trajectory compiled from a profile program
+ *
+ *  A program is compiled into one linear segment per step. Ramp and Hold steps take time,
+ *  Wait and Fan steps have zero nominal length. The same trajectory is used by the
+ *  controller (RunProfile) and the profile preview (Draw) so they cannot disagree.
+ *
+ *  Evaluation is O(1):
+ *  - Within a step the set-point is start + slope*elapsed (clamped to the step).
+ *  - At an absolute time the containing segment is found from the previous evaluation
+ *    so sequential evaluation does not search.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+
+#ifndef SOURCES_PROFILETRAJECTORY_H_
+#define SOURCES_PROFILETRAJECTORY_H_
+
+#include "SolderProfile.h"
+#include "profileProgram.h"
+
+class ProfileTrajectory {
+
+public:
+   /** Ambient temperature assumed when previewing a profile (Celsius) */
+   static constexpr float NOMINAL_AMBIENT = 25.0f;
+
+   /**
+    * Linear segment of trajectory
+    */
+   struct Segment {
+      float startTime;          // Time from start of profile (s)
+      float duration;           // Length of segment (s)
+      float startTemperature;   // Set-point at start of segment (Celsius)
+      float endTemperature;     // Set-point at end of segment (Celsius)
+      float slope;              // Rate of change of set-point (Celsius/s)
+
+      /**
+       * Evaluate set-point within segment
+       *
+       * @param[in] elapsed Time from start of segment (s) - clamped to the segment
+       *
+       * @return Set-point (Celsius)
+       */
+      float evaluate(float elapsed) const {
+         if (elapsed <= 0) {
+            return startTemperature;
+         }
+         if (elapsed >= duration) {
+            return endTemperature;
+         }
+         return startTemperature + slope*elapsed;
+      }
+
+      /**
+       * Get rate of change of set-point within segment
+       *
+       * @param[in] elapsed Time from start of segment (s)
+       *
+       * @return Slope (Celsius/s) - 0 outside the segment
+       */
+      float slopeAt(float elapsed) const {
+         return ((elapsed >= 0) && (elapsed < duration))?slope:0;
+      }
+   };
+
+private:
+   /** Segments in step order */
+   Segment segments[ProfileProgram::MAX_STEPS];
+
+   /** Number of segments used */
+   unsigned count = 0;
+
+   /** Ambient temperature used to compile trajectory */
+   float ambient = NOMINAL_AMBIENT;
+
+   /** Segment found by last evaluation at an absolute time */
+   mutable unsigned cursor = 0;
+
+public:
+   constexpr ProfileTrajectory() : segments{} {
+   }
+
+   /**
+    * Compile program into trajectory
+    *
+    * @param[in] program Program to compile
+    * @param[in] ambient Starting temperature of oven (Celsius)
+    */
+   void compile(const ProfileProgram &program, float ambient);
+
+   /**
+    * Get segment for a step
+    *
+    * @param[in] index Index of step in program
+    *
+    * @return Segment
+    */
+   const Segment &getSegment(unsigned index) const {
+      usbdm_assert(index<count, "Illegal step for trajectory");
+      return segments[index];
+   }
+
+   /**
+    * Predict set-point a time ahead of a position in the program\n
+    * Later steps are assumed to take their nominal time (Wait steps are already satisfied)
+    *
+    * @param[in]  index   Index of current step
+    * @param[in]  elapsed Time since the start of the current step plus time ahead (s)
+    * @param[out] slope   Rate of change of set-point at that time (Celsius/s)
+    *
+    * @return Set-point (Celsius)
+    */
+   float predict(unsigned index, float elapsed, float &slope) const;
+
+   /**
+    * Evaluate set-point at a time from the start of the profile\n
+    * This assumes each step takes its nominal time
+    *
+    * @param[in] time Time from start of profile (s)
+    *
+    * @return Set-point (Celsius)
+    */
+   float evaluate(float time) const;
+
+   /**
+    * Get nominal length of the entire profile
+    *
+    * @return Duration (s)
+    */
+   float getDuration() const {
+      if (count == 0) {
+         return 0;
+      }
+      const Segment &last = segments[count-1];
+      return last.startTime + last.duration;
+   }
+
+   /**
+    * Get ambient temperature used to compile trajectory
+    *
+    * @return Temperature (Celsius)
+    */
+   float getAmbient() const {
+      return ambient;
+   }
+
+   /**
+    * Get trajectory of a profile at NOMINAL_AMBIENT (for preview)\n
+    * The compiled trajectory is cached and recompiled only if the profile
+    * selected changes or any profile is edited.
+    *
+    * @param[in] profileIndex Index of profile
+    *
+    * @return Compiled trajectory
+    */
+   static const ProfileTrajectory &getNominal(unsigned profileIndex);
+};
+
+#endif /* SOURCES_PROFILETRAJECTORY_H_ */
@@ -0,0 +1,114 @@
+/**
+ * @file    relayTuner.cpp
+ * @brief   Relay feedback (Astrom-Hagglund) identification of the oven
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <math.h>
+#include "relayTuner.h"
+
+/**
+ * Process temperature sample and get heater output
+ *
+ * @param[in] time        Time since start of tuning (s)
+ * @param[in] temperature Oven temperature (Celsius, NAN on sensor failure)
+ *
+ * @return Heater output (%) - 0 once tuning is complete or failed
+ */
+float RelayTuner::update(float time, float temperature) {
+   if (status != Tune_Running) {
+      return 0;
+   }
+   if (isnan(temperature) || (time > timeout)) {
+      status = Tune_Failed;
+      return 0;
+   }
+   // Accumulate the output applied since the last sample
+   float interval = time - lastTime;
+   lastTime = time;
+   if (cycles >= 2) {
+      sumTemperature += temperature*interval;
+      sumOutput      += (relayHigh?outputHigh:outputLow)*interval;
+      sumTime        += interval;
+   }
+   if (temperature > maximum) {
+      maximum = temperature;
+   }
+   if (temperature < minimum) {
+      minimum = temperature;
+   }
+   // Relay with hysteresis
+   if (relayHigh && (temperature > (setpoint+hysteresis))) {
+      relayHigh = false;
+   }
+   else if (!relayHigh && (temperature < (setpoint-hysteresis))) {
+      relayHigh = true;
+
+      // Rising switch - end of a cycle
+      if (cycles == 1) {
+         // First full cycle is discarded (settling after heating up)
+         cycleStart = time;
+      }
+      else if (cycles >= 2) {
+         sumMaximum += maximum;
+         sumMinimum += minimum;
+      }
+      cycles++;
+      maximum = temperature;
+      minimum = temperature;
+      if (cycles == (NUM_CYCLES+2)) {
+         calculate(time);
+         return 0;
+      }
+   }
+   return relayHigh?outputHigh:outputLow;
+}
+
+/**
+ * Calculate result from measured cycles
+ *
+ * @param[in] time Time of final switch (s)
+ */
+void RelayTuner::calculate(float time) {
+   constexpr float PI = 3.14159265f;
+
+   float period    = (time-cycleStart)/NUM_CYCLES;
+   float peak      = (sumMaximum/NUM_CYCLES)-setpoint;
+   float trough    = (sumMinimum/NUM_CYCLES)-setpoint;
+   float amplitude = (peak-trough)/2;
+   float relay     = (outputHigh-outputLow)/2;
+
+   if (!(period > 0) || !(amplitude > hysteresis) || !(sumOutput > 0)) {
+      // Oscillation too small to measure
+      status = Tune_Failed;
+      return;
+   }
+   result.ultimatePeriod = period;
+   result.amplitude      = amplitude;
+   result.ultimateGain   = (4*relay)/(PI*sqrtf(amplitude*amplitude-hysteresis*hysteresis));
+
+   // First-order-plus-dead-time model
+   float gain  = ((sumTemperature/sumTime)-ambient)/(sumOutput/sumTime);
+   float above = (gain*outputHigh+ambient)-setpoint;
+   float below = setpoint-(gain*outputLow+ambient);
+   if (!(above > peak) || !(below > -trough)) {
+      // Oscillation is not consistent with the model
+      status = Tune_Failed;
+      return;
+   }
+   float ratio = logf((above+below-2*hysteresis)/(above+below-(peak-trough)));
+   float logs  = logf((above-trough)/(above-hysteresis)) + logf((below+peak)/(below-hysteresis));
+   result.processGain  = gain;
+   result.timeConstant = period/(2*ratio+logs);
+   result.deadTime     = ratio*result.timeConstant;
+
+   // Tyreus-Luyben
+   float ti  = 2.2f*period;
+   float td  = period/6.3f;
+   result.kp = result.ultimateGain/2.2f;
+   result.ki = result.kp/ti;
+   result.kd = result.kp*td;
+
+   status = Tune_Complete;
+}
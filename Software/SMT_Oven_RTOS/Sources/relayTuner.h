@@ -0,0 +1,161 @@
+/**
+ * @file    relayTuner.h
+ * @brief   Relay feedback (Astrom-Hagglund) identification of the oven
+ *
+ *  The heater is switched between two levels around a set-point so the oven oscillates
+ *  at its ultimate period. From the amplitude and period of the oscillation:
+ *
+ *   Ku = 4d / (pi * sqrt(a^2 - h^2))     (d = half relay swing, a = amplitude, h = hysteresis)
+ *   Pu = period of oscillation
+ *
+ *  A first-order-plus-dead-time model is fitted to the same data. The static gain is
+ *
+ *   K = (mean temperature - ambient) / mean heater
+ *
+ *  With the heater high (low) the oven heads for a temperature A above (B below) the set-point.
+ *  The relay switches at +/-h but the oven continues for the dead time L so the peak P and
+ *  trough Q (relative to the set-point) and the period give
+ *
+ *   L/tau = ln((A+B-2h) / (A+B-(P-Q)))
+ *   Pu    = 2L + tau*(ln((A-Q)/(A-h)) + ln((B+P)/(B-h)))
+ *
+ *  This is exact for a first-order-plus-dead-time plant (the describing function used for Ku
+ *  is not, as the oscillation is far from sinusoidal).
+ *
+ *  PID gains use the Tyreus-Luyben rules (less overshoot than Ziegler-Nichols which suits
+ *  the slow, lag-dominated oven):
+ *
+ *   Kp = Ku/2.2, Ti = 2.2*Pu, Td = Pu/6.3
+ *
+ *  This class has no hardware dependencies so it can be run against a plant model on a host.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+
+#ifndef SOURCES_RELAYTUNER_H_
+#define SOURCES_RELAYTUNER_H_
+
+class RelayTuner {
+
+public:
+   /** Number of oscillation cycles averaged (after the first which is discarded) */
+   static constexpr unsigned NUM_CYCLES = 4;
+
+   /**
+    * Progress of tuning
+    */
+   enum Status {
+      Tune_Running,   //!< Oscillation being measured
+      Tune_Complete,  //!< Result available
+      Tune_Failed,    //!< Timeout, sensor failure or oscillation too small
+   };
+
+   /**
+    * Identified oven model and PID gains
+    */
+   struct Result {
+      float ultimateGain;     // Ku (%/Celsius)
+      float ultimatePeriod;   // Pu (s)
+      float amplitude;        // Amplitude of oscillation (Celsius)
+      float processGain;      // K, steady-state temperature rise per % heater (Celsius/%)
+      float timeConstant;     // tau (s)
+      float deadTime;         // L (s)
+      float kp;               // Proportional gain (%/Celsius)
+      float ki;               // Integral gain (%/(Celsius.s))
+      float kd;               // Differential gain (%.s/Celsius)
+   };
+
+private:
+   const float setpoint;      // Centre of oscillation (Celsius)
+   const float ambient;       // Temperature of oven at start (Celsius)
+   const float outputHigh;    // Heater when below set-point (%)
+   const float outputLow;     // Heater when above set-point (%)
+   const float hysteresis;    // Relay switches at setpoint +/- hysteresis (Celsius)
+   const float timeout;       // Maximum time for tuning (s)
+
+   Status status     = Tune_Running;
+   bool   relayHigh  = true;
+
+   /** Number of rising switches seen (cycle boundaries - measurement starts at the second) */
+   unsigned cycles   = 0;
+
+   /** Time of previous sample and of start of first measured cycle */
+   float lastTime    = 0;
+   float cycleStart  = 0;
+
+   /** Extremes of the current cycle */
+   float maximum     = 0;
+   float minimum     = 0;
+
+   /** Sums over the measured cycles */
+   float sumMaximum     = 0;
+   float sumMinimum     = 0;
+   float sumTemperature = 0;
+   float sumOutput      = 0;
+   float sumTime        = 0;
+
+   Result result     = {};
+
+   /**
+    * Calculate result from measured cycles
+    *
+    * @param[in] time Time of final switch (s)
+    */
+   void calculate(float time);
+
+public:
+   /**
+    * Constructor
+    *
+    * @param[in] setpoint     Centre of oscillation (Celsius)
+    * @param[in] ambient      Temperature of oven at start (Celsius)
+    * @param[in] outputHigh   Heater when below set-point (%)
+    * @param[in] outputLow    Heater when above set-point (%)
+    * @param[in] hysteresis   Relay switches at setpoint +/- hysteresis (Celsius)
+    * @param[in] timeout      Maximum time for tuning (s)
+    */
+   RelayTuner(float setpoint, float ambient, float outputHigh, float outputLow, float hysteresis, float timeout) :
+      setpoint(setpoint), ambient(ambient), outputHigh(outputHigh), outputLow(outputLow),
+      hysteresis(hysteresis), timeout(timeout) {
+   }
+
+   /**
+    * Process temperature sample and get heater output
+    *
+    * @param[in] time        Time since start of tuning (s)
+    * @param[in] temperature Oven temperature (Celsius, NAN on sensor failure)
+    *
+    * @return Heater output (%) - 0 once tuning is complete or failed
+    */
+   float update(float time, float temperature);
+
+   /**
+    * Get progress of tuning
+    *
+    * @return Status
+    */
+   Status getStatus() const {
+      return status;
+   }
+
+   /**
+    * Get number of complete cycles measured so far
+    *
+    * @return Cycles (0..NUM_CYCLES)
+    */
+   unsigned getCycles() const {
+      return (cycles>2)?(cycles-2):0;
+   }
+
+   /**
+    * Get result of tuning
+    *
+    * @return Result (only valid if status is Tune_Complete)
+    */
+   const Result &getResult() const {
+      return result;
+   }
+};
+
+#endif /* SOURCES_RELAYTUNER_H_ */
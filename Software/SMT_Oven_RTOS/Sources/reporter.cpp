@@ -11,6 +11,8 @@
 #include "plotting.h"
 #include "reporter.h"
 #include "RemoteInterface.h"
+#include "trace.h"
+#include "uiEvents.h"
 
 namespace Reporter {
 
@@ -69,6 +71,7 @@ static void writePlot() {
 /**
  * Record data point for logging.\n
  * Actual temperature information is obtained from the thermocouples.
+ * The display is notified (UiEvent_Data).
  *
  * @param[in] time  Time for report
  * @param[in] state State for report
@@ -82,6 +85,7 @@ void addLogPoint(int time, State state) {
    dataPoint.setHeater(ovenControl.getHeaterDutycycle());
    dataPoint.setFan(ovenControl.getFanDutycycle());
    Draw::addDataPoint(time, dataPoint);
+   UiEvents::post(UiEvents::UiEvent_Data);
 }
 
 /**
@@ -127,6 +131,8 @@ static void writeThermocoupleStatus() {
  * Reports thermocouple status on LCD
  */
 void displayProfileProgress() {
+   TRACE_SCOPE("display");
+
    switch(usePlot) {
       case DisplayPlot:
          writePlot();
@@ -169,10 +175,11 @@ void setDisplayFormat(DisplayMode mode) {
  * Set profile to use when plotting to LCD
  *
  * @param[in] profileIndex Index of profile to use
+ * @param[in] trajectory   Compiled profile being run
  */
-void setProfile(int profileIndex) {
+void setProfile(int profileIndex, const ProfileTrajectory &trajectory) {
    fProfile = profileIndex;
-   Draw::drawProfile(profileIndex);
+   Draw::drawProfile(profileIndex, trajectory);
 }
 
 }; // end namespace Reporter
@@ -10,6 +10,7 @@
 #define REPORTER_H_
 
 #include <dataPoint.h>
+#include "profileTrajectory.h"
 
 namespace Reporter {
 
@@ -75,8 +76,9 @@ void setPlotPrompt(void (*prompt)());
  * Set profile to use when plotting to LCD
  *
  * @param[in] profileIndex Index of profile to use
+ * @param[in] trajectory   Compiled profile being run
  */
-void setProfile(int profile);
+void setProfile(int profileIndex, const ProfileTrajectory &trajectory);
 
 /**
  * Reports thermocouple status on LCD
@@ -86,6 +88,7 @@ void displayProfileProgress();
 /**
  * Record data point for logging.\n
  * Actual temperature information is obtained from the thermocouples.
+ * The display is notified (UiEvent_Data).
  *
  * @param[in] time  Time for report
  * @param[in] state State for report
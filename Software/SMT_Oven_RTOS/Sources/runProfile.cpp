@@ -5,12 +5,17 @@
  *  Created on: 28 Sep 2016
  *      Author: podonoghue
  */
+#include "configCache.h"
 #include "configure.h"
 #include "copyProfile.h"
 #include "dataPoint.h"
 #include "EditProfile.h"
+#include "gainSchedule.h"
 #include "math.h"
 #include "plotting.h"
+#include "profileLibrary.h"
+#include "profileProgram.h"
+#include "profileTrajectory.h"
 #include "reporter.h"
 #include "RemoteInterface.h"
 #include "SolderProfile.h"
@@ -19,6 +24,8 @@
 #include "cmsis.h"
 #include "configure.h"
 #include "messageBox.h"
+#include "trace.h"
+#include "uiEvents.h"
 
 using namespace USBDM;
 using namespace std;
@@ -62,10 +69,10 @@ void monitor() {
       SwitchValue key = buttons.getButton(100);
 
       switch(key) {
-      case SwitchValue::SW_F1: temperatureSensors.getThermocouple(0).toggleEnable(); break;
-      case SwitchValue::SW_F2: temperatureSensors.getThermocouple(1).toggleEnable(); break;
-      case SwitchValue::SW_F3: temperatureSensors.getThermocouple(2).toggleEnable(); break;
-      case SwitchValue::SW_F4: temperatureSensors.getThermocouple(3).toggleEnable(); break;
+      case SwitchValue::SW_F1: temperatureSensors.getThermocouple(0).toggleEnable(); ConfigCache::refresh(); break;
+      case SwitchValue::SW_F2: temperatureSensors.getThermocouple(1).toggleEnable(); ConfigCache::refresh(); break;
+      case SwitchValue::SW_F3: temperatureSensors.getThermocouple(2).toggleEnable(); ConfigCache::refresh(); break;
+      case SwitchValue::SW_F4: temperatureSensors.getThermocouple(3).toggleEnable(); ConfigCache::refresh(); break;
       case SwitchValue::SW_S:
          return;
       default:
@@ -77,8 +84,14 @@ void monitor() {
 
 namespace RunProfile {
 
-/** Profile being run */
-static const NvSolderProfile *currentProfile;
+/** Program being run (converted from profile or copied from recipe when started) */
+static ProfileProgram program;
+
+/** Working copy of library profile being run (copied from flash when started) */
+static SolderProfile libraryProfile;
+
+/** Set-point trajectory of program being run (compiled when started) */
+static ProfileTrajectory trajectory;
 
 /** Time in the sequence (seconds) */
 static volatile int time;
@@ -89,11 +102,131 @@ static volatile float setpoint;
 /** Used to record ambient temperature at start (Celsius) */
 static float ambient;
 
-/** State in the profile sequence */
-static State state = s_off;
+/** State in the profile sequence (written by timer callback, read without locking by remote) */
+static volatile State state = s_off;
+
+/** Index of program step being executed */
+static unsigned stepIndex;
+
+/** Time at start of current step (seconds) */
+static int startOfStepTime;
+
+/** State that the current PID gains were scheduled for */
+static State scheduledState;
+
+/**
+ * Execute program steps for the current time\n
+ * A step that finishes moves straight on to the next step so zero-time steps
+ * (Fan or an already satisfied Wait) do not delay the program.
+ *
+ * @param[in] currentTemperature Current oven temperature
+ */
+static void executeSteps(float currentTemperature) {
+
+   while (stepIndex < program.count) {
+      const ProfileStep &step = program[stepIndex];
+      int elapsed = time-startOfStepTime;
+
+      state = (State)step.state;
+
+      switch(step.type) {
+         case Step_Ramp:
+         case Step_Hold: {
+            /*
+             * Set-point follows trajectory until the end of the step
+             */
+            const ProfileTrajectory::Segment &segment = trajectory.getSegment(stepIndex);
+            setpoint = segment.evaluate(elapsed);
+            pid.setSetpoint(setpoint);
+            if (elapsed < segment.duration) {
+               return;
+            }
+            break;
+         }
+         case Step_Wait: {
+            /*
+             * Wait until oven reaches temperature approaching from the set-point side
+             * This allows for tolerances in the PID controller
+             */
+            bool reached;
+            if (setpoint >= step.temperature) {
+               reached = currentTemperature >= (step.temperature-ProfileProgram::WAIT_TOLERANCE);
+            }
+            else {
+               reached = currentTemperature <= (step.temperature+ProfileProgram::WAIT_TOLERANCE);
+            }
+            if (!reached) {
+               if ((step.value > 0) && (elapsed > step.value)) {
+                  // Timeout
+                  state = s_fail;
+               }
+               return;
+            }
+            break;
+         }
+         case Step_Fan:
+            programFanSpeed = (int)step.value;
+            break;
+      }
+      // Step complete - start next step
+      stepIndex++;
+      startOfStepTime = time;
+   }
+   state = s_complete;
+}
+
+/**
+ * Update the feed-forward of the PID controller from the thermal model\n
+ * The heater duty needed to follow the set-point trajectory feedForwardLead seconds ahead is
+ * estimated from a first-order model of the oven:
+ *
+ *   duty = ((setpoint - ambient) + ovenTimeConstant * slope) / ovenGain
+ *
+ * so the heater is already driving the ramp when the set-point starts to move.
+ * The PID controller only corrects the error in the model.
+ *
+ * @param[in] config Settings snapshot
+ */
+static void updateFeedForward(const ConfigCache::Snapshot &config) {
+   float gain = config.ovenGain;
+   if (!(gain > 0)) {
+      // Feed-forward disabled
+      pid.setFeedForward(0);
+      return;
+   }
+   float slope;
+   float target = trajectory.predict(stepIndex, time-startOfStepTime+config.feedForwardLead, slope);
+   float duty   = ((target-ambient) + config.ovenTimeConstant*slope)/gain;
+
+   // Feed-forward only drives the heater - cooling is left to the controller
+   if (duty < 0) {
+      duty = 0;
+   }
+   else if (duty > 100) {
+      duty = 100;
+   }
+   pid.setFeedForward(duty);
+}
+
+/**
+ * Change PID gains to those scheduled for the current state\n
+ * Gains are only changed on a state transition and are changed bumplessly.
+ *
+ * @param[in] config Settings snapshot
+ */
+static void updateGains(const ConfigCache::Snapshot &config) {
+   State currentState = state;
+   if ((currentState == scheduledState) || !GainSchedule::isScheduled(currentState)) {
+      return;
+   }
+   const ConfigCache::Gains &gains = config.gains[currentState-GainSchedule::FIRST_STATE];
+   pid.setTuningsBumpless(gains.kp, gains.ki, gains.kd);
+   scheduledState = currentState;
+}
 
 /**
- * Call-back from the timer to step through the profile state-machine
+ * Call-back from the timer to step through the program\n
+ * A converted solder profile produces the usual sequence:
  *                    .---.
  *                   /     \
  *                  /       \
@@ -109,25 +242,18 @@ static State state = s_off;
  */
 static void handler(const void *) {
 //   PulseTp tp(12);
+   TRACE_SCOPE("profile");
 //   USBDM::console.write("Timer thread priority = ").writeln(CMSIS::Thread::getMyPriority());
 
-   /* Records start of soak time */
-   static int startOfSoakTime;
-
-   /* Records start of dwell time */
-   static int startOfDwellTime;
-
-   /* Used for timeout for profile changes */
-   static int timeout;
-
-   /* Tolerance of temperature checks - Celsius */
-   constexpr int DELTA = 2;
-
    // Get current temperature (NAN on thermocouple failure)
    float currentTemperature = temperatureSensors.getLastTemperature();
 
-   if (std::isnan(currentTemperature)) {
+   // Settings from RAM snapshot (no waiting for EEPROM updates)
+   const ConfigCache::Snapshot &config = ConfigCache::get();
+
+   if (std::isnan(currentTemperature) && (state != s_fail)) {
       state = s_fail;
+      UiEvents::post(UiEvents::UiEvent_RunState);
    }
 
 #ifdef DEBUG_BUILD
@@ -139,9 +265,10 @@ static void handler(const void *) {
 
    console.
       WRITE(time).WRITE("s, ").WRITE(Reporter::getStateName(state)).
-      WRITE(": TO=").WRITE(timeout).
+      WRITE(": Step=").WRITE(stepIndex).
       WRITE(", T=").WRITE(currentTemperature).
-      WRITE(", SP=").WRITELN(setpoint);
+      WRITE(", SP=").WRITE(setpoint).
+      WRITE(", FF=").WRITELN(pid.getFeedForward());
 
    // Handle state
    switch (state) {
@@ -162,123 +289,24 @@ static void handler(const void *) {
          /*
           * Startup
           */
-         time     = 0;
-         state    = s_preheat;
-
-         // Use starting temperature as ambient reference
-         ambient  = currentTemperature;
-
-         pid.setTunings(pidKp, pidKi, pidKd);
+         time            = 0;
+         stepIndex       = 0;
+         startOfStepTime = 0;
+         setpoint        = ambient;
+         programFanSpeed = 0;
+         scheduledState  = s_init;
+
+         pid.setTunings(config.pid.kp, config.pid.ki, config.pid.kd);
          pid.setSetpoint(ambient);
          pid.enable();
 
-         // Calculate maximum time for preheat ramp to complete (10% over)
-         timeout = (int)round(1.1*currentProfile->preheatTime);
-
          console.WRITE("Starting sequence, Ta=").WRITELN(ambient);
          /* Fall through - no break */
 
-      case s_preheat:
-         /*
-          * Set-point follows profile temperature from ambient to start of soak temperature/time
-          * It will delay for a short while (10% of preheat time) if soakTemp1 not yet reached
-          *
-          * Ambient -> soakTemp1 @ ramp1Slope
-          */
-         if (time<currentProfile->preheatTime) {
-            // Following profile
-            setpoint = ambient + (time/(float)currentProfile->preheatTime)*(currentProfile->soakTemp1-ambient);
-            pid.setSetpoint(setpoint);
-         }
-         else if (currentTemperature>=(currentProfile->soakTemp1-DELTA)) {
-            // Reached end of preheat time
-            // Move on if nearly reached soak start temperature
-            // This allows for tolerances in the PID controller
-            state = s_soak;
-            startOfSoakTime = time;
-
-            // Calculate timeout for soak ramp (20% over)
-            timeout = startOfSoakTime+(int)round(1.2*currentProfile->soakTime);
-         }
-         else if (time>timeout) {
-            // Timeout
-            state = s_fail;
-         }
-         break;
-      case s_soak:
-         /*
-          * Heat from soak start temperature to soak end temperature over soak time
-          * It will delay for a while (20% of soak time) if soakTemp2 temperature not yet reached
-          *
-          * soakTemp1 -> soakTemp2 over soakTime time
-          */
-         if (time<(startOfSoakTime+currentProfile->soakTime)) {
-            // Following profile
-            setpoint = currentProfile->soakTemp1 +
-                  (time-startOfSoakTime)*(currentProfile->soakTemp2-currentProfile->soakTemp1)/currentProfile->soakTime;
-            pid.setSetpoint(setpoint);
-         }
-         else if (currentTemperature>=(currentProfile->soakTemp2-DELTA)) {
-            // Reached end of soak time
-            // Move on if nearly reached final soak temperature
-            // This allows for tolerances in the PID controller
-            state = s_ramp_up;
-
-            // Calculate timeout for ramp up to peak ramp (100% over - THE OVEN REALLY CAN'T COPE WITH THE RAMP)
-            timeout = time + (int)round(2*(currentProfile->peakTemp-setpoint)/currentProfile->rampUpSlope);
-         }
-         else if (time>timeout) {
-            // Timeout
-            state = s_fail;
-         }
-         break;
-      case s_ramp_up:
-         /*
-          * Heat from soak end temperature to peak at rampUp rate
-          * Will wait until reached T~peakTemp with timeout
-          *
-          * soakTemp2 -> peakTemp @ ramp2Slope
-          */
-         if (setpoint < currentProfile->peakTemp) {
-            // Following profile
-            setpoint += currentProfile->rampUpSlope;
-            pid.setSetpoint(setpoint);
-         }
-         else if (currentTemperature >= (currentProfile->peakTemp-DELTA)) {
-            state = s_dwell;
-            startOfDwellTime = time;
-
-            // No timeout
-            timeout = 0;
-         }
-         else {
-            if (time>timeout) {
-               state = s_fail;
-            }
-         }
-         break;
-      case s_dwell:
-         /*
-          * Remain at peak temperature for dwell time
-          *
-          * peakTemp for peakDwell
-          */
-         if (time >= (startOfDwellTime+currentProfile->peakDwell)) {
-            state = s_ramp_down;
-         }
-         break;
-      case s_ramp_down:
-         /* Ramp down at rampDown rate without timeout
-          *
-          * peakTemp -> ambient @ rampDown
-          */
-         if (setpoint > ambient) {
-            setpoint += currentProfile->rampDownSlope;
-         }
-         pid.setSetpoint(setpoint);
-         if (currentTemperature<=ambient+20) {
-            state = s_complete;
-         }
+      default:
+         executeSteps(currentTemperature);
+         updateGains(config);
+         updateFeedForward(config);
          break;
    }
    // Add data point to record
@@ -292,19 +320,20 @@ static void handler(const void *) {
 CMSIS::Timer timer{handler};
 
 /**
- * Start running a profile.
+ * Prepare to run a program.
  * This will:
- * - Set profiles to use
- * - Set initial state
- * - Start timer
+ * - Take snapshot of settings
+ * - Clear plot data
+ * - Record ambient temperature
  *
- * @param[in] profile Profile to run
- *
- * @return true  Successfully started
+ * @return true  Thermocouples are usable
  *
  * @return false Failed
  */
-bool startRunProfile(NvSolderProfile &profile) {
+static bool prepareRun() {
+
+   // Take settings used while running
+   ConfigCache::refresh();
 
    // Clear data
    Draw::reset();
@@ -314,13 +343,43 @@ bool startRunProfile(NvSolderProfile &profile) {
       state = s_fail;
       return false;
    }
-   currentProfile = &profile;
-   state          = s_init;
+   // Use starting temperature as ambient reference
+   ambient = getTemperature();
+   return true;
+}
+
+/**
+ * Start running the program.
+ * This will:
+ * - Compile the trajectory
+ * - Set initial state
+ * - Start timer
+ */
+static void startRun() {
+   trajectory.compile(program, ambient);
+   state = s_init;
 
    // Start Timer callback
 //   timer.create();
    timer.start(1.0);
+}
 
+/**
+ * Start running a profile.
+ * The profile is converted to the equivalent program.
+ *
+ * @param[in] profile Profile to run
+ *
+ * @return true  Successfully started
+ *
+ * @return false Failed
+ */
+bool startRunProfile(NvSolderProfile &profile) {
+   if (!prepareRun()) {
+      return false;
+   }
+   program.convert(profile, ambient);
+   startRun();
    return true;
 }
 
@@ -335,6 +394,7 @@ void completeRunProfile() {
    // Stop PID controller
    pid.enable(false);
    pid.setSetpoint(0);
+   programFanSpeed = 0;
 
    Reporter::addLogPoint(time, state);
 
@@ -349,6 +409,7 @@ void abortRunProfile() {
 
    state = s_fail;
    completeRunProfile();
+   UiEvents::post(UiEvents::UiEvent_RunState);
 }
 
 /**
@@ -362,7 +423,43 @@ bool remoteStartRunProfile() {
 }
 
 /**
- * Check run status
+ * Run a built-in or uploaded recipe
+ *
+ * @param[in] index Index of recipe (see ProfileProgram::getRecipe())
+ *
+ * @return true Successfully started
+ * @return false Failed to start
+ */
+bool remoteStartRunRecipe(unsigned index) {
+   if ((index >= ProfileProgram::getRecipeCount()) || !prepareRun()) {
+      return false;
+   }
+   program = ProfileProgram::getRecipe(index);
+   startRun();
+   return true;
+}
+
+/**
+ * Run a profile from the profile library\n
+ * The profile is copied to RAM so the library may be changed later.
+ *
+ * @param[in] id Id of profile in library
+ *
+ * @return true Successfully started
+ * @return false Failed to start
+ */
+bool remoteStartRunLibrary(unsigned id) {
+   if (!ProfileLibrary::load(id, libraryProfile) || !prepareRun()) {
+      return false;
+   }
+   program.convert(libraryProfile, ambient);
+   startRun();
+   return true;
+}
+
+/**
+ * Check run status\n
+ * This is a single word read so it needs no lock and may be called from any thread
  *
  * @return State of profile state machine
  */
@@ -430,31 +527,35 @@ void runProfile() {
    Reporter::setTextPrompt(textPrompt);
    Reporter::setPlotPrompt(graphicPrompt);
    Reporter::setDisplayFormat(plotDisplay);
-   Reporter::setProfile(currentProfileIndex);
+   Reporter::setProfile(currentProfileIndex, trajectory);
 
-   // Wait for completion with update approximately every second
-   uint32_t last = osKernelSysTick();
+   // Wait for completion redrawing when a new data point is logged (every second)
+   bool redraw = true;
    for(;;) {
-      uint32_t now = osKernelSysTick();
-      if ((uint32_t)(now - last) >= osKernelSysTickMicroSec(1000000U)) {
-//         temperatureSensors.updateMeasurements();
-         last += osKernelSysTickMicroSec(1000000U);
+      if (redraw) {
+         Reporter::displayProfileProgress();
+         redraw = false;
       }
-      // Update display
-      Reporter::displayProfileProgress();
-
-      SwitchValue key = buttons.getButton(10);
+      // Several keys may be queued for one event
+      UiEvents::UiEvent event = (buttons.peekButton() != SwitchValue::SW_NONE)?UiEvents::UiEvent_Key:UiEvents::wait();
       if ((state == s_complete) || (state == s_fail)) {
          completeRunProfile();
          break;
       }
-      if (key == SwitchValue::SW_S) {
-         abortRunProfile();
-         break;
+      if (event == UiEvents::UiEvent_Data) {
+         redraw = true;
       }
-      if (key == SwitchValue::SW_F4) {
-         plotDisplay = Reporter::toggle(plotDisplay);
-         Reporter::setDisplayFormat(plotDisplay);
+      else if (event == UiEvents::UiEvent_Key) {
+         SwitchValue key = buttons.getButton(0);
+         if (key == SwitchValue::SW_S) {
+            abortRunProfile();
+            break;
+         }
+         if (key == SwitchValue::SW_F4) {
+            plotDisplay = Reporter::toggle(plotDisplay);
+            Reporter::setDisplayFormat(plotDisplay);
+            redraw = true;
+         }
       }
    }
 
@@ -478,10 +579,13 @@ void runProfile() {
    Reporter::setTextPrompt(completedPrompt);
 
    // Report every second until key-press
+   UiEvents::UiEvent event = UiEvents::UiEvent_Tick;
    do {
-//      temperatureSensors.updateMeasurements();
-      Reporter::displayProfileProgress();
-   } while (buttons.getButton(1000) == SwitchValue::SW_NONE);
+      if (event == UiEvents::UiEvent_Tick) {
+         Reporter::displayProfileProgress();
+      }
+      event = UiEvents::wait();
+   } while ((event != UiEvents::UiEvent_Key) || (buttons.getButton(0) == SwitchValue::SW_NONE));
 
    ovenControl.setFanDutycycle(0);
    state = s_off;
@@ -549,29 +653,36 @@ void manualMode() {
    pid.setSetpoint(100);
    pid.enable(false);
 
-   // Wait for completion with update approximately every second
-   int      time = 0;
-   uint32_t last = osKernelSysTick();
+   // Update every second and on key-press
+   int  time   = 0;
+   bool redraw = true;
    for(;;) {
-      /**
-       * Safety check
-       * Turn off after 800 seconds of operation
-       */
-      if (pid.getElapsedTime()>=maxHeaterTime) {
-         pid.enable(false);
-         ovenControl.setHeaterDutycycle(0);
-         state = s_off;
+      if (redraw) {
+         drawManualScreen();
+         redraw = false;
       }
-      uint32_t now = osKernelSysTick();
-      if ((uint32_t)(now - last) >= osKernelSysTickMicroSec(1000000U)) {
+      // Several keys may be queued for one event
+      UiEvents::UiEvent event = (buttons.peekButton() != SwitchValue::SW_NONE)?UiEvents::UiEvent_Key:UiEvents::wait();
+      if (event == UiEvents::UiEvent_Tick) {
+         /**
+          * Safety check
+          * Turn off after 800 seconds of operation
+          */
+         if (pid.getElapsedTime()>=maxHeaterTime) {
+            pid.enable(false);
+            ovenControl.setHeaterDutycycle(0);
+            state = s_off;
+         }
          temperatureSensors.updateMeasurements();
-         last += osKernelSysTickMicroSec(1000000U);
-//         logger(++time);
          Reporter::addLogPoint(++time, state);
+         redraw = true;
+         continue;
       }
-      // Update display
-      drawManualScreen();
-      switch (buttons.getButton(10)) {
+      if (event != UiEvents::UiEvent_Key) {
+         continue;
+      }
+      redraw = true;
+      switch (buttons.getButton(0)) {
       case SwitchValue::SW_F1:
          // Fan toggle
          if (state == s_off) {
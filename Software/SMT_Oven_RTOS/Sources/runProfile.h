@@ -34,13 +34,28 @@ extern void drawProfile(const NvSolderProfile &profile);
  */
 bool remoteStartRunProfile();
 
+/**
+ * Start running a built-in or uploaded recipe remotely
+ *
+ * @param[in] index Index of recipe (see ProfileProgram::getRecipe())
+ */
+bool remoteStartRunRecipe(unsigned index);
+
+/**
+ * Start running a profile from the profile library remotely
+ *
+ * @param[in] id Id of profile (see ProfileLibrary::find())
+ */
+bool remoteStartRunLibrary(unsigned id);
+
 /**
  * Abort the current profile sequence
  */
 extern void abortRunProfile();
 
 /**
- * Check remote run profile remotely
+ * Check remote run profile remotely\n
+ * Lock-free - may be called from any thread
  */
 extern State remoteCheckRunProfile();
 
@@ -0,0 +1,211 @@
+/**
+ * @file    sensorFusion.cpp
+ * @brief   Combines the thermocouples into a single oven temperature
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include <math.h>
+#include "sensorFusion.h"
+
+/**
+ * Combine values using a weighted Huber M-estimate
+ *
+ * @param[in]  values   Values to combine
+ * @param[in]  weights  Weight of each value (0 => ignored)
+ * @param[in]  count    Number of values
+ * @param[out] effectiveCount Effective number of values after down-weighting (may be nullptr)
+ *
+ * @return Combined value or NAN if no value has a positive weight
+ */
+float SensorFusion::robustMean(const float values[], const float weights[], unsigned count, float *effectiveCount) {
+   // Sort used values (insertion sort - only a few)
+   unsigned order[MAX_CHANNELS];
+   unsigned used        = 0;
+   float    totalWeight = 0;
+   for (unsigned index=0; (index<count) && (index<MAX_CHANNELS); index++) {
+      if (!(weights[index] > 0)) {
+         continue;
+      }
+      unsigned position = used++;
+      while ((position > 0) && (values[order[position-1]] > values[index])) {
+         order[position] = order[position-1];
+         position--;
+      }
+      order[position] = index;
+      totalWeight += weights[index];
+   }
+   if (used == 0) {
+      if (effectiveCount != nullptr) {
+         *effectiveCount = 0;
+      }
+      return NAN;
+   }
+   // Weighted median - average the two middle values if the weight splits evenly
+   float    median;
+   float    cumulative = 0;
+   unsigned position   = 0;
+   for(;;) {
+      cumulative += weights[order[position]];
+      if ((cumulative >= totalWeight/2) || (position == used-1)) {
+         break;
+      }
+      position++;
+   }
+   median = values[order[position]];
+   if ((cumulative == totalWeight/2) && (position < used-1)) {
+      median = (median + values[order[position+1]])/2;
+   }
+   // Huber iterations starting from the median
+   float estimate = median;
+   float sumWeight, sumSquares;
+   for (int iteration=0; iteration<3; iteration++) {
+      float sum = 0;
+      sumWeight  = 0;
+      sumSquares = 0;
+      for (unsigned index=0; index<used; index++) {
+         float value    = values[order[index]];
+         float weight   = weights[order[index]];
+         float residual = fabsf(value-estimate);
+         if (residual > HUBER_K) {
+            weight *= HUBER_K/residual;
+         }
+         sum        += weight*value;
+         sumWeight  += weight;
+         sumSquares += weight*weight;
+      }
+      estimate = sum/sumWeight;
+   }
+   if (effectiveCount != nullptr) {
+      *effectiveCount = (sumWeight*sumWeight)/sumSquares;
+   }
+   return estimate;
+}
+
+/**
+ * Discard history (e.g. after a thermocouple is enabled or disabled)
+ */
+void SensorFusion::reset() {
+   for (Channel &channel:channels) {
+      channel = Channel{};
+   }
+   initialised = false;
+   outlierRun  = 0;
+   rate        = 0;
+   combined    = NAN;
+}
+
+/**
+ * Process a new set of readings\n
+ * Only the interval is passed (rather than an absolute time) so precision is not lost as up-time grows.
+ *
+ * @param[in] dt       Time since the previous readings (s)
+ * @param[in] values   Reading of each channel (Celsius)
+ * @param[in] valid    Indicates channel has a usable reading
+ * @param[in] weights  Relative weight of each channel (0 => ignored)
+ * @param[in] count    Number of channels (<= MAX_CHANNELS)
+ *
+ * @return Filtered temperature or NAN if there are no usable channels
+ */
+float SensorFusion::update(float dt, const float values[], const bool valid[], const float weights[], unsigned count) {
+   if (count > MAX_CHANNELS) {
+      count = MAX_CHANNELS;
+   }
+   if (!(dt > 0)) {
+      dt = 0;
+   }
+   float predicted = estimate + rate*dt;
+
+   // Plausibility checks
+   float    used[MAX_CHANNELS];
+   unsigned validCount    = 0;
+   unsigned acceptedCount = 0;
+   for (unsigned index=0; index<count; index++) {
+      Channel &channel = channels[index];
+      used[index] = 0;
+      if (!valid[index] || !(weights[index] > 0) || !isfinite(values[index])) {
+         channel.hasLast  = false;
+         channel.rejected = false;
+         continue;
+      }
+      validCount++;
+      channel.elapsed += dt;
+      if (channel.hasLast &&
+          (fabsf(values[index]-channel.lastValue) > (MAX_RATE*channel.elapsed+RATE_MARGIN))) {
+         // Faster than the oven can change
+         channel.rejected = true;
+      }
+      else if (channel.rejected && (!initialised || (fabsf(values[index]-predicted) <= ACCEPT_BAND))) {
+         // Agrees with the other channels again
+         channel.rejected = false;
+      }
+      channel.lastValue = values[index];
+      channel.elapsed   = 0;
+      channel.hasLast   = true;
+      if (!channel.rejected) {
+         used[index] = weights[index];
+         acceptedCount++;
+      }
+   }
+   if (validCount == 0) {
+      // Nothing to measure with
+      reset();
+      return NAN;
+   }
+   if (acceptedCount == 0) {
+      // Every channel has been rejected - can't tell which is right so trust them all again
+      for (unsigned index=0; index<count; index++) {
+         if (channels[index].hasLast) {
+            channels[index].rejected = false;
+            used[index] = weights[index];
+         }
+      }
+   }
+   float effectiveCount;
+   combined = robustMean(values, used, count, &effectiveCount);
+
+   // Measurement noise of the combined value
+   float r = (SENSOR_NOISE*SENSOR_NOISE)/effectiveCount;
+
+   if (!initialised) {
+      // Start filter at the measurement
+      initialised = true;
+      estimate    = combined;
+      rate        = 0;
+      p00         = r;
+      p01         = 0;
+      p11         = 1.0f;
+      outlierRun  = 0;
+      return estimate;
+   }
+
+   // Predict - constant rate model
+   estimate  = predicted;
+   float q   = PROCESS_NOISE;
+   p00      += dt*(2*p01 + dt*p11) + q*dt*dt*dt/3;
+   p01      += dt*p11 + q*dt*dt/2;
+   p11      += q*dt;
+
+   // Check innovation
+   float innovation = combined - estimate;
+   if (fabsf(innovation) > RESET_GATE) {
+      if (++outlierRun >= RESET_COUNT) {
+         // Consistently different - the model is wrong rather than the measurement
+         initialised = false;
+         return update(0, values, valid, weights, count);
+      }
+      return estimate;
+   }
+   outlierRun = 0;
+
+   // Update
+   float s  = p00 + r;
+   float k0 = p00/s;
+   float k1 = p01/s;
+   estimate += k0*innovation;
+   rate     += k1*innovation;
+   p11      -= k1*p01;
+   p01      -= k0*p01;
+   p00      -= k0*p00;
+   return estimate;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file    sensorFusion.h
+ * @brief   Combines the thermocouples into a single oven temperature
+ *
+ *  Each sample is processed in three stages:
+ *  - Plausibility - A channel that changes faster than the oven can (MAX_RATE) is rejected.
+ *                   It stays rejected until it agrees with the estimate again (a probe that
+ *                   has fallen off the board reads a steady but wrong value).
+ *  - Combination  - The accepted channels are combined by a weighted Huber M-estimate
+ *                   starting from the weighted median. Channels within HUBER_K of the
+ *                   estimate are averaged normally, those further away are progressively
+ *                   down-weighted so one bad probe cannot drag the result.
+ *  - Filtering    - A Kalman filter with a constant-rate model (temperature and its rate of
+ *                   change) smooths the combined value without the lag of a simple average
+ *                   during ramps.
+ *
+ *  This class has no hardware dependencies so it can be run against recorded data on a host.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+
+#ifndef SOURCES_SENSORFUSION_H_
+#define SOURCES_SENSORFUSION_H_
+
+#include <math.h>
+
+class SensorFusion {
+
+public:
+   /** Maximum number of channels combined */
+   static constexpr unsigned MAX_CHANNELS = 4;
+
+   /** Fastest rate of change that is plausible for the oven (Celsius/s) */
+   static constexpr float MAX_RATE = 10.0f;
+
+   /** Allowance for noise and quantisation in the rate check (Celsius) */
+   static constexpr float RATE_MARGIN = 2.0f;
+
+   /** A rejected channel is accepted again once this close to the estimate (Celsius) */
+   static constexpr float ACCEPT_BAND = 5.0f;
+
+   /** Residual beyond which a channel is down-weighted by the Huber estimate (Celsius) */
+   static constexpr float HUBER_K = 3.0f;
+
+   /** Noise of a single channel (standard deviation, Celsius) */
+   static constexpr float SENSOR_NOISE = 0.5f;
+
+   /** Process noise - spectral density of the rate of change of the oven slope ((Celsius/s)^2/s) */
+   static constexpr float PROCESS_NOISE = 0.02f;
+
+   /** Filter restarts after RESET_COUNT consecutive samples this far from the estimate (Celsius) */
+   static constexpr float RESET_GATE  = 15.0f;
+   static constexpr unsigned RESET_COUNT = 4;
+
+private:
+   /** Per-channel plausibility state */
+   struct Channel {
+      float lastValue;     // Previous reading (Celsius)
+      float elapsed;       // Time since previous reading (s)
+      bool  hasLast;       // lastValue and elapsed are valid
+      bool  rejected;      // Channel is currently excluded
+   };
+   Channel channels[MAX_CHANNELS] = {};
+
+   /** Filter state - estimate, rate and covariance */
+   bool     initialised = false;
+   float    estimate    = 0;
+   float    rate        = 0;
+   float    p00 = 0, p01 = 0, p11 = 0;
+
+   /** Number of consecutive samples outside RESET_GATE */
+   unsigned outlierRun  = 0;
+
+   /** Combined (unfiltered) value from last update */
+   float    combined    = NAN;
+
+public:
+   /**
+    * Combine values using a weighted Huber M-estimate
+    *
+    * @param[in]  values   Values to combine
+    * @param[in]  weights  Weight of each value (0 => ignored)
+    * @param[in]  count    Number of values
+    * @param[out] effectiveCount Effective number of values after down-weighting (may be nullptr)
+    *
+    * @return Combined value or NAN if no value has a positive weight
+    */
+   static float robustMean(const float values[], const float weights[], unsigned count, float *effectiveCount=nullptr);
+
+   /**
+    * Discard history (e.g. after a thermocouple is enabled or disabled)
+    */
+   void reset();
+
+   /**
+    * Process a new set of readings\n
+    * Only the interval is passed (rather than an absolute time) so precision is not lost as up-time grows.
+    *
+    * @param[in] dt       Time since the previous readings (s)
+    * @param[in] values   Reading of each channel (Celsius)
+    * @param[in] valid    Indicates channel has a usable reading
+    * @param[in] weights  Relative weight of each channel (0 => ignored)
+    * @param[in] count    Number of channels (<= MAX_CHANNELS)
+    *
+    * @return Filtered temperature or NAN if there are no usable channels
+    */
+   float update(float dt, const float values[], const bool valid[], const float weights[], unsigned count);
+
+   /**
+    * Get filtered rate of change of temperature
+    *
+    * @return Rate (Celsius/s)
+    */
+   float getRate() const {
+      return rate;
+   }
+
+   /**
+    * Get combined value before filtering from last update
+    *
+    * @return Temperature (Celsius) or NAN
+    */
+   float getCombined() const {
+      return combined;
+   }
+
+   /**
+    * Indicates if a channel was excluded by the plausibility check on the last update
+    *
+    * @param[in] channel Index of channel
+    *
+    * @return true if rejected
+    */
+   bool isRejected(unsigned channel) const {
+      return channels[channel].rejected;
+   }
+};
+
+#endif /* SOURCES_SENSORFUSION_H_ */
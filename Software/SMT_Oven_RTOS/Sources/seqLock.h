@@ -0,0 +1,109 @@
+/**
+ * @file    seqLock.h
+ * @brief   Sequence lock allowing consistent snapshot reads without blocking writers
+ *
+ *  Writers increment the sequence before and after changing the protected data so it is odd
+ *  while a change is in progress. Readers copy the data and retry if the sequence was odd or
+ *  changed during the copy. Readers never hold a lock so they cannot delay a writer.
+ *
+ *  Writers must already be serialised by other means (interactiveMutex).
+ *
+ *  Example:
+ *  @code
+ *     // Writer
+ *     {
+ *        SeqLock::WriteScope ws(configLock);
+ *        profiles[3] = newProfile;
+ *     }
+ *     // Reader
+ *     SolderProfile copy;
+ *     uint32_t sequence;
+ *     do {
+ *        sequence = configLock.beginRead();
+ *        copy     = profiles[3];
+ *     } while (configLock.retryRead(sequence));
+ *  @endcode
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+
+#ifndef SOURCES_SEQLOCK_H_
+#define SOURCES_SEQLOCK_H_
+
+#include <stdint.h>
+#include "cmsis.h"
+#include "hardware.h"
+
+class SeqLock {
+
+private:
+   /** Sequence number - odd while a write is in progress */
+   volatile uint32_t sequence = 0;
+
+   SeqLock(const SeqLock &) = delete;
+   SeqLock &operator=(const SeqLock &) = delete;
+
+public:
+   constexpr SeqLock() {
+   }
+
+   /**
+    * Start changing protected data
+    */
+   void beginWrite() {
+      sequence = sequence + 1;
+      __DMB();
+   }
+
+   /**
+    * Finish changing protected data
+    */
+   void endWrite() {
+      __DMB();
+      sequence = sequence + 1;
+   }
+
+   /**
+    * Start reading protected data\n
+    * Yields to the writer if a write is in progress (writers run in other threads)
+    *
+    * @return Sequence number to pass to retryRead()
+    */
+   uint32_t beginRead() const {
+      uint32_t value;
+      while ((value = sequence) & 1) {
+         osDelay(1);
+      }
+      __DMB();
+      return value;
+   }
+
+   /**
+    * Check if data read since beginRead() may be inconsistent
+    *
+    * @param[in] value Sequence number from beginRead()
+    *
+    * @return true => Data changed while being read so the read must be repeated
+    */
+   bool retryRead(uint32_t value) const {
+      __DMB();
+      return sequence != value;
+   }
+
+   /**
+    * Brackets a write to protected data for the lifetime of the object
+    */
+   class WriteScope {
+      SeqLock &lock;
+   public:
+      WriteScope(SeqLock &lock) : lock(lock) {
+         lock.beginWrite();
+      }
+      ~WriteScope() {
+         lock.endWrite();
+      }
+   };
+};
+
+#endif /* SOURCES_SEQLOCK_H_ */
@@ -8,7 +8,11 @@
  */
 #include "settings.h"
 #include "lcd_st7920.h"
+#include "calibration.h"
+#include "configCache.h"
 #include "configure.h"
+#include "gainSchedule.h"
+#include "nvLayout.h"
 
 /** Priority of the FlexRAM initialisation (Settings constructor) */
 #define FLEX_RAM_INIT_PRIORITY  (1000)
@@ -69,6 +73,33 @@ USBDM::Nonvolatile<float> pidKi;
 __attribute__ ((section(".flexRAM")))
 USBDM::Nonvolatile<float> pidKd;
 
+/*
+ * Added in layout version 1 - placed after the version 0 variables (see nvLayout.h)
+ */
+__attribute__ ((section(".flexRAM_v1")))
+Nonvolatile<int> t1Weight;
+
+__attribute__ ((section(".flexRAM_v1")))
+Nonvolatile<int> t2Weight;
+
+__attribute__ ((section(".flexRAM_v1")))
+Nonvolatile<int> t3Weight;
+
+__attribute__ ((section(".flexRAM_v1")))
+Nonvolatile<int> t4Weight;
+
+__attribute__ ((section(".flexRAM_v1")))
+Nonvolatile<int> faultHoldSamples;
+
+__attribute__ ((section(".flexRAM_v1")))
+USBDM::Nonvolatile<float> ovenGain;
+
+__attribute__ ((section(".flexRAM_v1")))
+USBDM::Nonvolatile<int> ovenTimeConstant;
+
+__attribute__ ((section(".flexRAM_v1")))
+USBDM::Nonvolatile<int> feedForwardLead;
+
 extern const Setting_T<int> fanSetting;
 extern const Setting_T<int> kickSetting;
 extern const Setting_T<int> heaterSetting;
@@ -76,12 +107,13 @@ extern const Setting_T<int> thermo1Setting;
 extern const Setting_T<int> thermo2Setting;
 extern const Setting_T<int> thermo3Setting;
 extern const Setting_T<int> thermo4Setting;
+extern const Setting_T<int> weight1Setting;
+extern const Setting_T<int> weight2Setting;
+extern const Setting_T<int> weight3Setting;
+extern const Setting_T<int> weight4Setting;
+extern const Setting_T<int> faultHoldSetting;
 extern const Setting_T<int> beepSetting;
 
-extern const Setting_T<float> pidKpSetting;
-extern const Setting_T<float> pidKiSetting;
-extern const Setting_T<float> pidKdSetting;
-
 /**
  * Constructor - initialises the non-volatile storage\n
  * Must be a singleton!
@@ -89,14 +121,16 @@ extern const Setting_T<float> pidKdSetting;
 Settings::Settings() : Flash() {
    // Initialise EEPROM
    USBDM::FlashDriverError_t rc = initialiseEeprom();
-   if (rc == USBDM::FLASH_ERR_OK) {
-      return;
+   if ((rc != USBDM::FLASH_ERR_OK) || (NvLayout::check() == NvLayout::NvLayout_Invalid)) {
+      /*
+       * New EEPROM or contents unusable (see NvLayout::getStatus()).
+       * Errors are ignored here but will have already set the USBDM error code.
+       * These may be tested later in main()
+       */
+      initialiseSettings();
    }
-   /*
-    * Errors are ignored here but will have already set the USBDM error code.
-    * These may be tested later in main()
-    */
-   initialiseSettings();
+   // Record layout and keep CRC updated
+   NvLayout::seal();
 }
 
 /**
@@ -104,6 +138,9 @@ Settings::Settings() : Flash() {
  */
 void Settings::initialiseSettings() {
 
+   SeqLock::WriteScope ws(configLock);
+   FlexRamTransaction::Scope transaction;
+
    // Write initial value for non-volatile variables
    unsigned i=0;
    profiles[i++] = am4300profileA;
@@ -133,9 +170,44 @@ void Settings::initialiseSettings() {
    pidKi           = pidKiSetting.getDefaultValue(); //0.016;  //0.0f; //  0.016
    pidKd           = pidKdSetting.getDefaultValue(); //62.5;   //0.0f; // 62.5
 
+   /**
+    * Settings added in layout version 1
+    */
+   initialiseVersion1Settings();
+
    currentProfileIndex    = 0;
 }
 
+/**
+ * Initialises the settings added in layout version 1 to factory defaults\n
+ * Used when migrating from version 0 (see NvLayout)
+ *
+ * @note The caller must hold configLock for writing (WriteScope doesn't nest)
+ */
+void Settings::initialiseVersion1Settings() {
+
+   FlexRamTransaction::Scope transaction;
+
+   t1Weight         = weight1Setting.getDefaultValue();
+   t2Weight         = weight2Setting.getDefaultValue();
+   t3Weight         = weight3Setting.getDefaultValue();
+   t4Weight         = weight4Setting.getDefaultValue();
+   faultHoldSamples = faultHoldSetting.getDefaultValue();
+   Calibration::reset();
+
+   /**
+    * Thermal model for feed-forward
+    */
+   ovenGain         = ovenGainSetting.getDefaultValue();
+   ovenTimeConstant = ovenTauSetting.getDefaultValue();
+   feedForwardLead  = ffLeadSetting.getDefaultValue();
+
+   /**
+    * All phases use the PID parameters
+    */
+   GainSchedule::reset();
+}
+
 /**
  * Test Beeper
  */
@@ -261,7 +333,6 @@ public:
          default:
             break;
          }
-         __WFI();
       }
    }
 };
@@ -278,11 +349,19 @@ const Setting_T<int> thermo1Setting  {t1Offset,        "Thermo 1 Offset  ", -30,
 const Setting_T<int> thermo2Setting  {t2Offset,        "Thermo 2 Offset  ", -30,    30,     1,      0,   "\x7F",  nullptr};
 const Setting_T<int> thermo3Setting  {t3Offset,        "Thermo 3 Offset  ", -30,    30,     1,      0,   "\x7F",  nullptr};
 const Setting_T<int> thermo4Setting  {t4Offset,        "Thermo 4 Offset  ", -30,    30,     1,      0,   "\x7F",  nullptr};
+const Setting_T<int> weight1Setting  {t1Weight,        "Thermo 1 Weight  ",   0,   100,     5,    100,      "%",  nullptr};
+const Setting_T<int> weight2Setting  {t2Weight,        "Thermo 2 Weight  ",   0,   100,     5,    100,      "%",  nullptr};
+const Setting_T<int> weight3Setting  {t3Weight,        "Thermo 3 Weight  ",   0,   100,     5,    100,      "%",  nullptr};
+const Setting_T<int> weight4Setting  {t4Weight,        "Thermo 4 Weight  ",   0,   100,     5,    100,      "%",  nullptr};
+const Setting_T<int> faultHoldSetting {faultHoldSamples, "Fault hold       ",   0,    20,     1,      4,       "",  nullptr};
 const Setting_T<int> heaterSetting   {maxHeaterTime,   "Max heater time ",   10,  1000,    10,    600,      "s",  nullptr};
 const Setting_T<int> beepSetting     {beepTime,        "Beep time        ",   0,    30,     1,      0,      "s",  Settings::testBeep};
 const Setting_T<float> pidKpSetting  {pidKp,           "PID Kp      ",        0.5,  60.00,  0.1,   40.0f,    "",  nullptr};
 const Setting_T<float> pidKiSetting  {pidKi,           "PID Ki       ",       0.0,   1.00,  0.001,  0.050f,  "",  nullptr};
 const Setting_T<float> pidKdSetting  {pidKd,           "PID Kd      ",        0.0, 200.00,  0.1,   62.5f,    "",  nullptr};
+const Setting_T<float> ovenGainSetting {ovenGain,       "FF Gain     ",        0.0,   5.00,  0.05,   2.5f, "\x7F/%", nullptr};
+const Setting_T<int> ovenTauSetting    {ovenTimeConstant, "FF Tau      ",     10,   600,     5,    150,      "s",  nullptr};
+const Setting_T<int> ffLeadSetting     {feedForwardLead, "FF Lead     ",       0,    60,     1,     15,      "s",  nullptr};
 
 /**
  * Describes the settings and limits for same
@@ -294,11 +373,19 @@ const Setting *const menu[] {
       &thermo2Setting,
       &thermo3Setting,
       &thermo4Setting,
+      &weight1Setting,
+      &weight2Setting,
+      &weight3Setting,
+      &weight4Setting,
+      &faultHoldSetting,
       &heaterSetting,
       &beepSetting,
       &pidKpSetting,
       &pidKiSetting,
       &pidKdSetting,
+      &ovenGainSetting,
+      &ovenTauSetting,
+      &ffLeadSetting,
 };
 
 static constexpr int NUM_ITEMS         = sizeof(menu)/sizeof(menu[0]);
@@ -382,11 +469,12 @@ void Settings::runMenu() {
          changed = true;
          break;
       case SwitchValue::SW_S:
+         // Control loop uses changed settings from now on
+         ConfigCache::refresh();
          return;
       default:
          break;
       }
-      __WFI();
    }
 }
 
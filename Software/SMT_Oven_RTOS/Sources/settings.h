@@ -46,6 +46,21 @@ extern USBDM::Nonvolatile<bool> t3Enable;
 /** Whether thermocouple #1 is enabled */
 extern USBDM::Nonvolatile<bool> t4Enable;
 
+/** Relative weight of thermocouple #1 in the oven temperature (%) */
+extern USBDM::Nonvolatile<int> t1Weight;
+
+/** Relative weight of thermocouple #2 in the oven temperature (%) */
+extern USBDM::Nonvolatile<int> t2Weight;
+
+/** Relative weight of thermocouple #3 in the oven temperature (%) */
+extern USBDM::Nonvolatile<int> t3Weight;
+
+/** Relative weight of thermocouple #4 in the oven temperature (%) */
+extern USBDM::Nonvolatile<int> t4Weight;
+
+/** Number of measurements a thermocouple fault is bridged by holding the last good temperature */
+extern USBDM::Nonvolatile<int> faultHoldSamples;
+
 /** Index of current profile */
 extern USBDM::Nonvolatile<int> currentProfileIndex;
 
@@ -61,6 +76,15 @@ extern USBDM::Nonvolatile<float> pidKi;
 /** PID controller parameters - differential */
 extern USBDM::Nonvolatile<float> pidKd;
 
+/** Thermal model - steady-state temperature rise per % of heater (Celsius/%, 0 disables feed-forward) */
+extern USBDM::Nonvolatile<float> ovenGain;
+
+/** Thermal model - time constant of oven (s) */
+extern USBDM::Nonvolatile<int> ovenTimeConstant;
+
+/** Thermal model - how far ahead of the set-point trajectory feed-forward is applied (s) */
+extern USBDM::Nonvolatile<int> feedForwardLead;
+
 class Setting {
 
 protected:
@@ -246,6 +270,16 @@ public:
    }
 };
 
+/** Settings for PID controller parameters */
+extern const Setting_T<float> pidKpSetting;
+extern const Setting_T<float> pidKiSetting;
+extern const Setting_T<float> pidKdSetting;
+
+/** Settings for thermal model used for feed-forward */
+extern const Setting_T<float> ovenGainSetting;
+extern const Setting_T<int>   ovenTauSetting;
+extern const Setting_T<int>   ffLeadSetting;
+
 /**
  * This class allows editing of Oven settings
  */
@@ -277,6 +311,12 @@ public:
     */
    static void initialiseSettings();
 
+   /*
+    * Initialise settings added in layout version 1 to default values\n
+    * The caller must hold configLock for writing
+    */
+   static void initialiseVersion1Settings();
+
    /**
     * Test Fan operation
     *
@@ -0,0 +1,189 @@
+/**
+ * @file    statistics.cpp
+ * @brief   Run-time statistics for the oven firmware
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include "statistics.h"
+
+namespace Statistics {
+
+Gauge     commandQueueUsed("commandQueueUsed");
+Counter   commandQueueAllocFail("commandQueueAllocFail");
+Counter   commandTooLong("commandTooLong");
+Gauge     txBufferUsed("txBufferUsed");
+Counter   txBufferFull("txBufferFull");
+Counter   txReplyTimeout("txReplyTimeout");
+Counter   droppedLogPoints("droppedLogPoints");
+Histogram pidPeriod("pidPeriod_us", 31250);
+Histogram pidJitter("pidJitter_us", 50);
+Histogram lcdRefreshTime("lcdRefresh_us", 10000);
+Rate      spiBytes("spiBytes");
+Counter   keyQueueOverflow("keyQueueOverflow");
+Histogram cpuIdle("cpuIdle_pct", 4);
+
+/** All metrics in reporting order */
+static Metric *const metrics[] = {
+      &commandQueueUsed,
+      &commandQueueAllocFail,
+      &commandTooLong,
+      &txBufferUsed,
+      &txBufferFull,
+      &txReplyTimeout,
+      &droppedLogPoints,
+      &pidPeriod,
+      &pidJitter,
+      &lcdRefreshTime,
+      &spiBytes,
+      &keyQueueOverflow,
+      &cpuIdle,
+};
+
+/** Processor cycles spent sleeping in the RTOS idle thread (see RTX_Conf_CM.c) */
+extern "C" volatile uint32_t os_idle_cycles;
+
+/** RTX time in ticks (ms) - unlike the kernel system timer this only wraps after 49 days */
+extern "C" volatile uint32_t os_time;
+
+/**
+ * Add the CPU idle percentage since the last call to cpuIdle\n
+ * Called once a second from thread context (see UiEvents)
+ */
+void sampleCpuIdle() {
+   static uint32_t lastTime = 0;
+   static uint32_t lastIdle = 0;
+
+   // Both in kernel system timer ticks
+   uint32_t now  = timeStamp();
+   uint32_t idle = os_idle_cycles;
+
+   uint32_t elapsed = now-lastTime;
+   if ((lastTime != 0) && (elapsed != 0)) {
+      cpuIdle.add((uint32_t)((100ULL*(uint32_t)(idle-lastIdle))/elapsed));
+   }
+   lastTime = now;
+   lastIdle = idle;
+}
+
+/**
+ * Add to count
+ *
+ * @param[in] amount Amount to add
+ */
+void Rate::add(uint32_t amount) {
+   USBDM::CriticalSection cs;
+   count = count + amount;
+}
+
+void Rate::report(USBDM::FormattedIO &sf) const {
+   uint32_t total;
+   uint32_t elapsedMs;
+   {
+      USBDM::CriticalSection cs;
+      total     = count;
+      elapsedMs = os_time - resetTime;
+   }
+   uint32_t perSecond = 0;
+   if (elapsedMs != 0) {
+      perSecond = (uint32_t)(((uint64_t)total*1000U)/elapsedMs);
+   }
+   sf.write(name).write(",rate,").write((unsigned long)total).write(',').write((unsigned long)perSecond).write(';');
+}
+
+void Rate::reset() {
+   USBDM::CriticalSection cs;
+   count     = 0;
+   resetTime = os_time;
+}
+
+/**
+ * Add sample to histogram
+ *
+ * @param[in] value Sample value
+ */
+void Histogram::add(uint32_t value) {
+   unsigned bucket = 0;
+   uint32_t limit  = base;
+   while ((bucket < (NUM_BUCKETS-1)) && (value >= limit)) {
+      bucket++;
+      limit <<= 1;
+   }
+   USBDM::CriticalSection cs;
+   count = count + 1;
+   total = total + value;
+   if (value < minimum) {
+      minimum = value;
+   }
+   if (value > maximum) {
+      maximum = value;
+   }
+   buckets[bucket] = buckets[bucket] + 1;
+}
+
+void Histogram::report(USBDM::FormattedIO &sf) const {
+   uint32_t samples;
+   uint32_t smallest;
+   uint32_t largest;
+   uint64_t sum;
+   uint32_t counts[NUM_BUCKETS];
+   {
+      USBDM::CriticalSection cs;
+      samples  = count;
+      smallest = minimum;
+      largest  = maximum;
+      sum      = total;
+      for (unsigned index=0; index<NUM_BUCKETS; index++) {
+         counts[index] = buckets[index];
+      }
+   }
+   sf.write(name).write(",histogram,").write((unsigned long)samples).write(',');
+   if (samples == 0) {
+      sf.write("0,0,0,");
+   }
+   else {
+      sf.write((unsigned long)smallest).write(',')
+        .write((unsigned long)(sum/samples)).write(',')
+        .write((unsigned long)largest).write(',');
+   }
+   for (unsigned index=0; index<NUM_BUCKETS; index++) {
+      sf.write((unsigned long)counts[index]);
+      if (index != (NUM_BUCKETS-1)) {
+         sf.write('/');
+      }
+   }
+   sf.write(';');
+}
+
+void Histogram::reset() {
+   USBDM::CriticalSection cs;
+   count   = 0;
+   total   = 0;
+   minimum = UINT32_MAX;
+   maximum = 0;
+   for (unsigned index=0; index<NUM_BUCKETS; index++) {
+      buckets[index] = 0;
+   }
+}
+
+/**
+ * Report all metrics
+ *
+ * @param[in] sf  Formatter to write metrics to
+ */
+void reportAll(USBDM::FormattedIO &sf) {
+   for (Metric *metric:metrics) {
+      metric->report(sf);
+   }
+}
+
+/**
+ * Reset all metrics
+ */
+void resetAll() {
+   for (Metric *metric:metrics) {
+      metric->reset();
+   }
+}
+
+}; // namespace Statistics
@@ -0,0 +1,293 @@
+/**
+ * @file    statistics.h
+ * @brief   Run-time statistics for the oven firmware
+ *
+ *  A small fixed registry of counters, gauges, rates and histograms that are
+ *  updated from the hot paths and may be queried remotely (STATS?).
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+
+#ifndef SOURCES_STATISTICS_H_
+#define SOURCES_STATISTICS_H_
+
+#include <stdint.h>
+#include "cmsis.h"
+#include "system.h"
+#include "formatted_io.h"
+
+namespace Statistics {
+
+/**
+ * Get current time-stamp for interval measurements
+ *
+ * @return Time-stamp in kernel system timer ticks
+ */
+static inline uint32_t timeStamp() {
+   return osKernelSysTick();
+}
+
+/**
+ * Convert an interval in kernel system timer ticks to microseconds
+ *
+ * @param[in] ticks Interval in ticks
+ *
+ * @return Interval in microseconds
+ */
+static inline uint32_t ticksToMicroseconds(uint32_t ticks) {
+   return (uint32_t)(((uint64_t)ticks*1000000U)/osKernelSysTickFrequency);
+}
+
+/**
+ * Base class for all metrics
+ */
+class Metric {
+
+protected:
+   /** Name of metric as reported */
+   const char *const name;
+
+   ~Metric() = default;
+
+public:
+   /**
+    * Constructor
+    *
+    * @param[in] name Name used when reporting the metric
+    */
+   constexpr Metric(const char *name) : name(name) {
+   }
+
+   /**
+    * Write metric to formatter e.g. "name,type,value...;"
+    *
+    * @param[in] sf Formatter to write to
+    */
+   virtual void report(USBDM::FormattedIO &sf) const = 0;
+
+   /**
+    * Reset metric to initial value
+    */
+   virtual void reset() = 0;
+};
+
+/**
+ * Simple event counter\n
+ * May be incremented from an ISR
+ */
+class Counter : public Metric {
+
+private:
+   volatile uint32_t count = 0;
+
+public:
+   constexpr Counter(const char *name) : Metric(name) {
+   }
+
+   /**
+    * Increment counter
+    */
+   void increment() {
+      USBDM::CriticalSection cs;
+      count++;
+   }
+
+   /**
+    * Get counter value
+    *
+    * @return Count
+    */
+   uint32_t get() const {
+      return count;
+   }
+
+   void report(USBDM::FormattedIO &sf) const override {
+      sf.write(name).write(",counter,").write((unsigned long)count).write(';');
+   }
+
+   void reset() override {
+      count = 0;
+   }
+};
+
+/**
+ * Gauge recording a current value and the high-water mark\n
+ * May be updated from an ISR
+ */
+class Gauge : public Metric {
+
+private:
+   volatile int32_t value     = 0;
+   volatile int32_t highWater = 0;
+
+public:
+   constexpr Gauge(const char *name) : Metric(name) {
+   }
+
+   /**
+    * Set gauge value
+    *
+    * @param[in] newValue Value to set
+    */
+   void set(int32_t newValue) {
+      USBDM::CriticalSection cs;
+      value = newValue;
+      if (newValue > highWater) {
+         highWater = newValue;
+      }
+   }
+
+   /**
+    * Change gauge value
+    *
+    * @param[in] delta Amount to add (may be negative)
+    */
+   void add(int32_t delta) {
+      USBDM::CriticalSection cs;
+      value = value + delta;
+      if (value > highWater) {
+         highWater = value;
+      }
+   }
+
+   void report(USBDM::FormattedIO &sf) const override {
+      sf.write(name).write(",gauge,").write((long)value).write(',').write((long)highWater).write(';');
+   }
+
+   /**
+    * Reset high-water mark to the current value
+    */
+   void reset() override {
+      USBDM::CriticalSection cs;
+      highWater = value;
+   }
+};
+
+/**
+ * Counter reported together with the average rate per second since the last reset\n
+ * The rate is calculated from the time of the reset when reported so periods
+ * without any additions are included.
+ */
+class Rate : public Metric {
+
+private:
+   volatile uint32_t count     = 0;
+   /** RTX time of last reset (ms) */
+   volatile uint32_t resetTime = 0;
+
+public:
+   constexpr Rate(const char *name) : Metric(name) {
+   }
+
+   /**
+    * Add to count
+    *
+    * @param[in] amount Amount to add
+    */
+   void add(uint32_t amount);
+
+   void report(USBDM::FormattedIO &sf) const override;
+
+   void reset() override;
+};
+
+/**
+ * Histogram of values with power-of-2 bucket boundaries\n
+ * Bucket[0] counts values < base, Bucket[n] counts values < (base<<n), the last bucket counts the remainder
+ */
+class Histogram : public Metric {
+
+public:
+   static constexpr unsigned NUM_BUCKETS = 8;
+
+private:
+   const uint32_t    base;
+   volatile uint32_t count = 0;
+   volatile uint32_t minimum = UINT32_MAX;
+   volatile uint32_t maximum = 0;
+   volatile uint64_t total   = 0;
+   volatile uint32_t buckets[NUM_BUCKETS] = {0};
+
+public:
+   /**
+    * Constructor
+    *
+    * @param[in] name  Name used when reporting the metric
+    * @param[in] base  Upper bound of first bucket
+    */
+   constexpr Histogram(const char *name, uint32_t base) : Metric(name), base(base) {
+   }
+
+   /**
+    * Add sample to histogram
+    *
+    * @param[in] value Sample value
+    */
+   void add(uint32_t value);
+
+   void report(USBDM::FormattedIO &sf) const override;
+
+   void reset() override;
+};
+
+/** Number of command buffers in use */
+extern Gauge     commandQueueUsed;
+
+/** Failed command buffer allocations (command discarded) */
+extern Counter   commandQueueAllocFail;
+
+/** Commands too long for command buffer (command discarded) */
+extern Counter   commandTooLong;
+
+/** Bytes waiting in transmit ring */
+extern Gauge     txBufferUsed;
+
+/** Transmit ring full (writer waited or log point discarded) */
+extern Counter   txBufferFull;
+
+/** Replies discarded after waiting too long for the host to read the transmit ring */
+extern Counter   txReplyTimeout;
+
+/** Log points discarded (plot full or transmit ring busy) */
+extern Counter   droppedLogPoints;
+
+/** Interval between PID call-backs (us) */
+extern Histogram pidPeriod;
+
+/** Deviation of PID call-back interval from nominal (us) */
+extern Histogram pidJitter;
+
+/** Time taken by LCD_ST7920::refreshImage() (us) */
+extern Histogram lcdRefreshTime;
+
+/** Bytes transferred over the shared SPI */
+extern Rate      spiBytes;
+
+/** Key presses discarded due to full key queue */
+extern Counter   keyQueueOverflow;
+
+/** Percentage of each second spent sleeping in the RTOS idle thread */
+extern Histogram cpuIdle;
+
+/**
+ * Add the CPU idle percentage since the last call to cpuIdle\n
+ * Called once a second from thread context (see UiEvents)
+ */
+void sampleCpuIdle();
+
+/**
+ * Report all metrics
+ *
+ * @param[in] sf  Formatter to write metrics to
+ */
+void reportAll(USBDM::FormattedIO &sf);
+
+/**
+ * Reset all metrics
+ */
+void resetAll();
+
+}; // namespace Statistics
+
+#endif /* SOURCES_STATISTICS_H_ */
@@ -13,6 +13,7 @@
 #include <dataPoint.h>
 #include <Max31855.h>
 #include <algorithm>    // std::max
+#include "statistics.h"
 
 
 /**
@@ -91,6 +92,7 @@ public:
     */
    void addDataPoint(int time, DataPoint const &dataPoint) {
       if (time>=MAX_PROFILE_TIME) {
+         Statistics::droppedLogPoints.increment();
          return;
       }
       if (time>fLastValid) {
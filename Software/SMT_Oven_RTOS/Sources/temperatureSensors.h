@@ -11,25 +11,28 @@
 #include <dataPoint.h>
 #include <Max31855.h>
 #include "cmsis.h"
+#include "configCache.h"
+#include "sensorFusion.h"
+#include "settings.h"
 
 class TemperatureSensors {
 
 public:
-   static constexpr unsigned NUM_THERMOCOUPLES = 4;
+   static constexpr unsigned NUM_THERMOCOUPLES = ConfigCache::NUM_PROBES;
 
 private:
    using ThermocoupleStatus = Max31855::ThermocoupleStatus;
 
    /** Temperature sensors */
    Max31855 fTemperatureSensors[NUM_THERMOCOUPLES] = {
-      Max31855(spi, t1_cs, t1Offset, t1Enable),
-      Max31855(spi, t2_cs, t2Offset, t2Enable),
-      Max31855(spi, t3_cs, t3Offset, t3Enable),
-      Max31855(spi, t4_cs, t4Offset, t4Enable),
+      Max31855(spi, t1_cs, t1Offset, t1Enable, Calibration::getCalibration(0)),
+      Max31855(spi, t2_cs, t2Offset, t2Enable, Calibration::getCalibration(1)),
+      Max31855(spi, t3_cs, t3Offset, t3Enable, Calibration::getCalibration(2)),
+      Max31855(spi, t4_cs, t4Offset, t4Enable, Calibration::getCalibration(3)),
    };
 
    /** The thermocouples are averaged this many times on reading. */
-   static constexpr int OVERSAMPLES = 4;
+   static constexpr unsigned OVERSAMPLES = 4;
 
    /** Last measurement */
    DataPoint fCurrentMeasurements;
@@ -40,7 +43,13 @@ private:
    /** Mutex used to protect accesses */
    CMSIS::Mutex fMutex;
 
-   /** Average of temperatures */
+   /** Combines thermocouples with outlier rejection and filtering */
+   SensorFusion fFusion;
+
+   /** Tick count at last measurement */
+   uint32_t fLastTick = 0;
+
+   /** Fused oven temperature */
    float fAverageTemperature = 0;
 
 public:
@@ -57,7 +66,8 @@ public:
    }
 
    /**
-    * Update current readings from thermocouples
+    * Update current readings from thermocouples\n
+    * Settings are taken from the RAM snapshot so this does not wait for EEPROM updates (see ConfigCache)
     */
    void updateMeasurements() {
       // Lock while changes made
@@ -67,35 +77,32 @@ public:
 //      PulseTp tp(6);
       float temperatures[NUM_THERMOCOUPLES];
       ThermocoupleStatus status[NUM_THERMOCOUPLES];
-      int   foundSensorCount   = 0;
-      float averageTemperature = 0;
-      for (unsigned t=0; t<NUM_THERMOCOUPLES; t++) {
-         // Average each thermocouple
-         temperatures[t]    = 0;
-         fColdReferences[t] = 0;
-         for (int overSample=0; overSample<OVERSAMPLES; overSample++) {
-            float temperature;
-            float coldReference;
-            status[t] = fTemperatureSensors[t].getNewReading(temperature, coldReference);
-            temperatures[t]    += temperature;
-            fColdReferences[t] += coldReference;
-            if (status[t] == Max31855::TH_ENABLED) {
-               foundSensorCount++;
-               averageTemperature +=temperature;
-            }
+      bool  valid[NUM_THERMOCOUPLES];
+      // Settings are copied as measure() blocks on SPI and the snapshot may be re-used meanwhile
+      Max31855::ProbeSettings probes[NUM_THERMOCOUPLES];
+      float    weights[NUM_THERMOCOUPLES];
+      unsigned faultHoldSamples;
+      {
+         const ConfigCache::Snapshot &config = ConfigCache::get();
+         for (unsigned t=0; t<NUM_THERMOCOUPLES; t++) {
+            probes[t]  = config.probes[t];
+            weights[t] = config.weights[t];
          }
-         // Scale for average
-         temperatures[t]     /= OVERSAMPLES;
-         fColdReferences[t]  /= OVERSAMPLES;
-      }
-      if (foundSensorCount==0) {
-         // Safe value to return!
-         averageTemperature = NAN;
+         faultHoldSamples = config.faultHoldSamples;
       }
-      else {
-         averageTemperature /= foundSensorCount;
+      for (unsigned t=0; t<NUM_THERMOCOUPLES; t++) {
+         // Average each thermocouple (holding last good value over transient faults)
+         status[t] = fTemperatureSensors[t].measure(
+               temperatures[t], fColdReferences[t], OVERSAMPLES, faultHoldSamples, probes[t]);
+         valid[t]  = (status[t] == Max31855::TH_ENABLED);
       }
-      fAverageTemperature = averageTemperature;
+      // Measurements are made at irregular intervals so measure the interval from the kernel tick
+      uint32_t tick = osKernelSysTick();
+      float    dt   = (float)(uint32_t)(tick-fLastTick)/osKernelSysTickFrequency;
+      fLastTick = tick;
+
+      // NAN if no thermocouples are usable - safe value to return!
+      fAverageTemperature = fFusion.update(dt, temperatures, valid, weights, NUM_THERMOCOUPLES);
       fCurrentMeasurements.setState(s_off);
       fCurrentMeasurements.setTargetTemperature(0);
       fCurrentMeasurements.setFan(0);
@@ -106,13 +113,42 @@ public:
    }
    /**
     * Get last measured temperature\n
-    * This is an average of the active thermocouples
+    * This is a weighted robust average of the active thermocouples after filtering (see SensorFusion)
     *
-    * @return Averaged oven temperature
+    * @return Oven temperature or NAN if no thermocouples are usable
     */
    float getLastTemperature() {
       return fAverageTemperature;
    }
+   /**
+    * Get rate of change of oven temperature from the last measurement
+    *
+    * @return Rate (Celsius/s)
+    */
+   float getLastRate() {
+      return fFusion.getRate();
+   }
+
+   /**
+    * Indicates if a thermocouple was excluded from the last measurement as implausible
+    *
+    * @param[in] index Index of thermocouple
+    *
+    * @return true if excluded
+    */
+   bool isRejected(int index) {
+      return fFusion.isRejected(index);
+   }
+
+   /**
+    * Clear health counters of all thermocouples
+    */
+   void clearHealth() {
+      for (Max31855 &sensor:fTemperatureSensors) {
+         sensor.clearHealth();
+      }
+   }
+
    /**
     * Get last measured thermocouple values
     *
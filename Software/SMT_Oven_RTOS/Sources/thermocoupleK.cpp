@@ -0,0 +1,247 @@
+/**
+ * @file    thermocoupleK.cpp
+ * @brief   NIST ITS-90 type-K thermocouple linearisation
+ *
+ *  Coefficients are from NIST Monograph 175 (ITS-90 thermocouple tables).
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include "thermocoupleK.h"
+
+namespace ThermocoupleK {
+
+/*
+ * Reference function E(t) in mV
+ */
+/** -270 to 0 Celsius */
+static constexpr double forwardNegative[] = {
+   0.000000000000E+00,  0.394501280250E-01,  0.236223735980E-04, -0.328589067840E-06,
+  -0.499048287770E-08, -0.675090591730E-10, -0.574103274280E-12, -0.310888728940E-14,
+  -0.104516093650E-16, -0.198892668780E-19, -0.163226974860E-22,
+};
+/** 0 to 1372 Celsius */
+static constexpr double forwardPositive[] = {
+  -0.176004136860E-01,  0.389212049750E-01,  0.185587700320E-04, -0.994575928740E-07,
+   0.318409457190E-09, -0.560728448890E-12,  0.560750590590E-15, -0.320207200030E-18,
+   0.971511471520E-22, -0.121047212750E-25,
+};
+/** Exponential term for 0 to 1372 Celsius - a0*exp(a1*(t-a2)^2) */
+static constexpr double forwardA0 =  0.118597600000E+00;
+static constexpr double forwardA1 = -0.118343200000E-03;
+static constexpr double forwardA2 =  0.126968600000E+03;
+
+/*
+ * Inverse function t(E) in Celsius
+ */
+/** -5.891 to 0 mV */
+static constexpr double inverseNegative[] = {
+   0.0000000E+00,  2.5173462E+01, -1.1662878E+00, -1.0833638E+00,
+  -8.9773540E-01, -3.7342377E-01, -8.6632643E-02, -1.0450598E-02,
+  -5.1920577E-04,
+};
+/** 0 to 20.644 mV */
+static constexpr double inverseLow[] = {
+   0.000000E+00,   2.508355E+01,   7.860106E-02,  -2.503131E-01,
+   8.315270E-02,  -1.228034E-02,   9.804036E-04,  -4.413030E-05,
+   1.057734E-06,  -1.052755E-08,
+};
+/** 20.644 to 54.886 mV */
+static constexpr double inverseHigh[] = {
+  -1.318058E+02,   4.830222E+01,  -1.646031E+00,   5.464731E-02,
+  -9.650715E-04,   8.802193E-06,  -3.110810E-08,
+};
+
+/**
+ * Evaluate polynomial (Horner's method)
+ *
+ * @param[in] coefficients Coefficients in increasing order of power
+ * @param[in] count        Number of coefficients
+ * @param[in] x            Value to evaluate at
+ *
+ * @return c[0] + c[1]*x + ... + c[count-1]*x^(count-1)
+ */
+static constexpr double polynomial(const double *coefficients, unsigned count, double x) {
+   return (count == 0)?0.0:(coefficients[0] + x*polynomial(coefficients+1, count-1, x));
+}
+
+/**
+ * Taylor series of exponential function
+ *
+ * @param[in] x     Value (|x| <= 0.5)
+ * @param[in] term  Current term of series
+ * @param[in] n     Index of current term
+ *
+ * @return exp(x)
+ */
+static constexpr double exponentialSeries(double x, double term=1.0, unsigned n=1) {
+   return (n > 20)?term:(term + exponentialSeries(x, term*x/n, n+1));
+}
+
+/**
+ * Square a value
+ *
+ * @param[in] x Value
+ *
+ * @return x*x
+ */
+static constexpr double square(double x) {
+   return x*x;
+}
+
+/**
+ * Exponential function for compile-time use\n
+ * The argument is halved until the series converges quickly then the result squared back.
+ *
+ * @param[in] x Value
+ *
+ * @return exp(x)
+ */
+static constexpr double exponential(double x) {
+   return ((x > 0.5) || (x < -0.5))?
+         square(exponential(x/2)):
+         exponentialSeries(x);
+}
+
+/**
+ * ITS-90 reference function for type K
+ *
+ * @param[in] t Temperature (Celsius)
+ *
+ * @return Thermocouple voltage (mV)
+ */
+static constexpr double referenceFunction(double t) {
+   return (t < 0)?
+         polynomial(forwardNegative, sizeof(forwardNegative)/sizeof(forwardNegative[0]), t):
+         polynomial(forwardPositive, sizeof(forwardPositive)/sizeof(forwardPositive[0]), t) +
+            forwardA0*exponential(forwardA1*(t-forwardA2)*(t-forwardA2));
+}
+
+/**
+ * ITS-90 inverse function for type K
+ *
+ * @param[in] e Thermocouple voltage (mV)
+ *
+ * @return Temperature (Celsius)
+ */
+static constexpr double inverseFunction(double e) {
+   return (e < 0)?
+         polynomial(inverseNegative, sizeof(inverseNegative)/sizeof(inverseNegative[0]), e):
+         (e < 20.644)?
+         polynomial(inverseLow, sizeof(inverseLow)/sizeof(inverseLow[0]), e):
+         polynomial(inverseHigh, sizeof(inverseHigh)/sizeof(inverseHigh[0]), e);
+}
+
+/**
+ * Table of a function sampled at regular intervals
+ *
+ * @tparam N Number of entries
+ */
+template<unsigned N>
+struct Table {
+   float origin;       // Value of x for first entry
+   float step;         // Spacing of entries
+   float values[N];    // f(origin + i*step)
+
+   /**
+    * Look up value with linear interpolation\n
+    * Values beyond the ends of the table are extrapolated from the end intervals.
+    *
+    * @param[in] x Value to look up
+    *
+    * @return f(x)
+    */
+   float lookup(float x) const {
+      float position = (x-origin)/step;
+      int   index    = (int)position;
+      if (position < 0) {
+         index = 0;
+      }
+      else if (index > (int)N-2) {
+         index = N-2;
+      }
+      float fraction = position-index;
+      return values[index] + fraction*(values[index+1]-values[index]);
+   }
+};
+
+/*
+ * Compile-time generation of tables
+ */
+template<unsigned... I> struct IndexList {};
+
+template<unsigned N, unsigned... I> struct MakeIndexList : MakeIndexList<N-1, N-1, I...> {};
+
+template<unsigned... I> struct MakeIndexList<0, I...> {
+   using type = IndexList<I...>;
+};
+
+/**
+ * Create table of a function
+ *
+ * @tparam Function  Function to tabulate
+ * @tparam I         Indices of entries
+ *
+ * @param[in] origin Value of x for first entry
+ * @param[in] step   Spacing of entries
+ *
+ * @return Table
+ */
+template<double (*Function)(double), unsigned... I>
+static constexpr Table<sizeof...(I)> makeTable(double origin, double step, IndexList<I...>) {
+   return Table<sizeof...(I)>{(float)origin, (float)step, {(float)Function(origin+I*step)...}};
+}
+
+/** Inverse function from -6 mV to 55 mV in 0.25 mV steps (-210 to 1372 Celsius) */
+static constexpr unsigned INVERSE_ENTRIES = 245;
+static constexpr Table<INVERSE_ENTRIES> inverseTable =
+      makeTable<inverseFunction>(-6.0, 0.25, MakeIndexList<INVERSE_ENTRIES>::type());
+
+/** Reference function from -50 to 150 Celsius in 5 Celsius steps (cold junction range) */
+static constexpr unsigned FORWARD_ENTRIES = 41;
+static constexpr Table<FORWARD_ENTRIES> forwardTable =
+      makeTable<referenceFunction>(-50.0, 5.0, MakeIndexList<FORWARD_ENTRIES>::type());
+
+// Check against values from the NIST tables
+static_assert((inverseTable.values[24] == 0.0f), "Inverse table origin wrong");
+static_assert((forwardTable.values[30] > 4.095f) && (forwardTable.values[30] < 4.097f), "E(100) should be 4.096 mV");
+static_assert((referenceFunction(500) > 20.643) && (referenceFunction(500) < 20.645), "E(500) should be 20.644 mV");
+static_assert((inverseFunction(41.276) > 999.9) && (inverseFunction(41.276) < 1000.1), "t(41.276 mV) should be 1000 C");
+
+/**
+ * Convert thermocouple voltage to temperature (ITS-90 inverse function)
+ *
+ * @param[in] millivolts Thermocouple voltage relative to 0 Celsius (mV)
+ *
+ * @return Temperature (Celsius)
+ */
+float toTemperature(float millivolts) {
+   return inverseTable.lookup(millivolts);
+}
+
+/**
+ * Convert temperature to thermocouple voltage (ITS-90 reference function)\n
+ * Only covers the range of the cold junction (-50 to 150 Celsius)
+ *
+ * @param[in] temperature Temperature (Celsius)
+ *
+ * @return Thermocouple voltage relative to 0 Celsius (mV)
+ */
+float toMillivolts(float temperature) {
+   return forwardTable.lookup(temperature);
+}
+
+/**
+ * Correct a MAX31855 reading for the non-linearity of a type-K thermocouple
+ *
+ * @param[in] reading       Temperature from MAX31855 (Celsius)
+ * @param[in] coldReference Cold-junction temperature from MAX31855 (Celsius)
+ *
+ * @return Corrected temperature (Celsius)
+ */
+float linearise(float reading, float coldReference) {
+   float millivolts = (reading-coldReference)*MAX31855_SENSITIVITY;
+   return toTemperature(millivolts + toMillivolts(coldReference));
+}
+
+}; // namespace ThermocoupleK
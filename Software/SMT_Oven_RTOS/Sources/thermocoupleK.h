@@ -0,0 +1,63 @@
+/**
+ * @file    thermocoupleK.h
+ * @brief   NIST ITS-90 type-K thermocouple linearisation
+ *
+ *  The MAX31855 assumes a constant Seebeck coefficient of 41.276 uV/Celsius i.e.
+ *
+ *   reading = V/41.276uV + Tcj
+ *
+ *  The type-K curve is not linear so the reading is several degrees out at reflow temperatures.
+ *  The correction recovers the thermocouple voltage, adds the voltage of the cold junction from the
+ *  ITS-90 reference function and converts the total back to temperature with the ITS-90 inverse
+ *  polynomials:
+ *
+ *   V = (reading - Tcj) * 41.276uV
+ *   T = E^-1(V + E(Tcj))
+ *
+ *  Both functions are evaluated at compile time into tables so each conversion is a
+ *  table lookup with linear interpolation.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+
+#ifndef SOURCES_THERMOCOUPLEK_H_
+#define SOURCES_THERMOCOUPLEK_H_
+
+namespace ThermocoupleK {
+
+/** Sensitivity assumed by the MAX31855 (mV/Celsius) */
+constexpr float MAX31855_SENSITIVITY = 0.041276f;
+
+/**
+ * Convert thermocouple voltage to temperature (ITS-90 inverse function)
+ *
+ * @param[in] millivolts Thermocouple voltage relative to 0 Celsius (mV)
+ *
+ * @return Temperature (Celsius)
+ */
+float toTemperature(float millivolts);
+
+/**
+ * Convert temperature to thermocouple voltage (ITS-90 reference function)\n
+ * Only covers the range of the cold junction (-50 to 150 Celsius)
+ *
+ * @param[in] temperature Temperature (Celsius)
+ *
+ * @return Thermocouple voltage relative to 0 Celsius (mV)
+ */
+float toMillivolts(float temperature);
+
+/**
+ * Correct a MAX31855 reading for the non-linearity of a type-K thermocouple
+ *
+ * @param[in] reading       Temperature from MAX31855 (Celsius)
+ * @param[in] coldReference Cold-junction temperature from MAX31855 (Celsius)
+ *
+ * @return Corrected temperature (Celsius)
+ */
+float linearise(float reading, float coldReference);
+
+}; // namespace ThermocoupleK
+
+#endif /* SOURCES_THERMOCOUPLEK_H_ */
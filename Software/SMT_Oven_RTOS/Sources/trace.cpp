@@ -0,0 +1,167 @@
+/**
+ * @file    trace.cpp
+ * @brief   Time-stamped event trace
+ *
+ *  On the target the time-stamps are taken from the DWT cycle counter.\n
+ *  Host builds use clock_gettime() with a nanosecond time-stamp.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include "trace.h"
+
+#if TRACE_ENABLED
+
+#if defined(__arm__)
+#include "derivative.h"
+#include "system.h"
+#include "cmsis.h"
+#else
+#include <time.h>
+#endif
+
+namespace Trace {
+
+/** Ring buffer of events */
+static Event events[TRACE_BUFFER_SIZE];
+
+/** Index of next event to write */
+static volatile unsigned head = 0;
+
+/** Number of valid events in buffer */
+static volatile unsigned count = 0;
+
+/** Recording is suspended */
+static volatile bool paused = false;
+
+/** Thread names */
+static ThreadName threadNames[MAX_THREAD_NAMES];
+
+/** Number of thread names */
+static volatile unsigned threadNameCount = 0;
+
+#if defined(__arm__)
+/**
+ * Lock for buffer updates (disables interrupts)
+ */
+using Lock = USBDM::CriticalSection;
+
+/**
+ * Get time-stamp
+ *
+ * @return DWT cycle count
+ */
+static inline uint32_t timeStamp() {
+   return DWT->CYCCNT;
+}
+
+/**
+ * Get identifier for current context
+ *
+ * @return Exception number if in handler mode, otherwise the thread ID
+ */
+static inline uint32_t getContext() {
+   uint32_t exceptionNumber = __get_IPSR();
+   if (exceptionNumber != 0) {
+      return exceptionNumber;
+   }
+   return (uint32_t)(uintptr_t)osThreadGetId();
+}
+
+uint32_t getFrequency() {
+   return SystemCoreClock;
+}
+
+void initialise() {
+   CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+   DWT->CYCCNT       = 0;
+   DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+   clear();
+}
+#else
+/**
+ * Lock for buffer updates (host builds are single threaded)
+ */
+class Lock {
+public:
+   Lock() {}
+   ~Lock() {}
+};
+
+static inline uint32_t timeStamp() {
+   timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (uint32_t)(now.tv_sec*1000000000ULL + now.tv_nsec);
+}
+
+static inline uint32_t getContext() {
+   return 1;
+}
+
+uint32_t getFrequency() {
+   return 1000000000;
+}
+
+void initialise() {
+   clear();
+}
+#endif
+
+void record(const char *name, Phase phase) {
+   if (paused) {
+      return;
+   }
+   Lock lock;
+   // Time-stamp is taken inside the lock so events are in time order
+   Event &event = events[head];
+   event.timestamp = timeStamp();
+   event.name      = name;
+   event.context   = getContext();
+   event.phase     = phase;
+   head = (head+1)%TRACE_BUFFER_SIZE;
+   if (count < TRACE_BUFFER_SIZE) {
+      count = count+1;
+   }
+}
+
+void nameThread(const char *name) {
+   uint32_t context = getContext();
+   Lock lock;
+   for (unsigned index=0; index<threadNameCount; index++) {
+      if (threadNames[index].context == context) {
+         return;
+      }
+   }
+   if (threadNameCount < MAX_THREAD_NAMES) {
+      threadNames[threadNameCount].context = context;
+      threadNames[threadNameCount].name    = name;
+      threadNameCount = threadNameCount+1;
+   }
+}
+
+void pause(bool pause) {
+   paused = pause;
+}
+
+void clear() {
+   Lock lock;
+   head  = 0;
+   count = 0;
+}
+
+unsigned getCount() {
+   return count;
+}
+
+const Event &getEvent(unsigned index) {
+   return events[(head+TRACE_BUFFER_SIZE-count+index)%TRACE_BUFFER_SIZE];
+}
+
+const ThreadName *getThreadNames(unsigned &count) {
+   count = threadNameCount;
+   return threadNames;
+}
+
+}; // namespace Trace
+
+#endif // TRACE_ENABLED
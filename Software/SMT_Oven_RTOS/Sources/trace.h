@@ -0,0 +1,169 @@
+/**
+ * @file    trace.h
+ * @brief   Time-stamped event trace
+ *
+ *  Records begin/end/instant events into a RAM ring buffer from threads and ISRs.\n
+ *  The buffer may be retrieved remotely (TRACE?) and converted to Chrome trace
+ *  JSON on the host (Software/OvenControl/traceToChrome).
+ *
+ *  Tracing is enabled at compile time by defining TRACE_ENABLED=1.
+ *  When disabled the TRACE_xxx() macros produce no code.
+ *
+ *  Example:
+ *  @code
+ *  void pidCallback() {
+ *     TRACE_SCOPE("pid");
+ *     ...
+ *  }
+ *  @endcode
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+
+#ifndef SOURCES_TRACE_H_
+#define SOURCES_TRACE_H_
+
+#include <stdint.h>
+
+#ifndef TRACE_ENABLED
+/** Set to 1 to include trace code */
+#define TRACE_ENABLED 0
+#endif
+
+#ifndef TRACE_BUFFER_SIZE
+/** Number of events held in trace buffer (oldest are overwritten) */
+#define TRACE_BUFFER_SIZE 256
+#endif
+
+namespace Trace {
+
+/** Event phase - values are the Chrome trace phase characters */
+enum Phase : char {
+   Phase_Begin   = 'B',
+   Phase_End     = 'E',
+   Phase_Instant = 'i',
+};
+
+/** Single trace event */
+struct Event {
+   uint32_t    timestamp;  //!< Timestamp in counter ticks (see getFrequency())
+   const char *name;       //!< Name of event (must be a static string)
+   uint32_t    context;    //!< Thread ID or exception number (< 256) if in ISR
+   Phase       phase;      //!< Event phase
+};
+
+/** Maximum number of named threads */
+static constexpr unsigned MAX_THREAD_NAMES = 8;
+
+/** Name associated with a thread context */
+struct ThreadName {
+   uint32_t    context;    //!< Thread ID
+   const char *name;       //!< Name of thread
+};
+
+/**
+ * Enable time-stamp counter and clear trace buffer
+ */
+void initialise();
+
+/**
+ * Add event to trace buffer\n
+ * May be called from an ISR
+ *
+ * @param[in] name   Name of event (must be a static string)
+ * @param[in] phase  Event phase
+ */
+void record(const char *name, Phase phase);
+
+/**
+ * Associate a name with the current thread.\n
+ * Has no effect if the thread is already named or the table is full.
+ *
+ * @param[in] name Name of thread (must be a static string)
+ */
+void nameThread(const char *name);
+
+/**
+ * Suspend or resume recording e.g. while the buffer is being read
+ *
+ * @param[in] pause True to suspend recording
+ */
+void pause(bool pause);
+
+/**
+ * Discard all recorded events
+ */
+void clear();
+
+/**
+ * Get number of recorded events available
+ *
+ * @return Number of events
+ */
+unsigned getCount();
+
+/**
+ * Get recorded event
+ *
+ * @param[in] index Index of event, 0 is the oldest event
+ *
+ * @return Event
+ */
+const Event &getEvent(unsigned index);
+
+/**
+ * Get table of thread names
+ *
+ * @param[out] count Number of entries in table
+ *
+ * @return Pointer to table
+ */
+const ThreadName *getThreadNames(unsigned &count);
+
+/**
+ * Get frequency of time-stamp counter
+ *
+ * @return Frequency in Hz
+ */
+uint32_t getFrequency();
+
+/**
+ * Records a begin event on construction and a matching end event on destruction
+ */
+class Scope {
+
+private:
+   const char *const name;
+
+public:
+   Scope(const char *name) : name(name) {
+      record(name, Phase_Begin);
+   }
+
+   ~Scope() {
+      record(name, Phase_End);
+   }
+};
+
+}; // namespace Trace
+
+#if TRACE_ENABLED
+#define TRACE_CONCAT_(a,b)    a##b
+#define TRACE_CONCAT(a,b)     TRACE_CONCAT_(a,b)
+/** Start tracing */
+#define TRACE_INITIALISE()    Trace::initialise()
+/** Trace the enclosing scope */
+#define TRACE_SCOPE(name)     Trace::Scope TRACE_CONCAT(traceScope_,__LINE__)(name)
+/** Trace a single point in time */
+#define TRACE_INSTANT(name)   Trace::record(name, Trace::Phase_Instant)
+/** Name the current thread in the trace */
+#define TRACE_THREAD(name)    Trace::nameThread(name)
+#else
+#define TRACE_INITIALISE()    ((void)0)
+#define TRACE_SCOPE(name)     ((void)0)
+#define TRACE_INSTANT(name)   ((void)0)
+#define TRACE_THREAD(name)    ((void)0)
+#endif
+
+#endif /* SOURCES_TRACE_H_ */
@@ -0,0 +1,88 @@
+/**
+ * @file    uiEvents.cpp
+ * @brief   Events that cause the front panel to be redrawn
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+#include "uiEvents.h"
+#include "statistics.h"
+#include "system.h"
+
+namespace UiEvents {
+
+/** Number of different events (size of queue) */
+static constexpr unsigned NUM_EVENTS = 5;
+
+/** Events in queue - each event is queued at most once */
+static CMSIS::MessageQueue<UiEvent, NUM_EVENTS> eventQueue;
+
+/** Events posted but not yet received */
+static volatile uint8_t pending = 0;
+
+/** Indicates queue has been created */
+static volatile bool ready = false;
+
+/**
+ * Call-back from tick timer
+ */
+static void tickHandler(const void *) {
+   Statistics::sampleCpuIdle();
+   post(UiEvent_Tick);
+}
+
+/** Timer providing one second tick */
+static CMSIS::Timer tickTimer{tickHandler};
+
+/**
+ * Start the one second tick\n
+ * Events posted before this is called are discarded.
+ */
+void initialise() {
+   eventQueue.create();
+   ready = true;
+   tickTimer.start(1000);
+}
+
+/**
+ * Post event to the UI thread\n
+ * May be called from any thread or ISR
+ *
+ * @param[in] event Event to post
+ */
+void post(UiEvent event) {
+   if (!ready) {
+      return;
+   }
+   {
+      USBDM::CriticalSection cs;
+      if ((pending & event) != 0) {
+         // Already queued
+         return;
+      }
+      pending = pending | event;
+   }
+   eventQueue.putISR(event);
+}
+
+/**
+ * Wait for an event
+ *
+ * @param[in] millisec How long to wait in milliseconds. Use osWaitForever for indefinite wait
+ *
+ * @return Event received or UiEvent_None on timeout
+ */
+UiEvent wait(uint32_t millisec) {
+   osEvent event = eventQueue.get(millisec);
+   if (event.status != osEventMessage) {
+      return UiEvent_None;
+   }
+   UiEvent uiEvent = (UiEvent)event.value.v;
+
+   // Clear before the event is handled so a later post is not lost
+   USBDM::CriticalSection cs;
+   pending = pending & ~uiEvent;
+   return uiEvent;
+}
+
+}; // namespace UiEvents
@@ -0,0 +1,65 @@
+/**
+ * @file    uiEvents.h
+ * @brief   Events that cause the front panel to be redrawn
+ *
+ *  Screens that show changing values wait for an event and redraw only when something
+ *  they show may have changed rather than polling the keys and redrawing every few ms.
+ *
+ *  Events are flags rather than messages. An event that is posted again before it is
+ *  received is only received once, so the queue cannot overflow and a slow screen sees
+ *  the latest state rather than a backlog. Screens read the current values when an event
+ *  is received (e.g. buttons.getButton(0) for UiEvent_Key).
+ *
+ *  An event may be left over from an earlier screen so receiving one does not guarantee
+ *  that anything has changed.
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: podonoghue
+ */
+
+#ifndef SOURCES_UIEVENTS_H_
+#define SOURCES_UIEVENTS_H_
+
+#include <stdint.h>
+#include "cmsis.h"
+
+namespace UiEvents {
+
+/**
+ * UI events
+ */
+enum UiEvent : uint8_t {
+   UiEvent_None     = 0,      //!< No event before timeout
+   UiEvent_Key      = 1<<0,   //!< Key pressed (or repeating)
+   UiEvent_Data     = 1<<1,   //!< New measurement logged (see Reporter::addLogPoint())
+   UiEvent_Tick     = 1<<2,   //!< One second has elapsed
+   UiEvent_RunState = 1<<3,   //!< Profile state changed (e.g. failed or aborted remotely)
+   UiEvent_Remote   = 1<<4,   //!< Remote session started or ended
+};
+
+/**
+ * Start the one second tick\n
+ * Events posted before this is called are discarded.
+ */
+void initialise();
+
+/**
+ * Post event to the UI thread\n
+ * May be called from any thread or ISR
+ *
+ * @param[in] event Event to post
+ */
+void post(UiEvent event);
+
+/**
+ * Wait for an event
+ *
+ * @param[in] millisec How long to wait in milliseconds. Use osWaitForever for indefinite wait
+ *
+ * @return Event received or UiEvent_None on timeout
+ */
+UiEvent wait(uint32_t millisec=osWaitForever);
+
+}; // namespace UiEvents
+
+#endif /* SOURCES_UIEVENTS_H_ */
@@ -19,6 +19,7 @@
 
 #include "usb.h"
 #include "usb_implementation_cdc.h"
+#include "trace.h"
 
 namespace USBDM {
 
@@ -192,16 +193,17 @@ const Usb0::Descriptors Usb0::otherDescriptors = {
 /** In end-point for CDC notifications */
 InEndpoint  <Usb0Info, Usb0::CDC_NOTIFICATION_ENDPOINT, CDC_NOTIFICATION_EP_MAXSIZE>  Usb0::epCdcNotification(EndPointType_Bulk);
 
-/** Out end-point for CDC data out */
-OutEndpoint <Usb0Info, Usb0::CDC_DATA_OUT_ENDPOINT,     CDC_DATA_OUT_EP_MAXSIZE>      Usb0::epCdcDataOut(EndPointType_Interrupt);
+/** Out end-point for CDC data out (double-buffered) */
+PingPongOutEndpoint <Usb0Info, Usb0::CDC_DATA_OUT_ENDPOINT, CDC_DATA_OUT_EP_MAXSIZE>  Usb0::epCdcDataOut(EndPointType_Interrupt);
 
-/** In end-point for CDC data in */
-InEndpoint  <Usb0Info, Usb0::CDC_DATA_IN_ENDPOINT,      CDC_DATA_IN_EP_MAXSIZE>       Usb0::epCdcDataIn(EndPointType_Interrupt);
+/** In end-point for CDC data in (double-buffered) */
+PingPongInEndpoint  <Usb0Info, Usb0::CDC_DATA_IN_ENDPOINT,  CDC_DATA_IN_EP_MAXSIZE>   Usb0::epCdcDataIn(EndPointType_Interrupt);
 /*
  * TODO Add additional end-points here
  */
 
-RemoteInterface::Response  *Usb0::response = nullptr;
+/** Size of IN transfer in progress from transmit ring */
+volatile unsigned Usb0::txTransferSize = 0;
 
 /**
  * Handler for Start of Frame Token interrupt (~1ms interval)
@@ -245,8 +247,12 @@ ErrorCode Usb0::sofCallback(uint16_t frameNumber) {
 ErrorCode userCallbackFunction(const Usb0::UserEvent event) {
    switch(event) {
       case Usb0::UserEvent_Suspend:
+//         UsbLed::off();
+         break;
+
       case Usb0::UserEvent_Reset:
 //         UsbLed::off();
+         Usb0::discardTxData();
          break;
 
       case Usb0::UserEvent_Resume:
@@ -326,7 +332,9 @@ void Usb0::handleTokenComplete(UsbStat usbStat) {
 
 /**
  * Call-back handling CDC-OUT transaction complete\n
- * Data received is passed to the cdcInterface
+ * Data received is passed to the cdcInterface.\n
+ * The other receive buffer remains armed so the host may send the next
+ * transaction while this one is processed. This buffer is re-armed on return.
  *
  * @param[in] state Current end-point state (always EPDataOut)
  *
@@ -334,45 +342,47 @@ void Usb0::handleTokenComplete(UsbStat usbStat) {
  */
 EndpointState Usb0::cdcOutTransactionCallback(EndpointState state) {
    //   console.WRITELN("cdc_out");
+   TRACE_SCOPE("usbOut");
    (void)state;
    usbdm_assert(state == EPDataOut, "Incorrect endpoint state");
    cdcInterface::putData(epCdcDataOut.getDataTransferredSize(), epCdcDataOut.getBuffer());
-   // Set up for next transfer
-   epCdcDataOut.startRxStage(EPDataOut, epCdcDataOut.BUFFER_SIZE);
+   // Continue receiving
    return EPDataOut;
 }
 
 /**
- * Call-back handling CDC-IN transaction complete\n
- * Checks for data and schedules transfer as necessary\n
- * Each transfer will have a ZLP as necessary.
+ * Call-back handling CDC-IN transfer queued\n
+ * Releases the data of the previous transfer (already copied to the endpoint buffers)
+ * and schedules transfer of the next contiguous block from the transmit ring as necessary.\n
+ * This is called as soon as the last transaction of a transfer is queued so the
+ * next transfer follows without a gap.\n
+ * A ZLP is added only when the transfer empties the ring.
  *
  * @param[in] state Current end-point state (always EPDataIn)
  *
  * @return The endpoint state to set after call-back (EPIdle/EPDataIn)
  */
 EndpointState Usb0::cdcInTransactionCallback(EndpointState state) {
+   TRACE_SCOPE("usbIn");
    usbdm_assert(state == EPDataIn, "Incorrect endpoint state");
    (void)state;
-   RemoteInterface::Response *t = nullptr;
-   {
-      USBDM::CriticalSection cs;
-      t = response;
-      response = nullptr;
-   }
-   if (t != nullptr) {
-      // Free last buffer as transfer is now complete
-      RemoteInterface::freeResponseBuffer(t);
-   }
-   // Set up new message
-   response = RemoteInterface::getResponse();
-   if (response == nullptr) {
-      // No messages waiting
+
+   // Release data as transfer is now complete
+   cdcInterface::txDataSent(txTransferSize);
+   txTransferSize = 0;
+
+   // Get next block to send
+   volatile const uint8_t *data;
+   bool isLast;
+   unsigned size = cdcInterface::getTxData(data, MAX_TX_TRANSFER_SIZE, isLast);
+   if (size == 0) {
+      // No data waiting
       return EPIdle;
    }
    // Schedules transfer
-   epCdcDataIn.setNeedZLP();
-   epCdcDataIn.startTxStage(EPDataIn, response->size, response->data);
+   txTransferSize = size;
+   epCdcDataIn.setNeedZLP(isLast);
+   epCdcDataIn.startTxStage(EPDataIn, (uint8_t)size, data);
    return EPDataIn;
 }
 
@@ -382,6 +392,7 @@ EndpointState Usb0::cdcInTransactionCallback(EndpointState state) {
  * @return Not used
  */
 bool Usb0::notify() {
+   USBDM::CriticalSection cs;
    if (epCdcDataIn.getState() == EPIdle) {
       // Restart IN transactions
       cdcInTransactionCallback(EPDataIn);
@@ -389,6 +400,16 @@ bool Usb0::notify() {
    return true;
 }
 
+/**
+ * Discard data waiting to be sent including any IN transfer in progress\n
+ * Called on USB reset as the host will not collect replies to earlier commands
+ */
+void Usb0::discardTxData() {
+   USBDM::CriticalSection cs;
+   txTransferSize = 0;
+   cdcInterface::txDataClear();
+}
+
 /**
  * Initialise the USB0 interface
  *
@@ -399,6 +420,9 @@ void Usb0::initialise() {
    // Add extra handling of CDC requests directed to EP0
    setUnhandledSetupCallback(handleUserEp0SetupRequests);
 
+   // Discard replies on USB reset
+   setUserCallback(userCallbackFunction);
+
    setSOFCallback(sofCallback);
 
    cdcInterface::setUsbInNotifyCallback(notify);
@@ -407,7 +431,7 @@ void Usb0::initialise() {
 
    UsbBase_T::initialise();
 
-   response = nullptr;
+   txTransferSize = 0;
 }
 
 /**
@@ -156,17 +156,22 @@ protected:
    /** In end-point for CDC notifications */
    static InEndpoint  <Usb0Info, Usb0::CDC_NOTIFICATION_ENDPOINT, CDC_NOTIFICATION_EP_MAXSIZE>  epCdcNotification;
 
-   /** Out end-point for CDC data out */
-   static OutEndpoint <Usb0Info, Usb0::CDC_DATA_OUT_ENDPOINT,     CDC_DATA_OUT_EP_MAXSIZE>      epCdcDataOut;
+   /** Out end-point for CDC data out (double-buffered) */
+   static PingPongOutEndpoint <Usb0Info, Usb0::CDC_DATA_OUT_ENDPOINT, CDC_DATA_OUT_EP_MAXSIZE>  epCdcDataOut;
 
-   /** In end-point for CDC data in */
-   static InEndpoint  <Usb0Info, Usb0::CDC_DATA_IN_ENDPOINT,      CDC_DATA_IN_EP_MAXSIZE>       epCdcDataIn;
+   /** In end-point for CDC data in (double-buffered) */
+   static PingPongInEndpoint  <Usb0Info, Usb0::CDC_DATA_IN_ENDPOINT,  CDC_DATA_IN_EP_MAXSIZE>   epCdcDataIn;
    /*
     * TODO Add additional End-points here
     */
 
    using cdcInterface = RemoteInterface;
-   static cdcInterface::Response  *response;
+
+   /** Maximum size of a single IN transfer (limited by Endpoint::startTxStage()) */
+   static constexpr unsigned MAX_TX_TRANSFER_SIZE = (255/CDC_DATA_IN_EP_MAXSIZE)*CDC_DATA_IN_EP_MAXSIZE;
+
+   /** Size of IN transfer in progress from transmit ring */
+   static volatile unsigned txTransferSize;
 
 public:
 
@@ -202,6 +207,12 @@ public:
     */
    static bool notify();
 
+   /**
+    * Discard data waiting to be sent including any IN transfer in progress\n
+    * Called on USB reset as the host will not collect replies to earlier commands
+    */
+   static void discardTxData();
+
    /**
     * Device Descriptor
     */
@@ -245,13 +256,17 @@ protected:
       addEndpoint(&epCdcDataOut);
       epCdcDataOut.setCallback(cdcOutTransactionCallback);
 
-      // Make sure epCdcDataOut is ready for polling (interrupt OUT)
-      epCdcDataOut.startRxStage(EPDataOut, epCdcDataOut.getMaximumTransferSize());
+      // Make sure epCdcDataOut is ready for polling (interrupt OUT) - arms both buffers
+      epCdcDataOut.startRxStage(EPDataOut);
 
       epCdcDataIn.initialise();
       addEndpoint(&epCdcDataIn);
       epCdcDataIn.setCallback(cdcInTransactionCallback);
 
+      // Abandon any transfer interrupted by reset
+      cdcInterface::txDataSent(txTransferSize);
+      txTransferSize = 0;
+
       // Start CDC status transmission
       epCdcSendNotification();
 
@@ -19,6 +19,7 @@
 #include "cmp.h"
 #include "usb.h"
 #include "pit.h"
+#include "lptmr.h"
 /*********** $end(VectorsIncludeFiles)   *** Do not edit above this comment ***************/
 
 /*
@@ -316,9 +317,9 @@ VectorTable const __vector_table = {
       Default_Handler,                         /*   71,   55                                                                                   */
       DAC0_IRQHandler,                         /*   72,   56  Digital to Analogue Converter                                                    */
       MCG_IRQHandler,                          /*   73,   57  Multipurpose Clock Generator                                                     */
-      LPTMR0_IRQHandler,                       /*   74,   58  Low Power Timer                                                                  */
+      USBDM::Lptmr0::irqHandler,               /*   74,   58  Low Power Timer                                                                  */
       PORTA_IRQHandler,                        /*   75,   59  General Purpose Input/Output                                                     */
-      PORTB_IRQHandler,                        /*   76,   60  General Purpose Input/Output                                                     */
+      USBDM::PortB::irqHandler,                /*   76,   60  General Purpose Input/Output                                                     */
       PORTC_IRQHandler,                        /*   77,   61  General Purpose Input/Output                                                     */
       PORTD_IRQHandler,                        /*   78,   62  General Purpose Input/Output                                                     */
       PORTE_IRQHandler,                        /*   79,   63  General Purpose Input/Output                                                     */